@@ -170,8 +170,11 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include "clutter-actor.h"
 #include "clutter-container.h"
+#include "clutter-group.h"
 #include "clutter-main.h"
 #include "clutter-enum-types.h"
 #include "clutter-scriptable.h"
@@ -251,6 +254,30 @@ struct _ClutterActorPrivate
 
   guint8          opacity;
 
+  /* the opacity of the actor as it appears on the stage, valid
+   * while in_paint is set
+   */
+  guint8          paint_opacity;
+  guint           in_paint : 1;
+
+  /* set to the stage's occlusion serial when the stage found the
+   * actor to be completely hidden for the frame being painted
+   */
+  guint           occluded_serial;
+
+  /* clutter_actor_get_abs_allocation_vertices() result, valid while
+   * abs_verts_stamp matches the context transform stamp
+   */
+  ClutterVertex   abs_verts[4];
+  guint           abs_verts_stamp;
+
+  /* set by the parent's _clutter_actor_begin_cull_children(): on_stage
+   * is valid while cull_serial matches the parent's children_cull_serial
+   */
+  guint           cull_serial;
+  guint           children_cull_serial;
+  guint           on_stage : 1;
+
   ClutterActor   *parent_actor;
 
   gchar          *name;
@@ -366,8 +393,7 @@ static void clutter_scriptable_iface_init (ClutterScriptableIface *iface);
 
 static void _clutter_actor_apply_modelview_transform           (ClutterActor *self);
 
-static void clutter_actor_shader_pre_paint  (ClutterActor *actor,
-                                             gboolean      repeat);
+static void clutter_actor_shader_pre_paint  (ClutterActor *actor);
 static void clutter_actor_shader_post_paint (ClutterActor *actor);
 
 static void destroy_shader_data (ClutterActor *self);
@@ -798,6 +824,9 @@ clutter_actor_real_allocate (ClutterActor          *self,
   priv->allocation = *box;
   priv->needs_allocation = FALSE;
 
+  if (x1_changed || y1_changed || x2_changed || y2_changed)
+    _clutter_actor_transforms_changed ();
+
   g_object_freeze_notify (G_OBJECT (self));
 
   if (x1_changed || y1_changed || x2_changed || y2_changed)
@@ -1020,10 +1049,19 @@ clutter_actor_transform_and_project_box (ClutterActor          *self,
 					 ClutterVertex          verts[4])
 {
   ClutterActor          *stage;
+#ifdef CLUTTER_FLOAT_MATH
+  float                  mtx[16];
+  float                  mtx_p[16];
+  float                  vf[4];
+  float                  bounds[4];
+  float                  corners[12];
+  gint                   i;
+#else
   ClutterFixed           mtx[16];
   ClutterFixed           mtx_p[16];
   ClutterFixed           _x, _y, _z, _w;
   ClutterFixed           w[4];
+#endif
   ClutterFixed           v[4];
 
   /* We essentially have to dupe some code from clutter_redraw() here
@@ -1044,6 +1082,38 @@ clutter_actor_transform_and_project_box (ClutterActor          *self,
   clutter_stage_ensure_current (CLUTTER_STAGE (stage));
   _clutter_stage_maybe_setup_viewport (CLUTTER_STAGE (stage));
 
+#ifdef CLUTTER_FLOAT_MATH
+  cogl_push_matrix();
+  _clutter_actor_apply_modelview_transform_recursive (self, NULL);
+
+  cogl_get_modelview_matrix_f (mtx);
+
+  cogl_pop_matrix();
+
+  cogl_get_projection_matrix_f (mtx_p);
+  cogl_get_viewport (v);
+
+  for (i = 0; i < 4; i++)
+    vf[i] = CLUTTER_FIXED_TO_FLOAT (v[i]);
+
+  bounds[0] = 0;
+  bounds[1] = 0;
+  bounds[2] = CLUTTER_UNITS_TO_FLOAT (box->x2 - box->x1);
+  bounds[3] = CLUTTER_UNITS_TO_FLOAT (box->y2 - box->y1);
+
+  /* the corners come in the order of v[0] (x1, y1), v[1] (x2, y1),
+   * v[2] (x1, y2) and v[3] (x2, y2), with GL's upwards y, which we
+   * flip into window coordinates
+   */
+  cogl_util_project_boxes (mtx, mtx_p, vf, bounds, 1, corners);
+
+  for (i = 0; i < 4; i++)
+    {
+      verts[i].x = CLUTTER_FLOAT_TO_FIXED (corners[i]);
+      verts[i].y = CLUTTER_FLOAT_TO_FIXED (vf[3] + 2 * vf[1] - corners[4 + i]);
+      verts[i].z = CLUTTER_FLOAT_TO_FIXED (corners[8 + i]);
+    }
+#else
   cogl_push_matrix();
   _clutter_actor_apply_modelview_transform_recursive (self, NULL);
 
@@ -1141,6 +1211,7 @@ clutter_actor_transform_and_project_box (ClutterActor          *self,
   verts[3].x = MTX_GL_SCALE_X (verts[3].x, w[3], v[2], v[0]);
   verts[3].y = MTX_GL_SCALE_Y (verts[3].y, w[3], v[3], v[1]);
   verts[3].z = MTX_GL_SCALE_Z (verts[3].z, w[3], v[2], v[0]);
+#endif /* CLUTTER_FLOAT_MATH */
 }
 
 /**
@@ -1248,6 +1319,10 @@ clutter_actor_get_allocation_vertices (ClutterActor  *self,
  *   <listitem><para>v[3] contains (x2, y2)</para></listitem>
  * </itemizedlist>
  *
+ * The vertices are cached, so querying them again is cheap until the
+ * transformation or allocation of the actor or of one of its ancestors
+ * changes.
+ *
  * Since: 0.4
  */
 void
@@ -1255,31 +1330,83 @@ clutter_actor_get_abs_allocation_vertices (ClutterActor  *self,
                                            ClutterVertex  verts[4])
 {
   ClutterActorPrivate   *priv;
+  ClutterMainContext    *context;
+  ClutterActor          *ancestor;
+  ClutterActor          *stage;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
   priv = self->priv;
 
+  stage = clutter_actor_get_stage (self);
+
+  /* FIXME: if were not yet added to a stage, its probably unsafe to
+   * return default - idealy the func should fail.
+   */
+  if (stage == NULL)
+    stage = clutter_stage_get_default ();
+
   /* if the actor needs to be allocated we force a relayout, so that
    * the actor allocation box will be valid for
    * clutter_actor_transform_and_project_box()
    */
   if (priv->needs_allocation)
+    _clutter_stage_maybe_relayout (stage);
+
+  /* a pending change of the stage size or perspective is only applied
+   * when the viewport is set up, which also invalidates the cache
+   */
+  if (CLUTTER_PRIVATE_FLAGS (stage) & CLUTTER_ACTOR_SYNC_MATRICES)
     {
-      ClutterActor *stage = clutter_actor_get_stage (self);
+      clutter_stage_ensure_current (CLUTTER_STAGE (stage));
+      _clutter_stage_maybe_setup_viewport (CLUTTER_STAGE (stage));
+    }
 
-      /* FIXME: if were not yet added to a stage, its probably unsafe to
-       * return default - idealy the func should fail.
-       */
-      if (stage == NULL)
-	stage = clutter_stage_get_default ();
+  /* hit-testing and layout code query the same actors many times per
+   * frame, so keep the projected vertices until any transformation,
+   * allocation or the stage projection changes
+   */
+  context = clutter_context_get_default ();
 
-      _clutter_stage_maybe_relayout (stage);
+  if (priv->abs_verts_stamp != 0 &&
+      priv->abs_verts_stamp == context->transform_stamp)
+    {
+      memcpy (verts, priv->abs_verts, sizeof (priv->abs_verts));
+      return;
     }
 
   clutter_actor_transform_and_project_box (self,
-					   &self->priv->allocation,
+					   &priv->allocation,
 					   verts);
+
+  /* while painting the projection starts from the modelview matrix
+   * of the paint run instead of the stage's, so only keep the result
+   * if no ancestor is being painted
+   */
+  for (ancestor = self;
+       ancestor != NULL;
+       ancestor = ancestor->priv->parent_actor)
+    if (ancestor->priv->in_paint)
+      return;
+
+  memcpy (priv->abs_verts, verts, sizeof (priv->abs_verts));
+
+  priv->abs_verts_stamp = context->transform_stamp;
+}
+
+/* Called whenever something changes the on-stage position of actors:
+ * a transformation, an allocation, a parent or the stage projection.
+ * Invalidates the vertices cached by
+ * clutter_actor_get_abs_allocation_vertices()
+ */
+void
+_clutter_actor_transforms_changed (void)
+{
+  ClutterMainContext *context = clutter_context_get_default ();
+
+  /* 0 marks an empty cache, so skip it when wrapping around */
+  if (++context->transform_stamp == 0)
+    context->transform_stamp = 1;
 }
 
 /* Applies the transforms associated with this actor to the
@@ -1402,6 +1529,11 @@ _clutter_actor_apply_modelview_transform_recursive (ClutterActor *self,
  *
  * Renders the actor to display.
  *
+ * Actors whose opacity, composited with that of their parents, is
+ * zero are neither painted nor picked, and neither are their children.
+ * Actors the stage found to be hidden behind opaque actors are not
+ * painted either, see clutter_actor_get_opaque_area().
+ *
  * This function should not be called directly by applications.
  * Call clutter_actor_queue_redraw() to queue paints, instead.
  */
@@ -1411,6 +1543,8 @@ clutter_actor_paint (ClutterActor *self)
   ClutterActorPrivate *priv;
   ClutterMainContext *context;
   gboolean clip_set = FALSE;
+  gboolean was_in_paint;
+  guint8 paint_opacity;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
@@ -1428,6 +1562,51 @@ clutter_actor_paint (ClutterActor *self)
 	}
     }
 
+  /* The parent is usually being painted as well, in which case its
+   * paint opacity is already known; this keeps the cost of
+   * clutter_actor_get_paint_opacity() constant inside the paint
+   * handlers
+   */
+  paint_opacity = priv->parent_actor
+                ? clutter_actor_get_paint_opacity (priv->parent_actor)
+                : 0xff;
+
+  if (paint_opacity != 0xff)
+    paint_opacity = (paint_opacity * priv->opacity) / 0xff;
+  else
+    paint_opacity = priv->opacity;
+
+  /* Nothing of a fully transparent actor or of its children can be
+   * seen, so neither paint nor pick them
+   */
+  if (paint_opacity == 0)
+    {
+      CLUTTER_NOTE (PAINT, "Actor '%s' is fully transparent, skipping",
+                    clutter_actor_get_name (self) ? clutter_actor_get_name (self)
+                                                  : "unknown");
+      return;
+    }
+
+  context = clutter_context_get_default ();
+
+  /* The stage found the actor to be covered by opaque actors painted
+   * after it; this does not apply to picking, which has no opaque
+   * actors
+   */
+  if (context->occlusion_serial != 0 &&
+      priv->occluded_serial == context->occlusion_serial &&
+      context->pick_mode == CLUTTER_PICK_NONE)
+    {
+      CLUTTER_NOTE (PAINT, "Actor '%s' is occluded, skipping",
+                    clutter_actor_get_name (self) ? clutter_actor_get_name (self)
+                                                  : "unknown");
+      return;
+    }
+
+  was_in_paint = priv->in_paint;
+  priv->paint_opacity = paint_opacity;
+  priv->in_paint = TRUE;
+
   cogl_push_matrix();
 
   _clutter_actor_apply_modelview_transform (self);
@@ -1443,7 +1622,6 @@ clutter_actor_paint (ClutterActor *self)
           clip_set = TRUE;
         }
 
-      context = clutter_context_get_default ();
       if (G_UNLIKELY (context->pick_mode != CLUTTER_PICK_NONE))
         {
           ClutterColor col = { 0, };
@@ -1458,7 +1636,7 @@ clutter_actor_paint (ClutterActor *self)
         }
       else
         {
-          clutter_actor_shader_pre_paint (self, FALSE);
+          clutter_actor_shader_pre_paint (self);
 
           g_signal_emit (self, actor_signals[PAINT], 0);
 
@@ -1484,6 +1662,8 @@ clutter_actor_paint (ClutterActor *self)
     }
 
   cogl_pop_matrix();
+
+  priv->in_paint = was_in_paint;
 }
 
 /* fixed point, unit based rotation setter, to be used by
@@ -1530,6 +1710,8 @@ clutter_actor_set_rotation_internal (ClutterActor      *self,
       break;
     }
 
+  _clutter_actor_transforms_changed ();
+
   g_object_thaw_notify (G_OBJECT (self));
   g_object_unref (self);
 
@@ -3085,6 +3267,86 @@ clutter_actor_queue_redraw_damage (ClutterActor *self)
     clutter_stage_queue_redraw_damage (CLUTTER_STAGE (stage));
 }
 
+/**
+ * clutter_actor_queue_redraw_area:
+ * @self: A #ClutterActor
+ * @area: the area to redraw, in coordinates relative to @self
+ *
+ * Queues up a redraw of the part of the stage covered by @area,
+ * instead of the whole stage like clutter_actor_queue_redraw().
+ *
+ * This is useful for small changes inside a larger actor, like the
+ * blinking cursor of a text entry. The area is transformed with the
+ * current transformation of @self, and the redraw is clipped to its
+ * bounding box; everything else in the area is painted again, so
+ * @self must be able to paint the same contents outside of it.
+ *
+ * Since: 0.8.2-maemo
+ */
+void
+clutter_actor_queue_redraw_area (ClutterActor          *self,
+                                 const ClutterGeometry *area)
+{
+  ClutterActor *stage;
+  ClutterGeometry damage;
+  gint x_1, y_1, x_2, y_2;
+  gint i;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (area != NULL);
+
+  if (CLUTTER_PRIVATE_FLAGS (self) & CLUTTER_ACTOR_IN_DESTRUCTION)
+    return;
+
+  if (area->width == 0 || area->height == 0)
+    return;
+
+  if ((stage = clutter_actor_get_stage_if_allow_redraw (self)) == NULL)
+    return;
+
+  /* as in clutter_actor_transform_and_project_box(), make sure that
+   * the matrices are set up even if nothing was painted yet
+   */
+  clutter_stage_ensure_current (CLUTTER_STAGE (stage));
+  _clutter_stage_maybe_setup_viewport (CLUTTER_STAGE (stage));
+
+  x_1 = y_1 = G_MAXINT;
+  x_2 = y_2 = G_MININT;
+
+  for (i = 0; i < 4; i++)
+    {
+      ClutterVertex point, vertex;
+      gint x, y;
+
+      point.x = CLUTTER_UNITS_FROM_INT (area->x + ((i & 1) ? area->width : 0));
+      point.y = CLUTTER_UNITS_FROM_INT (area->y + ((i & 2) ? area->height : 0));
+      point.z = 0;
+
+      clutter_actor_apply_transform_to_point (self, &point, &vertex);
+
+      x = CLUTTER_UNITS_TO_INT (vertex.x);
+      y = CLUTTER_UNITS_TO_INT (vertex.y);
+
+      x_1 = MIN (x_1, x);
+      y_1 = MIN (y_1, y);
+      x_2 = MAX (x_2, x);
+      y_2 = MAX (y_2, y);
+    }
+
+  /* the conversion truncates, and filtering can touch the pixels
+   * next to the area, so we grow it by a pixel on each side
+   */
+  damage.x = x_1 - 1;
+  damage.y = y_1 - 1;
+  damage.width = x_2 - x_1 + 3;
+  damage.height = y_2 - y_1 + 3;
+
+  clutter_actor_notify_modified (self);
+
+  clutter_stage_set_damaged_area (stage, damage);
+  clutter_stage_queue_redraw_damage (CLUTTER_STAGE (stage));
+}
+
 /**
  * clutter_actor_queue_relayout:
  * @self: A #ClutterActor
@@ -4176,7 +4438,20 @@ clutter_actor_get_transformed_positionu (ClutterActor *self,
   ClutterVertex v1 = { 0, };
   ClutterVertex v2 = { 0, };
 
-  clutter_actor_apply_transform_to_point (self, &v1, &v2);
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  /* the origin of an allocated actor is the first of its cached
+   * allocation vertices
+   */
+  if (!self->priv->needs_allocation)
+    {
+      ClutterVertex verts[4];
+
+      clutter_actor_get_abs_allocation_vertices (self, verts);
+      v2 = verts[0];
+    }
+  else
+    clutter_actor_apply_transform_to_point (self, &v1, &v2);
 
   if (x)
     *x = v2.x;
@@ -4890,6 +5165,8 @@ clutter_actor_set_scalex (ClutterActor *self,
   self->priv->scale_y = scale_y;
   g_object_notify (G_OBJECT (self), "scale-y");
 
+  _clutter_actor_transforms_changed ();
+
   g_object_thaw_notify (G_OBJECT (self));
   g_object_unref (self);
 
@@ -4999,8 +5276,10 @@ clutter_actor_set_opacity (ClutterActor *self,
  *
  * Retrieves the absolute opacity of the actor, as it appears on the stage.
  *
- * This function traverses the hierarchy chain and composites the opacity of
- * the actor with that of its parents.
+ * This function composites the opacity of the actor with that of its
+ * parents. While the actor is being painted the value computed by
+ * clutter_actor_paint() is returned, without traversing the hierarchy
+ * chain.
  *
  * This function is intended for subclasses to use in the paint virtual
  * function, to paint themselves with the correct opacity.
@@ -5019,6 +5298,9 @@ clutter_actor_get_paint_opacity (ClutterActor *self)
 
   priv = self->priv;
 
+  if (priv->in_paint)
+    return priv->paint_opacity;
+
   parent = priv->parent_actor;
 
   /* Factor in the actual actors opacity with parents */
@@ -5033,6 +5315,43 @@ clutter_actor_get_paint_opacity (ClutterActor *self)
   return clutter_actor_get_opacity (self);
 }
 
+/**
+ * clutter_actor_get_opaque_area:
+ * @self: A #ClutterActor
+ * @box: return location for the opaque area, in actor coordinates
+ *
+ * Retrieves the area of the actor that its paint function covers with
+ * fully opaque pixels, provided that the paint opacity of the actor is
+ * 255. The stage uses it to skip painting actors that are completely
+ * hidden behind opaque actors.
+ *
+ * Actors report an opaque area by implementing the
+ * #ClutterActorClass.get_opaque_area virtual function; the default is
+ * to have none. Subclasses of #ClutterTexture and #ClutterRectangle
+ * that override the paint function lose the opaque area of their
+ * parent class, unless they override get_opaque_area as well.
+ *
+ * Return value: %TRUE if the actor has an opaque area and @box was set
+ *
+ * Since: 0.8.2-maemo
+ */
+gboolean
+clutter_actor_get_opaque_area (ClutterActor    *self,
+                               ClutterActorBox *box)
+{
+  ClutterActorClass *klass;
+
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
+  g_return_val_if_fail (box != NULL, FALSE);
+
+  klass = CLUTTER_ACTOR_GET_CLASS (self);
+
+  if (klass->get_opaque_area == NULL)
+    return FALSE;
+
+  return klass->get_opaque_area (self, box);
+}
+
 /**
  * clutter_actor_get_opacity:
  * @self: a #ClutterActor
@@ -5145,6 +5464,7 @@ clutter_actor_set_depthu (ClutterActor *self,
     {
       /* Sets Z value. - FIXME: should invert ?*/
       priv->z = depth;
+      _clutter_actor_transforms_changed ();
 
       if (priv->parent_actor && CLUTTER_IS_CONTAINER (priv->parent_actor))
         {
@@ -5703,6 +6023,7 @@ clutter_actor_set_parent (ClutterActor *self,
 
   g_object_ref_sink (self);
   priv->parent_actor = parent;
+  _clutter_actor_transforms_changed ();
 
   /* clutter_actor_reparent() will emit ::parent-set for us */
   if (!(CLUTTER_PRIVATE_FLAGS (self) & CLUTTER_ACTOR_IN_REPARENT))
@@ -5785,6 +6106,7 @@ clutter_actor_unparent (ClutterActor *self)
 
   old_parent = priv->parent_actor;
   priv->parent_actor = NULL;
+  _clutter_actor_transforms_changed ();
 
   /* if we are uparenting we hide ourselves; if we are just reparenting
    * there's no need to do that, as the paint is fast enough.
@@ -6197,6 +6519,7 @@ clutter_actor_move_anchor_point (ClutterActor *self,
 
   priv->anchor_x = ax;
   priv->anchor_y = ay;
+  _clutter_actor_transforms_changed ();
 
   if (priv->position_set)
     clutter_actor_move_byu (self, dx, dy);
@@ -6271,6 +6594,9 @@ clutter_actor_set_anchor_pointu (ClutterActor *self,
       changed = TRUE;
     }
 
+  if (changed)
+    _clutter_actor_transforms_changed ();
+
   g_object_thaw_notify (G_OBJECT (self));
 
   if (changed && CLUTTER_ACTOR_IS_VISIBLE (self))
@@ -6306,6 +6632,7 @@ clutter_actor_move_anchor_pointu (ClutterActor *self,
 
   priv->anchor_x = anchor_x;
   priv->anchor_y = anchor_y;
+  _clutter_actor_transforms_changed ();
 
   if (priv->position_set)
     clutter_actor_move_byu (self, dx, dy);
@@ -7128,26 +7455,38 @@ clutter_actor_box_get_type (void)
 
 /******************************************************************************/
 
-typedef struct _BoxedFloat BoxedFloat;
+typedef enum {
+  SHADER_PARAM_FLOAT,
+  SHADER_PARAM_INT,
+  SHADER_PARAM_MATRIX
+} ShaderParamType;
 
-struct _BoxedFloat
+typedef struct _ShaderParam ShaderParam;
+
+struct _ShaderParam
 {
-  gfloat value;
+  ShaderParamType type;
+  gint            size;
+
+  union {
+    gfloat floats[16];
+    gint   ints[4];
+  } v;
 };
 
 static void
-boxed_float_free (gpointer data)
+shader_param_free (gpointer data)
 {
   if (G_LIKELY (data))
-    g_slice_free (BoxedFloat, data);
+    g_slice_free (ShaderParam, data);
 }
 
 struct _ShaderData
 {
   ClutterShader *shader;
-  GHashTable    *float1f_hash; /*< list of values that should be set
-                                *  on the shader before each paint cycle
-                                */
+  GHashTable    *params; /*< list of values that should be set
+                          *  on the shader before each paint cycle
+                          */
 };
 
 static void
@@ -7165,10 +7504,10 @@ destroy_shader_data (ClutterActor *self)
       shader_data->shader = NULL;
     }
 
-  if (shader_data->float1f_hash)
+  if (shader_data->params)
     {
-      g_hash_table_destroy (shader_data->float1f_hash);
-      shader_data->float1f_hash = NULL;
+      g_hash_table_destroy (shader_data->params);
+      shader_data->params = NULL;
     }
 
   g_free (shader_data);
@@ -7239,10 +7578,10 @@ clutter_actor_set_shader (ClutterActor  *self,
   if (!shader_data)
     {
       actor_priv->shader_data = shader_data = g_new0 (ShaderData, 1);
-      shader_data->float1f_hash =
+      shader_data->params =
         g_hash_table_new_full (g_str_hash, g_str_equal,
                                g_free,
-                               boxed_float_free);
+                               shader_param_free);
     }
   if (shader_data->shader)
     {
@@ -7268,14 +7607,33 @@ set_each_param (gpointer key,
                 gpointer user_data)
 {
   ClutterShader *shader = CLUTTER_SHADER (user_data);
-  BoxedFloat *box = value;
+  ShaderParam *param = value;
+
+  /* the shader skips the upload of values it already holds */
+  switch (param->type)
+    {
+    case SHADER_PARAM_FLOAT:
+      clutter_shader_set_uniform_float (shader, key,
+                                        param->size, 1,
+                                        param->v.floats);
+      break;
+
+    case SHADER_PARAM_INT:
+      clutter_shader_set_uniform_int (shader, key,
+                                      param->size, 1,
+                                      param->v.ints);
+      break;
 
-  clutter_shader_set_uniform_1f (shader, key, box->value);
+    case SHADER_PARAM_MATRIX:
+      clutter_shader_set_uniform_matrix (shader, key,
+                                         param->size, 1, FALSE,
+                                         param->v.floats);
+      break;
+    }
 }
 
 static void
-clutter_actor_shader_pre_paint (ClutterActor *actor,
-                                gboolean      repeat)
+clutter_actor_shader_pre_paint (ClutterActor *actor)
 {
   ClutterActorPrivate *priv;
   ShaderData          *shader_data;
@@ -7293,12 +7651,12 @@ clutter_actor_shader_pre_paint (ClutterActor *actor,
 
   if (shader)
     {
+      /* this is a no-op if the shader is already the one in use */
       clutter_shader_set_is_enabled (shader, TRUE);
 
-      g_hash_table_foreach (shader_data->float1f_hash, set_each_param, shader);
+      g_hash_table_foreach (shader_data->params, set_each_param, shader);
 
-      if (!repeat)
-        context->shaders = g_slist_prepend (context->shaders, actor);
+      context->shaders = g_slist_prepend (context->shaders, actor);
     }
 }
 
@@ -7319,22 +7677,85 @@ clutter_actor_shader_post_paint (ClutterActor *actor)
   context = clutter_context_get_default ();
   shader = shader_data->shader;
 
-  if (shader)
+  if (shader && context->shaders && context->shaders->data == actor)
     {
-      clutter_shader_set_is_enabled (shader, FALSE);
+      ClutterActor *parent;
+      ShaderData *parent_data;
+
+      context->shaders = g_slist_delete_link (context->shaders,
+                                              context->shaders);
 
-      context->shaders = g_slist_remove (context->shaders, actor);
-      if (context->shaders)
+      if (!context->shaders)
         {
-          /* call pre-paint again, this time with the second argument being
-           * TRUE, indicating that we are reapplying the shader and thus
-           * should not be prepended to the stack
-           */
-          clutter_actor_shader_pre_paint (context->shaders->data, TRUE);
+          clutter_shader_set_is_enabled (shader, FALSE);
+          return;
+        }
+
+      /* restore the shader of the closest shaded ancestor: the program
+       * is only switched if it differs from ours, and only the
+       * parameters that we changed get uploaded again
+       */
+      parent = context->shaders->data;
+      parent_data = parent->priv->shader_data;
+
+      if (!parent_data || !parent_data->shader)
+        {
+          clutter_shader_set_is_enabled (shader, FALSE);
+          return;
         }
+
+      clutter_shader_set_is_enabled (parent_data->shader, TRUE);
+      g_hash_table_foreach (parent_data->params,
+                            set_each_param,
+                            parent_data->shader);
+
+      if (parent_data->shader != shader)
+        clutter_shader_set_is_enabled (shader, FALSE);
     }
 }
 
+/*
+ * Stores the value of a shader parameter, reusing the storage of the
+ * parameter if it has been set before.
+ */
+static void
+clutter_actor_set_shader_param_internal (ClutterActor    *self,
+                                         const gchar     *param,
+                                         ShaderParamType  type,
+                                         gint             size,
+                                         gconstpointer    value,
+                                         gsize            n_bytes)
+{
+  ClutterActorPrivate *priv;
+  ShaderData *shader_data;
+  ShaderParam *shader_param;
+
+  priv = self->priv;
+  shader_data = priv->shader_data;
+
+  if (!shader_data)
+    return;
+
+  shader_param = g_hash_table_lookup (shader_data->params, param);
+  if (!shader_param)
+    {
+      shader_param = g_slice_new0 (ShaderParam);
+      g_hash_table_insert (shader_data->params, g_strdup (param),
+                           shader_param);
+    }
+  else if (shader_param->type == type &&
+           shader_param->size == size &&
+           memcmp (&shader_param->v, value, n_bytes) == 0)
+    return;
+
+  shader_param->type = type;
+  shader_param->size = size;
+  memcpy (&shader_param->v, value, n_bytes);
+
+  if (CLUTTER_ACTOR_IS_VISIBLE (self))
+    clutter_actor_queue_redraw (self);
+}
+
 /**
  * clutter_actor_set_shader_param:
  * @self: a #ClutterActor
@@ -7351,25 +7772,98 @@ clutter_actor_set_shader_param (ClutterActor *self,
                                 const gchar  *param,
                                 gfloat        value)
 {
-  ClutterActorPrivate *priv;
-  ShaderData *shader_data;
-  BoxedFloat *box;
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (param != NULL);
+
+  clutter_actor_set_shader_param_internal (self, param,
+                                           SHADER_PARAM_FLOAT, 1,
+                                           &value, sizeof (gfloat));
+}
 
+/**
+ * clutter_actor_set_shader_param_vector:
+ * @self: a #ClutterActor
+ * @param: the name of the parameter
+ * @size: the number of components, between 1 and 4
+ * @value: @size floats holding the value of the parameter
+ *
+ * Sets the value for a named float, vec2, vec3 or vec4 parameter
+ * of the shader applied to @actor.
+ *
+ * Since: 0.8.2-maemo
+ */
+void
+clutter_actor_set_shader_param_vector (ClutterActor *self,
+                                       const gchar  *param,
+                                       gint          size,
+                                       const gfloat *value)
+{
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
   g_return_if_fail (param != NULL);
+  g_return_if_fail (size >= 1 && size <= 4);
+  g_return_if_fail (value != NULL);
 
-  priv = self->priv;
-  shader_data = priv->shader_data;
+  clutter_actor_set_shader_param_internal (self, param,
+                                           SHADER_PARAM_FLOAT, size,
+                                           value, sizeof (gfloat) * size);
+}
 
-  if (!shader_data)
-    return;
+/**
+ * clutter_actor_set_shader_param_int:
+ * @self: a #ClutterActor
+ * @param: the name of the parameter
+ * @size: the number of components, between 1 and 4
+ * @value: @size integers holding the value of the parameter
+ *
+ * Sets the value for a named int, ivec2, ivec3, ivec4 or sampler
+ * parameter of the shader applied to @actor.
+ *
+ * Since: 0.8.2-maemo
+ */
+void
+clutter_actor_set_shader_param_int (ClutterActor *self,
+                                    const gchar  *param,
+                                    gint          size,
+                                    const gint   *value)
+{
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (param != NULL);
+  g_return_if_fail (size >= 1 && size <= 4);
+  g_return_if_fail (value != NULL);
 
-  box = g_slice_new (BoxedFloat);
-  box->value = value;
-  g_hash_table_insert (shader_data->float1f_hash, g_strdup (param), box);
+  clutter_actor_set_shader_param_internal (self, param,
+                                           SHADER_PARAM_INT, size,
+                                           value, sizeof (gint) * size);
+}
 
-  if (CLUTTER_ACTOR_IS_VISIBLE (self))
-    clutter_actor_queue_redraw (self);
+/**
+ * clutter_actor_set_shader_param_matrix:
+ * @self: a #ClutterActor
+ * @param: the name of the parameter
+ * @size: the number of rows and columns, between 2 and 4
+ * @value: @size * @size floats in column-major order holding the
+ *   value of the parameter
+ *
+ * Sets the value for a named mat2, mat3 or mat4 parameter of the
+ * shader applied to @actor.
+ *
+ * Since: 0.8.2-maemo
+ */
+void
+clutter_actor_set_shader_param_matrix (ClutterActor *self,
+                                       const gchar  *param,
+                                       gint          size,
+                                       const gfloat *value)
+{
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (param != NULL);
+  g_return_if_fail (size >= 2 && size <= 4);
+  g_return_if_fail (value != NULL);
+
+  clutter_actor_set_shader_param_internal (self, param,
+                                           SHADER_PARAM_MATRIX, size,
+                                           value,
+                                           sizeof (gfloat) * size * size);
 }
 
 /**
@@ -7564,6 +8058,75 @@ clutter_actor_allocate_preferred_size (ClutterActor *self,
   clutter_actor_allocate (self, &actor_box, absolute_origin_changed);
 }
 
+/* Fills @area with the window area, in GL coordinates, outside of
+ * which nothing gets drawn: the scissor box if scissoring is enabled,
+ * the viewport otherwise. ONLY WORKS WHEN MATRICES SET UP.
+ */
+static void
+clutter_actor_get_cull_area (const float viewport[4],
+                             float       area[4])
+{
+  /* If we have scissor testing enabled, things outside the scissor
+   * box won't be drawn anyway, so use the box rather than the stage
+   * to allow us to clip even more stuff out */
+
+  if (glIsEnabled (GL_SCISSOR_TEST))
+    {
+      GLint scissor_box[4];
+      /* for some reason the scissor box is inverted wrt what we calculate */
+      glGetIntegerv (GL_SCISSOR_BOX, scissor_box);
+      area[0] = scissor_box[0];
+      area[1] = scissor_box[1];
+      area[2] = scissor_box[0] + scissor_box[2];
+      area[3] = scissor_box[1] + scissor_box[3];
+    }
+  else
+    {
+      /* FIXME: If rendering to an FBO, the width and height will be
+       * wrong here */
+      area[0] = 0;
+      area[1] = 0;
+      area[2] = viewport[2];
+      area[3] = viewport[3];
+    }
+}
+
+/* Whether the bounding box of four corners, as projected by
+ * cogl_util_project_boxes(), touches @area
+ */
+static gboolean
+clutter_actor_corners_in_area (const float corners[12],
+                               const float area[4])
+{
+  float x1, y1, x2, y2;
+  int i;
+
+  x1 = x2 = corners[0];
+  y1 = y2 = corners[4];
+
+  for (i = 1; i < 4; i++)
+    {
+      x1 = MIN (x1, corners[i]);
+      x2 = MAX (x2, corners[i]);
+      y1 = MIN (y1, corners[4 + i]);
+      y2 = MAX (y2, corners[4 + i]);
+    }
+
+  return x1 <= area[2] && x2 >= area[0] && y1 <= area[3] && y2 >= area[1];
+}
+
+static void
+clutter_actor_get_viewport_f (float viewport[4])
+{
+  ClutterFixed v[4];
+  int i;
+
+  cogl_get_viewport (v);
+
+  for (i = 0; i < 4; i++)
+    viewport[i] = CLUTTER_FIXED_TO_FLOAT (v[i]);
+}
+
 /**
  * clutter_actor_is_on_stage:
  * @self: a #ClutterActor
@@ -7576,14 +8139,14 @@ clutter_actor_allocate_preferred_size (ClutterActor *self,
 static gboolean clutter_actor_is_on_stage(ClutterActor *self)
 {
   ClutterActorPrivate *priv;
-  ClutterVertex  verts[4];
-  ClutterActorBox actor_box, stage_box;
-  ClutterActorBox *box = &self->priv->allocation;
-  gboolean visible = FALSE;
-  ClutterFixed           mtx[16];
-  ClutterFixed           mtx_p[16];
-  ClutterFixed           v[4];
-  int i;
+  ClutterActor *parent;
+  ClutterActorBox *box;
+  float mtx[16];
+  float mtx_p[16];
+  float viewport[4];
+  float area[4];
+  float bounds[4];
+  float corners[12];
 
   /* check to see if the vertices (in stage coordinates)
    * are on the stage or not. Create a box from them and
@@ -7594,78 +8157,153 @@ static gboolean clutter_actor_is_on_stage(ClutterActor *self)
   priv = CLUTTER_ACTOR_GET_PRIVATE(self);
   if (!priv->visibility_detect) return TRUE;
 
-  /* TODO: move this code back to clutter_actor_get_abs_allocation_vertices
-   * because it's just way tidier + less duplication */
+  /* the parent may already have projected all of its children at once */
+  parent = priv->parent_actor;
+  if (parent != NULL &&
+      parent->priv->children_cull_serial != 0 &&
+      priv->cull_serial == parent->priv->children_cull_serial)
+    return priv->on_stage;
 
-  cogl_get_modelview_matrix (mtx);
-  cogl_get_projection_matrix (mtx_p);
-  cogl_get_viewport (v);
+  box = &priv->allocation;
 
-  verts[0].x = 0;
-  verts[0].y = 0;
-  verts[0].z = 0;
-  verts[1].x = box->x2 - box->x1;
-  verts[1].y = 0;
-  verts[1].z = 0;
-  verts[2].x = 0;
-  verts[2].y = box->y2 - box->y1;
-  verts[2].z = 0;
-  verts[3].x = box->x2 - box->x1;
-  verts[3].y = box->y2 - box->y1;
-  verts[3].z = 0;
+  cogl_get_modelview_matrix_f (mtx);
+  cogl_get_projection_matrix_f (mtx_p);
+  clutter_actor_get_viewport_f (viewport);
+  clutter_actor_get_cull_area (viewport, area);
 
-  for (i=0;i<4;i++)
-    verts[i] = cogl_util_unproject(mtx, mtx_p, v, verts[i]);
+  bounds[0] = 0;
+  bounds[1] = 0;
+  bounds[2] = CLUTTER_UNITS_TO_FLOAT (box->x2 - box->x1);
+  bounds[3] = CLUTTER_UNITS_TO_FLOAT (box->y2 - box->y1);
 
-  clutter_actor_get_box_from_vertices(verts, &actor_box);
+  cogl_util_project_boxes (mtx, mtx_p, viewport, bounds, 1, corners);
 
-  /* If we have scissor testing enabled, things outside the scissor
-   * box won't be drawn anyway, so use the box rather than the stage
-   * to allow us to clip even more stuff out */
+  return clutter_actor_corners_in_area (corners, area);
+}
 
-  if (glIsEnabled (GL_SCISSOR_TEST))
+/*
+ * _clutter_actor_begin_cull_children:
+ * @parent: the #ClutterActor being painted
+ * @children: the children of @parent about to be painted
+ *
+ * Works out in one go whether each child that has visibility detection
+ * enabled is on the stage, so that painting the children does not
+ * need to project them one by one. Children with a rotation or a
+ * depth are left to clutter_actor_is_on_stage(), as their transformation
+ * is not a plain scale and translation of the parent's.
+ *
+ * Must be called from the paint of @parent, with its transformation
+ * applied, and paired with _clutter_actor_end_cull_children().
+ */
+void
+_clutter_actor_begin_cull_children (ClutterActor *parent,
+                                    GList        *children)
+{
+  static guint cull_serial = 0;
+  static GArray *boxes = NULL;
+  static GArray *corners = NULL;
+  static GPtrArray *batch = NULL;
+  float mtx[16];
+  float mtx_p[16];
+  float viewport[4];
+  float area[4];
+  GList *l;
+  guint i;
+
+  g_assert (CLUTTER_IS_ACTOR (parent));
+
+  parent->priv->children_cull_serial = 0;
+
+  /* scratch space kept across frames; nested calls only happen while
+   * the children are painted, once this batch is done with it
+   */
+  if (boxes == NULL)
     {
-      GLint scissor_box[4];
-      /* for some reason the scissor box is inverted wrt what we calculate */
-      glGetIntegerv (GL_SCISSOR_BOX, scissor_box);
-      stage_box.x1 = CLUTTER_UNITS_FROM_INT(scissor_box[0]);
-      stage_box.y1 = CLUTTER_UNITS_FROM_INT(scissor_box[1]);
-      stage_box.x2 = CLUTTER_UNITS_FROM_INT(scissor_box[0]+scissor_box[2]);
-      stage_box.y2 = CLUTTER_UNITS_FROM_INT(scissor_box[1]+scissor_box[3]);
+      boxes = g_array_new (FALSE, FALSE, sizeof (float));
+      corners = g_array_new (FALSE, FALSE, sizeof (float));
+      batch = g_ptr_array_new ();
     }
-  else
+
+  g_ptr_array_set_size (batch, 0);
+  g_array_set_size (boxes, 0);
+
+  for (l = children; l != NULL; l = l->next)
     {
-      /* FIXME: If rendering to an FBO, the width and height will be
-       * wrong here */
-      stage_box.x1 = CLUTTER_UNITS_FROM_INT(0);
-      stage_box.y1 = CLUTTER_UNITS_FROM_INT(0);
-      stage_box.x2 = v[2];
-      stage_box.y2 = v[3];
+      ClutterActor *child = l->data;
+      ClutterActorPrivate *priv = child->priv;
+      ClutterActorBox *box = &priv->allocation;
+      float sx, sy, ax, ay, x1, y1, b[4];
+
+      if (!priv->visibility_detect ||
+          !CLUTTER_ACTOR_IS_VISIBLE (child) ||
+          priv->rxang || priv->ryang || priv->rzang || priv->z)
+        continue;
+
+      sx = CLUTTER_FIXED_TO_FLOAT (priv->scale_x);
+      sy = CLUTTER_FIXED_TO_FLOAT (priv->scale_y);
+      ax = CLUTTER_UNITS_TO_FLOAT (priv->anchor_x);
+      ay = CLUTTER_UNITS_TO_FLOAT (priv->anchor_y);
+      x1 = CLUTTER_UNITS_TO_FLOAT (box->x1);
+      y1 = CLUTTER_UNITS_TO_FLOAT (box->y1);
+
+      b[0] = x1 - sx * ax;
+      b[1] = y1 - sy * ay;
+      b[2] = x1 + sx * (CLUTTER_UNITS_TO_FLOAT (box->x2 - box->x1) - ax);
+      b[3] = y1 + sy * (CLUTTER_UNITS_TO_FLOAT (box->y2 - box->y1) - ay);
+
+      g_ptr_array_add (batch, child);
+      g_array_append_vals (boxes, b, 4);
+    }
+
+  /* a single child is no cheaper to project here */
+  if (batch->len < 2)
+    return;
+
+  /* 0 marks no batch in progress, so skip it when wrapping around */
+  if (++cull_serial == 0)
+    cull_serial = 1;
+
+  cogl_get_modelview_matrix_f (mtx);
+  cogl_get_projection_matrix_f (mtx_p);
+  clutter_actor_get_viewport_f (viewport);
+  clutter_actor_get_cull_area (viewport, area);
+
+  g_array_set_size (corners, batch->len * 12);
+  cogl_util_project_boxes (mtx, mtx_p, viewport,
+                           (float *) boxes->data, batch->len,
+                           (float *) corners->data);
+
+  for (i = 0; i < batch->len; i++)
+    {
+      ClutterActorPrivate *priv = CLUTTER_ACTOR (batch->pdata[i])->priv;
+
+      priv->on_stage =
+        clutter_actor_corners_in_area (&g_array_index (corners, float, i * 12),
+                                       area);
+      priv->cull_serial = cull_serial;
     }
 
-  visible = actor_box.x1<=stage_box.x2 && actor_box.x2>=stage_box.x1 &&
-            actor_box.y1<=stage_box.y2 && actor_box.y2>=stage_box.y1;
-
-  /*if (visible == 0) {
-    int d = clutter_actor_get_depth(self);
-    int px,py;
-    guint sx,sy;
-    clutter_actor_get_position(self, &px, &py);
-    clutter_actor_get_size(self, &sx, &sy);
-    g_debug("%d %d %d %d [%d,%d,%d,%d, %d] ---  %d %d %d %d %d",
-          CLUTTER_UNITS_TO_INT(actor_box.x1),
-          CLUTTER_UNITS_TO_INT(actor_box.y1),
-          CLUTTER_UNITS_TO_INT(actor_box.x2),
-          CLUTTER_UNITS_TO_INT(actor_box.y2),
-          px, py, px+sx, py+sy, d,
-          CLUTTER_UNITS_TO_INT(stage_box.x1),
-          CLUTTER_UNITS_TO_INT(stage_box.y1),
-          CLUTTER_UNITS_TO_INT(stage_box.x2),
-          CLUTTER_UNITS_TO_INT(stage_box.y2),
-          visible);
-  }*/
-
-  return visible;
+  parent->priv->children_cull_serial = cull_serial;
+
+  CLUTTER_NOTE (PAINT, "Projected %u children of '%s' in one batch",
+                batch->len,
+                parent->priv->name ? parent->priv->name
+                                   : G_OBJECT_TYPE_NAME (parent));
+}
+
+/*
+ * _clutter_actor_end_cull_children:
+ * @parent: a #ClutterActor
+ *
+ * Drops the results of _clutter_actor_begin_cull_children(), once
+ * the children of @parent have been painted.
+ */
+void
+_clutter_actor_end_cull_children (ClutterActor *parent)
+{
+  g_assert (CLUTTER_IS_ACTOR (parent));
+
+  parent->priv->children_cull_serial = 0;
 }
 
 /**
@@ -7707,3 +8345,387 @@ void clutter_actor_set_allow_redraw(ClutterActor *self,
   priv = CLUTTER_ACTOR_GET_PRIVATE(self);
   priv->allow_redraw  = allow;
 }
+
+/*
+ * _clutter_actor_get_paint_box:
+ * @self: a #ClutterActor, child of the actor being painted
+ * @box: return location for the area @self paints, in the coordinates
+ *   of its parent
+ * @paint_opacity: return location for the paint opacity of @self
+ *
+ * Checks whether painting @self amounts to painting its allocation
+ * translated and scaled inside its parent, so that the parent can
+ * paint it on its behalf, e.g. together with similar siblings.
+ * @paint_opacity is set to 0 if clutter_actor_paint() would not paint
+ * @self at all.
+ *
+ * Return value: %TRUE if @self can be painted by its parent
+ */
+gboolean
+_clutter_actor_get_paint_box (ClutterActor    *self,
+                              ClutterActorBox *box,
+                              guint8          *paint_opacity)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterMainContext *context;
+  guint8 opacity;
+
+  if (priv->parent_actor == NULL || !CLUTTER_ACTOR_IS_REALIZED (self))
+    return FALSE;
+
+  if (priv->rxang != 0 || priv->ryang != 0 || priv->rzang != 0 ||
+      priv->z != 0 || priv->has_clip)
+    return FALSE;
+
+  if (priv->shader_data != NULL && priv->shader_data->shader != NULL)
+    return FALSE;
+
+  if (g_signal_has_handler_pending (self, actor_signals[PAINT], 0, TRUE))
+    return FALSE;
+
+  context = clutter_context_get_default ();
+
+  opacity = clutter_actor_get_paint_opacity (priv->parent_actor);
+  opacity = (opacity * priv->opacity) / 0xff;
+
+  if (!CLUTTER_ACTOR_IS_VISIBLE (self) ||
+      (context->occlusion_serial != 0 &&
+       priv->occluded_serial == context->occlusion_serial))
+    opacity = 0;
+
+  /* same order as _clutter_actor_apply_modelview_transform() */
+  box->x1 = priv->allocation.x1 - CFX_QMUL (priv->anchor_x, priv->scale_x);
+  box->y1 = priv->allocation.y1 - CFX_QMUL (priv->anchor_y, priv->scale_y);
+  box->x2 = box->x1 + CFX_QMUL (priv->allocation.x2 - priv->allocation.x1,
+                                priv->scale_x);
+  box->y2 = box->y1 + CFX_QMUL (priv->allocation.y2 - priv->allocation.y1,
+                                priv->scale_y);
+
+  *paint_opacity = opacity;
+
+  return TRUE;
+}
+
+/* Occlusion culling
+ *
+ * Before painting its children the stage walks the scene front to
+ * back, collecting the screen rectangles covered by opaque actors and
+ * marking the actors (or whole groups) that lie completely behind
+ * them, so that clutter_actor_paint() can skip them. Only actors under
+ * axis-aligned transforms take part: anything rotated or moved in depth
+ * is neither culled nor used as an occluder, and neither are its
+ * children.
+ */
+
+/* the occluders are not merged, so keep only the largest few */
+#define MAX_OCCLUDERS   16
+
+typedef struct _OcclusionBox
+{
+  gfloat x1, y1, x2, y2;
+} OcclusionBox;
+
+typedef struct _OcclusionData
+{
+  OcclusionBox occluders[MAX_OCCLUDERS];
+  guint        n_occluders;
+  guint        serial;
+  guint        n_culled;
+
+  /* ClutterGroup's paint, to recognise actors that only paint children */
+  void (* group_paint) (ClutterActor *actor);
+} OcclusionData;
+
+static inline gboolean
+occlusion_box_is_empty (const OcclusionBox *box)
+{
+  return box->x2 <= box->x1 || box->y2 <= box->y1;
+}
+
+static inline void
+occlusion_box_intersect (OcclusionBox       *box,
+                         const OcclusionBox *clip)
+{
+  box->x1 = MAX (box->x1, clip->x1);
+  box->y1 = MAX (box->y1, clip->y1);
+  box->x2 = MIN (box->x2, clip->x2);
+  box->y2 = MIN (box->y2, clip->y2);
+}
+
+/* maps a box in actor coordinates to the stage, given the stage
+ * position of the actor origin and its accumulated scale
+ */
+static inline void
+occlusion_box_transform (OcclusionBox *box,
+                         gfloat        x1,
+                         gfloat        y1,
+                         gfloat        x2,
+                         gfloat        y2,
+                         gfloat        off_x,
+                         gfloat        off_y,
+                         gfloat        scale_x,
+                         gfloat        scale_y)
+{
+  x1 = off_x + x1 * scale_x;
+  x2 = off_x + x2 * scale_x;
+  y1 = off_y + y1 * scale_y;
+  y2 = off_y + y2 * scale_y;
+
+  box->x1 = MIN (x1, x2);
+  box->x2 = MAX (x1, x2);
+  box->y1 = MIN (y1, y2);
+  box->y2 = MAX (y1, y2);
+}
+
+static gboolean
+occlusion_is_covered (const OcclusionData *data,
+                      const OcclusionBox  *box)
+{
+  gfloat x1 = floorf (box->x1), y1 = floorf (box->y1);
+  gfloat x2 = ceilf (box->x2), y2 = ceilf (box->y2);
+  guint i;
+
+  for (i = 0; i < data->n_occluders; i++)
+    {
+      const OcclusionBox *o = &data->occluders[i];
+
+      if (o->x1 <= x1 && o->y1 <= y1 && o->x2 >= x2 && o->y2 >= y2)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+occlusion_add (OcclusionData      *data,
+               const OcclusionBox *box)
+{
+  OcclusionBox inner;
+  gfloat area, smallest_area = G_MAXFLOAT;
+  guint i, smallest = 0;
+
+  /* only pixels completely inside the box are covered */
+  inner.x1 = ceilf (box->x1);
+  inner.y1 = ceilf (box->y1);
+  inner.x2 = floorf (box->x2);
+  inner.y2 = floorf (box->y2);
+
+  if (occlusion_box_is_empty (&inner))
+    return;
+
+  area = (inner.x2 - inner.x1) * (inner.y2 - inner.y1);
+
+  for (i = 0; i < data->n_occluders; )
+    {
+      OcclusionBox *o = &data->occluders[i];
+      gfloat o_area;
+
+      /* drop the occluders the new one makes redundant */
+      if (inner.x1 <= o->x1 && inner.y1 <= o->y1 &&
+          inner.x2 >= o->x2 && inner.y2 >= o->y2)
+        {
+          *o = data->occluders[--data->n_occluders];
+          continue;
+        }
+
+      o_area = (o->x2 - o->x1) * (o->y2 - o->y1);
+      if (o_area < smallest_area)
+        {
+          smallest_area = o_area;
+          smallest = i;
+        }
+
+      i++;
+    }
+
+  if (data->n_occluders < MAX_OCCLUDERS)
+    data->occluders[data->n_occluders++] = inner;
+  else if (area > smallest_area)
+    data->occluders[smallest] = inner;
+}
+
+static void
+clutter_actor_cull_occluded_internal (ClutterActor       *self,
+                                      OcclusionData      *data,
+                                      const OcclusionBox *parent_clip,
+                                      gfloat              off_x,
+                                      gfloat              off_y,
+                                      gfloat              scale_x,
+                                      gfloat              scale_y,
+                                      guint8              parent_opacity)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorClass *klass = CLUTTER_ACTOR_GET_CLASS (self);
+  ClutterActorBox opaque;
+  OcclusionBox clip, box;
+  gboolean has_paint_handlers;
+  guint8 opacity;
+
+  if (!CLUTTER_ACTOR_IS_VISIBLE (self))
+    return;
+
+  opacity = (parent_opacity * priv->opacity) / 0xff;
+  if (opacity == 0)
+    return;
+
+  if (priv->rxang != 0 || priv->ryang != 0 || priv->rzang != 0 ||
+      priv->z != 0)
+    return;
+
+  /* same order as _clutter_actor_apply_modelview_transform() */
+  off_x += CLUTTER_UNITS_TO_FLOAT (priv->allocation.x1) * scale_x;
+  off_y += CLUTTER_UNITS_TO_FLOAT (priv->allocation.y1) * scale_y;
+  scale_x *= CLUTTER_FIXED_TO_FLOAT (priv->scale_x);
+  scale_y *= CLUTTER_FIXED_TO_FLOAT (priv->scale_y);
+  off_x -= CLUTTER_UNITS_TO_FLOAT (priv->anchor_x) * scale_x;
+  off_y -= CLUTTER_UNITS_TO_FLOAT (priv->anchor_y) * scale_y;
+
+  clip = *parent_clip;
+
+  if (priv->has_clip)
+    {
+      OcclusionBox actor_clip;
+
+      occlusion_box_transform (&actor_clip,
+                               CLUTTER_UNITS_TO_FLOAT (priv->clip[0]),
+                               CLUTTER_UNITS_TO_FLOAT (priv->clip[1]),
+                               CLUTTER_UNITS_TO_FLOAT (priv->clip[0]
+                                                       + priv->clip[2]),
+                               CLUTTER_UNITS_TO_FLOAT (priv->clip[1]
+                                                       + priv->clip[3]),
+                               off_x, off_y,
+                               scale_x, scale_y);
+      occlusion_box_intersect (&clip, &actor_clip);
+
+      /* nothing inside the clip gets drawn, whatever the children */
+      if (occlusion_box_is_empty (&clip) || occlusion_is_covered (data, &clip))
+        goto culled;
+    }
+
+  has_paint_handlers = g_signal_has_handler_pending (self,
+                                                     actor_signals[PAINT],
+                                                     0, TRUE);
+
+  /* plain groups paint nothing but their children, so look at those,
+   * front to back
+   */
+  if (klass->paint == data->group_paint && !has_paint_handlers)
+    {
+      GList *children, *l;
+
+      children = clutter_container_get_children (CLUTTER_CONTAINER (self));
+
+      for (l = g_list_last (children); l != NULL; l = l->prev)
+        clutter_actor_cull_occluded_internal (l->data, data, &clip,
+                                              off_x, off_y,
+                                              scale_x, scale_y,
+                                              opacity);
+
+      g_list_free (children);
+
+      return;
+    }
+
+  /* anything else may paint outside of its allocation if it has
+   * children or paint handlers; without a clip we cannot bound it
+   */
+  if ((CLUTTER_IS_CONTAINER (self) || has_paint_handlers) && !priv->has_clip)
+    return;
+
+  occlusion_box_transform (&box,
+                           0, 0,
+                           CLUTTER_UNITS_TO_FLOAT (priv->allocation.x2
+                                                   - priv->allocation.x1),
+                           CLUTTER_UNITS_TO_FLOAT (priv->allocation.y2
+                                                   - priv->allocation.y1),
+                           off_x, off_y,
+                           scale_x, scale_y);
+  occlusion_box_intersect (&box, &clip);
+
+  if (occlusion_box_is_empty (&box) || occlusion_is_covered (data, &box))
+    goto culled;
+
+  if (opacity == 0xff &&
+      (priv->shader_data == NULL || priv->shader_data->shader == NULL) &&
+      klass->get_opaque_area != NULL &&
+      klass->get_opaque_area (self, &opaque))
+    {
+      occlusion_box_transform (&box,
+                               CLUTTER_UNITS_TO_FLOAT (opaque.x1),
+                               CLUTTER_UNITS_TO_FLOAT (opaque.y1),
+                               CLUTTER_UNITS_TO_FLOAT (opaque.x2),
+                               CLUTTER_UNITS_TO_FLOAT (opaque.y2),
+                               off_x, off_y,
+                               scale_x, scale_y);
+      occlusion_box_intersect (&box, &clip);
+      occlusion_add (data, &box);
+    }
+
+  return;
+
+culled:
+  CLUTTER_NOTE (PAINT, "Actor '%s' is occluded",
+                priv->name ? priv->name : "unknown");
+
+  priv->occluded_serial = data->serial;
+  data->n_culled += 1;
+}
+
+/*
+ * _clutter_actor_cull_occluded:
+ * @stage: the stage about to be painted
+ * @area: the area of the stage being redrawn
+ * @serial: non-zero value identifying the paint
+ *
+ * Marks the children of @stage that are not visible inside @area,
+ * because opaque actors cover them, with @serial; the stage must set
+ * the occlusion_serial of the main context to @serial while painting
+ * its children for clutter_actor_paint() to skip them.
+ *
+ * Return value: the number of actors (or subtrees) marked
+ */
+guint
+_clutter_actor_cull_occluded (ClutterActor          *stage,
+                              const ClutterGeometry *area,
+                              guint                  serial)
+{
+  ClutterActorPrivate *priv = stage->priv;
+  OcclusionData data;
+  OcclusionBox clip;
+  GList *children, *l;
+
+  g_assert (CLUTTER_IS_STAGE (stage));
+  g_assert (serial != 0);
+
+  /* the stage transform has no translation, but it can be rotated
+   * or scaled, e.g. for portrait mode
+   */
+  if (priv->rxang != 0 || priv->ryang != 0 || priv->rzang != 0 ||
+      priv->scale_x != CFX_ONE || priv->scale_y != CFX_ONE)
+    return 0;
+
+  data.n_occluders = 0;
+  data.serial = serial;
+  data.n_culled = 0;
+  data.group_paint =
+    CLUTTER_ACTOR_CLASS (g_type_class_peek (CLUTTER_TYPE_GROUP))->paint;
+
+  clip.x1 = area->x;
+  clip.y1 = area->y;
+  clip.x2 = area->x + (gint) area->width;
+  clip.y2 = area->y + (gint) area->height;
+
+  children = clutter_container_get_children (CLUTTER_CONTAINER (stage));
+
+  for (l = g_list_last (children); l != NULL; l = l->prev)
+    clutter_actor_cull_occluded_internal (l->data, &data, &clip,
+                                          0, 0, 1.0, 1.0,
+                                          priv->opacity);
+
+  g_list_free (children);
+
+  CLUTTER_NOTE (PAINT, "%u actors occluded by %u opaque areas",
+                data.n_culled, data.n_occluders);
+
+  return data.n_culled;
+}
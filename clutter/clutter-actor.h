@@ -266,9 +266,15 @@ struct _ClutterActorClass
   gboolean (* notify_modified)       (ClutterActor          *actor,
                                       ClutterActor          *child);
 
+  /* Returns TRUE and sets box, in actor coordinates, to an area that
+   * paint() covers with fully opaque pixels when the paint opacity is
+   * 255. Used by the stage to skip painting actors hidden behind it */
+  gboolean (* get_opaque_area)       (ClutterActor          *actor,
+                                      ClutterActorBox       *box);
+
   /*< private >*/
   /* padding for future expansion */
-  gpointer _padding_dummy[31];
+  gpointer _padding_dummy[30];
 };
 
 GType                 clutter_actor_get_type                  (void) G_GNUC_CONST;
@@ -284,6 +290,8 @@ void                  clutter_actor_pick                      (ClutterActor
                                                                const ClutterColor    *color);
 void                  clutter_actor_queue_redraw              (ClutterActor          *self);
 void                  clutter_actor_queue_redraw_damage       (ClutterActor          *self);
+void                  clutter_actor_queue_redraw_area         (ClutterActor          *self,
+                                                               const ClutterGeometry *area);
 void                  clutter_actor_queue_relayout            (ClutterActor          *self);
 void                  clutter_actor_destroy                   (ClutterActor          *self);
 
@@ -426,6 +434,8 @@ void                  clutter_actor_set_opacity               (ClutterActor
                                                                guint8                 opacity);
 guint8                clutter_actor_get_opacity               (ClutterActor          *self);
 guint8                clutter_actor_get_paint_opacity         (ClutterActor          *self);
+gboolean              clutter_actor_get_opaque_area           (ClutterActor          *self,
+                                                               ClutterActorBox       *box);
 
 void                  clutter_actor_set_name                  (ClutterActor          *self,
                                                                const gchar           *name);
@@ -512,6 +522,18 @@ ClutterShader *       clutter_actor_get_shader                (ClutterActor
 void                  clutter_actor_set_shader_param          (ClutterActor          *self,
                                                                const gchar           *param,
                                                                gfloat                 value);
+void                  clutter_actor_set_shader_param_vector   (ClutterActor          *self,
+                                                               const gchar           *param,
+                                                               gint                   size,
+                                                               const gfloat          *value);
+void                  clutter_actor_set_shader_param_int      (ClutterActor          *self,
+                                                               const gchar           *param,
+                                                               gint                   size,
+                                                               const gint            *value);
+void                  clutter_actor_set_shader_param_matrix   (ClutterActor          *self,
+                                                               const gchar           *param,
+                                                               gint                   size,
+                                                               const gfloat          *value);
 
 void     clutter_actor_set_anchor_point               (ClutterActor   *self,
                                                        gint            anchor_x,
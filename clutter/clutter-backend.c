@@ -55,6 +55,9 @@ struct _ClutterBackendPrivate
   ClutterFixed resolution;
 
   cairo_font_options_t *font_options;
+
+  /* set while several stages are redrawn as one frame */
+  guint in_redraw_pass : 1;
 };
 
 G_DEFINE_ABSTRACT_TYPE_WITH_CODE (ClutterBackend,
@@ -271,6 +274,44 @@ _clutter_backend_buffer_age (ClutterBackend *backend,
   return 0;
 }
 
+/* Starts redrawing several stages for the same frame. Until the pass
+ * ends, backends that can may leave the buffer swaps of the stages
+ * they redraw to end_redraw_pass, so that they are all done together
+ * after a single wait for the vertical blank
+ */
+void
+_clutter_backend_begin_redraw_pass (ClutterBackend *backend)
+{
+  ClutterBackendPrivate *priv = CLUTTER_BACKEND_GET_PRIVATE (backend);
+
+  g_assert (!priv->in_redraw_pass);
+
+  priv->in_redraw_pass = TRUE;
+}
+
+void
+_clutter_backend_end_redraw_pass (ClutterBackend *backend)
+{
+  ClutterBackendPrivate *priv = CLUTTER_BACKEND_GET_PRIVATE (backend);
+  ClutterBackendClass *klass;
+
+  g_assert (priv->in_redraw_pass);
+
+  priv->in_redraw_pass = FALSE;
+
+  klass = CLUTTER_BACKEND_GET_CLASS (backend);
+  if (klass->end_redraw_pass)
+    klass->end_redraw_pass (backend);
+}
+
+gboolean
+_clutter_backend_in_redraw_pass (ClutterBackend *backend)
+{
+  ClutterBackendPrivate *priv = CLUTTER_BACKEND_GET_PRIVATE (backend);
+
+  return priv->in_redraw_pass;
+}
+
 /**
  * clutter_get_default_backend:
  *
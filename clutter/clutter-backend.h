@@ -77,6 +77,7 @@ struct _ClutterBackendClass
                                             ClutterStage    *stage);
   int                 (* buffer_age)       (ClutterBackend  *backend,
                                             ClutterStage    *stage);
+  void                (* end_redraw_pass)  (ClutterBackend  *backend);
 };
 
 GType clutter_backend_get_type    (void) G_GNUC_CONST;
@@ -166,6 +166,8 @@ clutter_clone_texture_paint (ClutterActor *self)
   if (!CLUTTER_ACTOR_IS_REALIZED (parent_texture))
     clutter_actor_realize (parent_texture);
 
+  _clutter_texture_update_contents (priv->parent_texture);
+
   col.alpha = clutter_actor_get_paint_opacity (self);
   cogl_color (&col);
 
@@ -202,6 +204,128 @@ clutter_clone_texture_paint (ClutterActor *self)
 			  0, 0, t_w, t_h);
 }
 
+/*
+ * _clutter_clone_texture_paint_run:
+ * @children: a link in the children list of the group being painted
+ *
+ * Paints the clones of the same texture found in a row from @children,
+ * with a single draw. The clones must have the same paint opacity and
+ * be painted with their allocation translated and scaled.
+ *
+ * Return value: the link after the last clone painted, or @children
+ *   if fewer than two clones could be painted together, in which case
+ *   the caller should paint the actor at @children itself
+ */
+GList *
+_clutter_clone_texture_paint_run (GList *children)
+{
+  static GArray       *verts = NULL;
+  ClutterMainContext  *context;
+  ClutterTexture      *parent_texture;
+  ClutterColor         col = { 0xff, 0xff, 0xff, 0xff };
+  CoglHandle           cogl_texture;
+  guint                tex_width, tex_height;
+  guint                n_rects = 0;
+  guint8               opacity = 0;
+  GList               *l;
+
+  if (G_OBJECT_TYPE (children->data) != CLUTTER_TYPE_CLONE_TEXTURE)
+    return children;
+
+  parent_texture = CLUTTER_CLONE_TEXTURE (children->data)->priv->parent_texture;
+  if (parent_texture == NULL)
+    return children;
+
+  /* picking paints the silhouette of each actor in its own color */
+  context = clutter_context_get_default ();
+  if (context->pick_mode != CLUTTER_PICK_NONE)
+    return children;
+
+  if (!CLUTTER_ACTOR_IS_REALIZED (parent_texture))
+    clutter_actor_realize (CLUTTER_ACTOR (parent_texture));
+
+  _clutter_texture_update_contents (parent_texture);
+
+  cogl_texture = clutter_texture_get_cogl_texture (parent_texture);
+  if (cogl_texture == COGL_INVALID_HANDLE)
+    return children;
+
+  tex_width = cogl_texture_get_width (cogl_texture);
+  tex_height = cogl_texture_get_height (cogl_texture);
+
+  if (verts == NULL)
+    verts = g_array_new (FALSE, FALSE, sizeof (ClutterFixed));
+
+  g_array_set_size (verts, 0);
+
+  for (l = children; l != NULL; l = l->next)
+    {
+      ClutterActor               *child = l->data;
+      ClutterCloneTexturePrivate *priv;
+      ClutterActorBox             box;
+      ClutterFixed                rect[8];
+      guint8                      child_opacity;
+
+      if (G_OBJECT_TYPE (child) != CLUTTER_TYPE_CLONE_TEXTURE)
+        break;
+
+      priv = CLUTTER_CLONE_TEXTURE (child)->priv;
+
+      if (priv->parent_texture != parent_texture ||
+          !_clutter_actor_get_paint_box (child, &box, &child_opacity))
+        break;
+
+      /* not painted anyway */
+      if (child_opacity == 0)
+        continue;
+
+      if (n_rects > 0 && child_opacity != opacity)
+        break;
+
+      opacity = child_opacity;
+
+      rect[0] = CLUTTER_UNITS_TO_FIXED (box.x1);
+      rect[1] = CLUTTER_UNITS_TO_FIXED (box.y1);
+      rect[2] = CLUTTER_UNITS_TO_FIXED (box.x2);
+      rect[3] = CLUTTER_UNITS_TO_FIXED (box.y2);
+      rect[4] = 0;
+      rect[5] = 0;
+      rect[6] = CFX_ONE;
+      rect[7] = CFX_ONE;
+
+      if (priv->repeat_x || priv->repeat_y)
+        {
+          gint x_1, y_1, x_2, y_2;
+
+          clutter_actor_get_allocation_coords (child, &x_1, &y_1, &x_2, &y_2);
+
+          if (priv->repeat_x && tex_width > 0)
+            rect[6] = CFX_QDIV (CLUTTER_INT_TO_FIXED (x_2 - x_1),
+                                CLUTTER_INT_TO_FIXED (tex_width));
+          if (priv->repeat_y && tex_height > 0)
+            rect[7] = CFX_QDIV (CLUTTER_INT_TO_FIXED (y_2 - y_1),
+                                CLUTTER_INT_TO_FIXED (tex_height));
+        }
+
+      g_array_append_vals (verts, rect, 8);
+      n_rects += 1;
+    }
+
+  if (n_rects < 2)
+    return children;
+
+  CLUTTER_NOTE (PAINT, "painting %u clone textures at once", n_rects);
+
+  col.alpha = opacity;
+  cogl_color (&col);
+
+  cogl_texture_multiple_rectangles (cogl_texture,
+                                    (ClutterFixed *) verts->data,
+                                    n_rects);
+
+  return l;
+}
+
 static void
 set_parent_texture (ClutterCloneTexture *ctexture,
 		    ClutterTexture      *texture)
@@ -212,6 +336,7 @@ set_parent_texture (ClutterCloneTexture *ctexture,
 
   if (priv->parent_texture)
     {
+      _clutter_texture_remove_clone (priv->parent_texture, actor);
       g_object_unref (priv->parent_texture);
       priv->parent_texture = NULL;
 
@@ -222,6 +347,7 @@ set_parent_texture (ClutterCloneTexture *ctexture,
   if (texture) 
     {
       priv->parent_texture = g_object_ref (texture);
+      _clutter_texture_add_clone (priv->parent_texture, actor);
 
       /* queue a redraw if the cloned texture is already visible */
       if (CLUTTER_ACTOR_IS_VISIBLE (priv->parent_texture) &&
@@ -243,7 +369,11 @@ clutter_clone_texture_dispose (GObject *object)
   ClutterCloneTexturePrivate  *priv = self->priv;  
 
   if (priv->parent_texture)
-    g_object_unref (priv->parent_texture);
+    {
+      _clutter_texture_remove_clone (priv->parent_texture,
+                                     CLUTTER_ACTOR (self));
+      g_object_unref (priv->parent_texture);
+    }
 
   priv->parent_texture = NULL;
 
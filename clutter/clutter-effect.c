@@ -33,6 +33,15 @@
  * pre-defined effects to a single actor. It works as a wrapper around
  * the #ClutterBehaviour objects
  *
+ * The timeline, alpha and behaviour of a finished effect are kept by
+ * the #ClutterEffectTemplate and reused by the next effect of the same
+ * kind, unless something else is still connected to the timeline.
+ * Starting an effect on an actor that is already running an effect of
+ * the same kind from the same template retargets the running effect
+ * instead of adding a new one, again unless something else is using
+ * its timeline; the #ClutterEffectCompleteFunc of the running effect is
+ * called before it is replaced by the new one.
+ *
  * Since: 0.4
  */
 
@@ -57,8 +66,26 @@
 
 #include "clutter-effect.h"
 
+typedef enum {
+  EFFECT_FADE,
+  EFFECT_DEPTH,
+  EFFECT_MOVE,
+  EFFECT_PATH,
+  EFFECT_SCALE,
+  EFFECT_ROTATE,
+
+  N_EFFECTS
+} ClutterEffectKind;
+
+/* maximum number of finished closures kept around for each kind of
+ * effect by a template
+ */
+#define EFFECT_CLOSURE_POOL_SIZE        8
+
 typedef struct ClutterEffectClosure
 {
+  ClutterEffectKind         kind;
+
   ClutterActor             *actor;
   ClutterTimeline          *timeline;
   ClutterAlpha             *alpha;
@@ -82,8 +109,19 @@ struct _ClutterEffectTemplatePrivate
   ClutterAlphaFunc alpha_func;
   gpointer alpha_data;
   GDestroyNotify alpha_notify;
+
+  /* finished closures, ready to be reused by the next effect
+   * of the same kind
+   */
+  GSList *free_closures[N_EFFECTS];
+  guint n_free_closures[N_EFFECTS];
 };
 
+/* list of the running closures of an actor */
+static GQuark quark_effect_closures = 0;
+
+static void clutter_effect_closure_destroy (ClutterEffectClosure *c);
+
 G_DEFINE_TYPE_WITH_CODE (ClutterEffectTemplate,
                          clutter_effect_template,
                          G_TYPE_OBJECT,
@@ -123,6 +161,7 @@ clutter_effect_template_dispose (GObject *object)
 {
   ClutterEffectTemplate        *template;
   ClutterEffectTemplatePrivate *priv;
+  gint                          i;
 
   template  = CLUTTER_EFFECT_TEMPLATE (object);
   priv      = template->priv;
@@ -133,6 +172,17 @@ clutter_effect_template_dispose (GObject *object)
       priv->timeline   = NULL;
     }
 
+  for (i = 0; i < N_EFFECTS; i++)
+    {
+      g_slist_foreach (priv->free_closures[i],
+                       (GFunc) clutter_effect_closure_destroy,
+                       NULL);
+      g_slist_free (priv->free_closures[i]);
+
+      priv->free_closures[i] = NULL;
+      priv->n_free_closures[i] = 0;
+    }
+
   G_OBJECT_CLASS (clutter_effect_template_parent_class)->dispose (object);
 }
 
@@ -199,6 +249,9 @@ clutter_effect_template_class_init (ClutterEffectTemplateClass *klass)
   object_class->set_property = clutter_effect_template_set_property;
   object_class->get_property = clutter_effect_template_get_property;
 
+  quark_effect_closures =
+    g_quark_from_static_string ("clutter-effect-closures");
+
   /**
    * ClutterEffectTemplate:timeline:
    *
@@ -479,22 +532,142 @@ clutter_effect_template_construct (ClutterEffectTemplate *template_,
                                           user_data, notify);
 }
 
+/* Frees a closure for good; the closure must not be running */
 static void
 clutter_effect_closure_destroy (ClutterEffectClosure *c)
 {
   g_signal_handler_disconnect (c->timeline, c->signal_id);
 
-  g_object_unref (c->actor);
-  g_object_unref (c->template);
-  g_object_unref (c->behave);
+  if (c->actor)
+    g_object_unref (c->actor);
+
+  if (c->template)
+    g_object_unref (c->template);
+
+  if (c->behave)
+    g_object_unref (c->behave);
+
   g_object_unref (c->timeline);
 
   g_slice_free (ClutterEffectClosure, c);
 }
 
+/* references on the timeline of a closure held by the effect itself:
+ * the closure's and the alpha's
+ */
+#define EFFECT_CLOSURE_TIMELINE_REFS    2
+
+/* Checks whether nobody but the effect itself holds or is listening to
+ * the timeline of @c, so that the timeline can be safely reused; @n_refs
+ * is the number of references expected on the timeline
+ */
+static gboolean
+clutter_effect_closure_is_private (ClutterEffectClosure *c,
+                                   guint                 n_refs)
+{
+  static guint *signal_ids = NULL;
+  static guint n_signal_ids = 0;
+  gboolean retval = TRUE;
+  guint i;
+
+  if (G_OBJECT (c->timeline)->ref_count != n_refs)
+    return FALSE;
+
+  if (G_UNLIKELY (signal_ids == NULL))
+    signal_ids = g_signal_list_ids (CLUTTER_TYPE_TIMELINE, &n_signal_ids);
+
+  g_signal_handlers_block_matched (c->timeline, G_SIGNAL_MATCH_DATA,
+                                   0, 0, NULL, NULL, c);
+  g_signal_handlers_block_matched (c->timeline, G_SIGNAL_MATCH_DATA,
+                                   0, 0, NULL, NULL, c->alpha);
+
+  for (i = 0; i < n_signal_ids; i++)
+    {
+      if (g_signal_has_handler_pending (c->timeline, signal_ids[i], 0, FALSE))
+        {
+          retval = FALSE;
+          break;
+        }
+    }
+
+  g_signal_handlers_unblock_matched (c->timeline, G_SIGNAL_MATCH_DATA,
+                                     0, 0, NULL, NULL, c->alpha);
+  g_signal_handlers_unblock_matched (c->timeline, G_SIGNAL_MATCH_DATA,
+                                     0, 0, NULL, NULL, c);
+
+  return retval;
+}
+
+/* Detaches a finished closure from its actor and either puts it back
+ * into the pool of its template, or destroys it
+ */
+static void
+clutter_effect_closure_release (ClutterEffectClosure *c)
+{
+  ClutterEffectTemplate *template = c->template;
+  ClutterEffectTemplatePrivate *priv = template->priv;
+
+  if (c->behave && clutter_behaviour_is_applied (c->behave, c->actor))
+    clutter_behaviour_remove (c->behave, c->actor);
+
+  g_object_unref (c->actor);
+  c->actor = NULL;
+
+  c->completed_func = NULL;
+  c->completed_data = NULL;
+
+  if (!priv->do_clone ||
+      c->behave == NULL ||
+      priv->n_free_closures[c->kind] >= EFFECT_CLOSURE_POOL_SIZE ||
+      /* the timeline holds a reference while emitting ::completed */
+      !clutter_effect_closure_is_private (c, EFFECT_CLOSURE_TIMELINE_REFS + 1))
+    {
+      clutter_effect_closure_destroy (c);
+      return;
+    }
+
+  /* pooled closures do not keep the template alive, otherwise the
+   * template would never be disposed
+   */
+  c->template = NULL;
+
+  priv->free_closures[c->kind] =
+    g_slist_prepend (priv->free_closures[c->kind], c);
+  priv->n_free_closures[c->kind] += 1;
+
+  g_object_unref (template);
+}
+
+static void
+clutter_effect_closure_attach (ClutterEffectClosure *c,
+                               ClutterActor         *actor)
+{
+  GSList *closures;
+
+  c->actor = g_object_ref (actor);
+
+  closures = g_object_steal_qdata (G_OBJECT (actor), quark_effect_closures);
+  closures = g_slist_prepend (closures, c);
+  g_object_set_qdata (G_OBJECT (actor), quark_effect_closures, closures);
+}
+
+static void
+clutter_effect_closure_detach (ClutterEffectClosure *c)
+{
+  GSList *closures;
+
+  closures = g_object_steal_qdata (G_OBJECT (c->actor),
+                                   quark_effect_closures);
+  closures = g_slist_remove (closures, c);
+
+  if (closures)
+    g_object_set_qdata (G_OBJECT (c->actor), quark_effect_closures,
+                        closures);
+}
+
 static ClutterEffectClosure *
 clutter_effect_closure_new (ClutterEffectTemplate *template,
-			    ClutterActor          *actor,
+                            ClutterEffectKind      kind,
 			    GCallback              complete)
 {
   ClutterEffectClosure *c;
@@ -502,11 +675,8 @@ clutter_effect_closure_new (ClutterEffectTemplate *template,
 
   c = g_slice_new0(ClutterEffectClosure);
 
-  g_object_ref (actor);
-  g_object_ref (template);
-
-  c->template = template;
-  c->actor    = actor;
+  c->kind     = kind;
+  c->template = g_object_ref (template);
 
   if (clutter_effect_template_get_timeline_clone (template))
     c->timeline = clutter_timeline_clone (priv->timeline);
@@ -527,16 +697,131 @@ clutter_effect_closure_new (ClutterEffectTemplate *template,
   return c;
 }
 
+static void on_effect_complete (ClutterTimeline *timeline,
+                                gpointer         user_data);
+
+/*
+ * Returns the closure to be used for a new effect of @kind on @actor.
+ *
+ * If @actor is already running an effect of the same kind created by
+ * @template, and the timeline is owned by the effect, that effect is
+ * stopped, its completion callback is called and it is returned so
+ * that it can be retargeted; otherwise a closure
+ * is taken from the pool of the template, or created from scratch. The
+ * behaviour of the returned closure, if any, is ready to be reused.
+ */
+static ClutterEffectClosure *
+clutter_effect_closure_get (ClutterEffectTemplate *template,
+                            ClutterActor          *actor,
+                            ClutterEffectKind      kind)
+{
+  ClutterEffectTemplatePrivate *priv = template->priv;
+  ClutterEffectClosure *c;
+  GSList *l;
+
+  if (priv->do_clone)
+    {
+      l = g_object_get_qdata (G_OBJECT (actor), quark_effect_closures);
+      for (; l != NULL; l = l->next)
+        {
+          c = l->data;
+
+          if (c->template == template && c->kind == kind &&
+              clutter_effect_closure_is_private (c, EFFECT_CLOSURE_TIMELINE_REFS))
+            {
+              ClutterEffectCompleteFunc completed_func = c->completed_func;
+
+              CLUTTER_NOTE (MISC, "Retargeting running effect %p", c);
+
+              clutter_timeline_stop (c->timeline);
+
+              /* the running effect is over as far as its caller is
+               * concerned; detach while notifying, so that effects
+               * started from the callback do not retarget this one
+               */
+              if (completed_func)
+                {
+                  clutter_effect_closure_detach (c);
+
+                  c->completed_func = NULL;
+                  completed_func (c->actor, c->completed_data);
+                  c->completed_data = NULL;
+
+                  /* attaching takes a reference of its own */
+                  clutter_effect_closure_attach (c, actor);
+                  g_object_unref (actor);
+                }
+
+              return c;
+            }
+        }
+    }
+
+  if (priv->free_closures[kind])
+    {
+      l = priv->free_closures[kind];
+      c = l->data;
+
+      priv->free_closures[kind] = g_slist_delete_link (l, l);
+      priv->n_free_closures[kind] -= 1;
+
+      c->template = g_object_ref (template);
+
+      /* the template timeline might have been changed since the
+       * closure was created
+       */
+      clutter_timeline_set_n_frames (c->timeline,
+                                     clutter_timeline_get_n_frames (priv->timeline));
+      clutter_timeline_set_speed (c->timeline,
+                                  clutter_timeline_get_speed (priv->timeline));
+      clutter_timeline_set_loop (c->timeline,
+                                 clutter_timeline_get_loop (priv->timeline));
+      clutter_timeline_set_delay (c->timeline,
+                                  clutter_timeline_get_delay (priv->timeline));
+      clutter_timeline_set_direction (c->timeline,
+                                      clutter_timeline_get_direction (priv->timeline));
+      clutter_timeline_rewind (c->timeline);
+    }
+  else
+    c = clutter_effect_closure_new (template, kind,
+                                    G_CALLBACK (on_effect_complete));
+
+  clutter_effect_closure_attach (c, actor);
+
+  return c;
+}
+
+static ClutterTimeline *
+clutter_effect_closure_start (ClutterEffectClosure      *c,
+                              ClutterEffectCompleteFunc  func,
+                              gpointer                   data)
+{
+  c->completed_func = func;
+  c->completed_data = data;
+
+  if (!clutter_behaviour_is_applied (c->behave, c->actor))
+    clutter_behaviour_apply (c->behave, c->actor);
+
+  clutter_timeline_start (c->timeline);
+
+  return c->timeline;
+}
+
 static void
 on_effect_complete (ClutterTimeline *timeline,
 		    gpointer         user_data)
 {
   ClutterEffectClosure *c =  (ClutterEffectClosure*)user_data;
 
+  /* detach before notifying, so that starting a new effect of the
+   * same kind from the callback does not retarget this one
+   */
+  clutter_effect_closure_detach (c);
+
   if (c->completed_func)
     c->completed_func (c->actor, c->completed_data);
 
-  clutter_effect_closure_destroy (c);
+  clutter_effect_closure_release (c);
 }
 
 /**
@@ -566,23 +851,20 @@ clutter_effect_fade (ClutterEffectTemplate     *template_,
   ClutterEffectClosure *c;
   guint8 opacity_start;
 
-  c = clutter_effect_closure_new (template_,
-				  actor,
-				  G_CALLBACK (on_effect_complete));
-
-  c->completed_func = func;
-  c->completed_data = data;
+  c = clutter_effect_closure_get (template_, actor, EFFECT_FADE);
 
   opacity_start = clutter_actor_get_opacity (actor);
 
-  c->behave = clutter_behaviour_opacity_new (c->alpha,
-					     opacity_start,
-					     opacity_end);
-
-  clutter_behaviour_apply (c->behave, actor);
-  clutter_timeline_start (c->timeline);
+  if (c->behave)
+    clutter_behaviour_opacity_set_bounds (CLUTTER_BEHAVIOUR_OPACITY (c->behave),
+                                          opacity_start,
+                                          opacity_end);
+  else
+    c->behave = clutter_behaviour_opacity_new (c->alpha,
+                                               opacity_start,
+                                               opacity_end);
 
-  return c->timeline;
+  return clutter_effect_closure_start (c, func, data);
 }
 
 /**
@@ -612,21 +894,17 @@ clutter_effect_depth (ClutterEffectTemplate     *template_,
   ClutterEffectClosure *c;
   gint depth_start;
 
-  c = clutter_effect_closure_new (template_,
-				  actor,
-				  G_CALLBACK (on_effect_complete));
-
-  c->completed_func = func;
-  c->completed_data = data;
+  c = clutter_effect_closure_get (template_, actor, EFFECT_DEPTH);
 
   depth_start = clutter_actor_get_depth (actor);
 
-  c->behave = clutter_behaviour_depth_new (c->alpha, depth_start, depth_end);
-
-  clutter_behaviour_apply (c->behave, actor);
-  clutter_timeline_start (c->timeline);
+  if (c->behave)
+    clutter_behaviour_depth_set_bounds (CLUTTER_BEHAVIOUR_DEPTH (c->behave),
+                                        depth_start, depth_end);
+  else
+    c->behave = clutter_behaviour_depth_new (c->alpha, depth_start, depth_end);
 
-  return c->timeline;
+  return clutter_effect_closure_start (c, func, data);
 }
 
 /**
@@ -659,12 +937,7 @@ clutter_effect_move (ClutterEffectTemplate     *template_,
   ClutterEffectClosure *c;
   ClutterKnot knots[2];
 
-  c = clutter_effect_closure_new (template_,
-				  actor,
-				  G_CALLBACK (on_effect_complete));
-
-  c->completed_func = func;
-  c->completed_data = data;
+  c = clutter_effect_closure_get (template_, actor, EFFECT_MOVE);
 
   knots[0].x = clutter_actor_get_x (actor);
   knots[0].y = clutter_actor_get_y (actor);
@@ -672,12 +945,18 @@ clutter_effect_move (ClutterEffectTemplate     *template_,
   knots[1].x = x;
   knots[1].y = y;
 
-  c->behave = clutter_behaviour_path_new (c->alpha, knots, 2);
+  if (c->behave)
+    {
+      ClutterBehaviourPath *path = CLUTTER_BEHAVIOUR_PATH (c->behave);
 
-  clutter_behaviour_apply (c->behave, actor);
-  clutter_timeline_start (c->timeline);
+      clutter_behaviour_path_clear (path);
+      clutter_behaviour_path_append_knot (path, &knots[0]);
+      clutter_behaviour_path_append_knot (path, &knots[1]);
+    }
+  else
+    c->behave = clutter_behaviour_path_new (c->alpha, knots, 2);
 
-  return c->timeline;
+  return clutter_effect_closure_start (c, func, data);
 }
 /**
  * clutter_effect_path:
@@ -707,22 +986,25 @@ clutter_effect_path (ClutterEffectTemplate     *template_,
 {
   ClutterEffectClosure *c;
 
-  c = clutter_effect_closure_new (template_,
-				  actor,
-				  G_CALLBACK (on_effect_complete));
-
-  c->completed_func = func;
-  c->completed_data = data;
+  c = clutter_effect_closure_get (template_, actor, EFFECT_PATH);
 
   if (n_knots)
     clutter_actor_set_position (actor, knots[0].x, knots[0].y);
 
-  c->behave = clutter_behaviour_path_new (c->alpha, knots, n_knots);
+  if (c->behave)
+    {
+      ClutterBehaviourPath *path = CLUTTER_BEHAVIOUR_PATH (c->behave);
+      guint i;
 
-  clutter_behaviour_apply (c->behave, actor);
-  clutter_timeline_start (c->timeline);
+      clutter_behaviour_path_clear (path);
 
-  return c->timeline;
+      for (i = 0; i < n_knots; i++)
+        clutter_behaviour_path_append_knot (path, &knots[i]);
+    }
+  else
+    c->behave = clutter_behaviour_path_new (c->alpha, knots, n_knots);
+
+  return clutter_effect_closure_start (c, func, data);
 }
 
 /**
@@ -754,22 +1036,20 @@ clutter_effect_scale (ClutterEffectTemplate     *template_,
   ClutterEffectClosure *c;
   gdouble x_scale_start, y_scale_start;
 
-  c = clutter_effect_closure_new (template_,
-				  actor,
-				  G_CALLBACK (on_effect_complete));
-
-  c->completed_func = func;
-  c->completed_data = data;
+  c = clutter_effect_closure_get (template_, actor, EFFECT_SCALE);
 
   clutter_actor_get_scale (actor, &x_scale_start, &y_scale_start);
-  c->behave = clutter_behaviour_scale_new (c->alpha,
-					   x_scale_start, y_scale_start,
-					   x_scale_end, y_scale_end);
 
-  clutter_behaviour_apply (c->behave, actor);
-  clutter_timeline_start (c->timeline);
+  if (c->behave)
+    clutter_behaviour_scale_set_bounds (CLUTTER_BEHAVIOUR_SCALE (c->behave),
+                                        x_scale_start, y_scale_start,
+                                        x_scale_end, y_scale_end);
+  else
+    c->behave = clutter_behaviour_scale_new (c->alpha,
+                                             x_scale_start, y_scale_start,
+                                             x_scale_end, y_scale_end);
 
-  return c->timeline;
+  return clutter_effect_closure_start (c, func, data);
 }
 
 /**
@@ -808,28 +1088,27 @@ clutter_effect_rotate (ClutterEffectTemplate     *template_,
   ClutterEffectClosure *c;
   gdouble angle_start;
 
-  c = clutter_effect_closure_new (template_,
-				  actor,
-				  G_CALLBACK (on_effect_complete));
-
-  c->completed_func = func;
-  c->completed_data = data;
+  c = clutter_effect_closure_get (template_, actor, EFFECT_ROTATE);
 
   angle_start = clutter_actor_get_rotation (actor, axis, NULL, NULL, NULL);
 
-  c->behave = clutter_behaviour_rotate_new (c->alpha,
-                                            axis,
-					    direction,
-					    angle_start,
-					    angle_end);
-  g_object_set (c->behave,
-                "center-x", center_x,
-		"center-y", center_y,
-		"center-z", center_z,
-		NULL);
-
-  clutter_behaviour_apply (c->behave, actor);
-  clutter_timeline_start (c->timeline);
+  if (c->behave)
+    {
+      ClutterBehaviourRotate *rotate = CLUTTER_BEHAVIOUR_ROTATE (c->behave);
 
-  return c->timeline;
+      clutter_behaviour_rotate_set_axis (rotate, axis);
+      clutter_behaviour_rotate_set_direction (rotate, direction);
+      clutter_behaviour_rotate_set_bounds (rotate, angle_start, angle_end);
+    }
+  else
+    c->behave = clutter_behaviour_rotate_new (c->alpha,
+                                              axis,
+                                              direction,
+                                              angle_start,
+                                              angle_end);
+
+  clutter_behaviour_rotate_set_center (CLUTTER_BEHAVIOUR_ROTATE (c->behave),
+                                       center_x, center_y, center_z);
+
+  return clutter_effect_closure_start (c, func, data);
 }
@@ -96,10 +96,17 @@ struct _ClutterEntryPrivate
   ClutterColor          fgcol;
 
   gchar                *text;
+  gsize                 text_size; /* allocated size of text */
   gchar                *font_name;
   gboolean              text_visible;
   gunichar              priv_char;
 
+  /* the string of invisible characters, kept in sync with
+   * the text when text_visible is FALSE
+   */
+  GString              *mask;
+  gint                  mask_char_len;
+
   gint                  extents_width;
   gint                  extents_height;
 
@@ -125,7 +132,14 @@ struct _ClutterEntryPrivate
   PangoLayout          *layout;
   gint                  width_chars;
 
+  /* the text of the layout needs to be updated */
+  guint                 text_dirty    : 1;
+  /* cursor_layout_pos is up to date */
+  guint                 cursor_valid  : 1;
+
+  ClutterGeometry       cursor_layout_pos;
   ClutterGeometry       cursor_pos;
+  ClutterGeometry       painted_cursor;
   gboolean              show_cursor;
 };
 
@@ -252,6 +266,78 @@ clutter_entry_get_property (GObject    *object,
     }
 }
 
+static void
+clutter_entry_ensure_mask (ClutterEntry *entry)
+{
+  ClutterEntryPrivate *priv = entry->priv;
+  gunichar invisible_char;
+  gchar buf[7];
+  gint i;
+
+  if (priv->text_visible)
+    {
+      if (priv->mask)
+        {
+          g_string_free (priv->mask, TRUE);
+          priv->mask = NULL;
+        }
+
+      return;
+    }
+
+  if (priv->priv_char != 0)
+    invisible_char = priv->priv_char;
+  else
+    invisible_char = '*';
+
+  /* we need to convert the string built of invisible characters
+   * into UTF-8 for it to be fed to the Pango layout
+   */
+  memset (buf, 0, sizeof (buf));
+  priv->mask_char_len = g_unichar_to_utf8 (invisible_char, buf);
+
+  if (priv->mask == NULL)
+    priv->mask = g_string_sized_new (priv->n_chars * priv->mask_char_len);
+  else
+    g_string_truncate (priv->mask, 0);
+
+  for (i = 0; i < priv->n_chars; i++)
+    g_string_append_len (priv->mask, buf, priv->mask_char_len);
+}
+
+/* all the characters of the mask are the same, so it only needs
+ * to grow or shrink at the end when the text changes
+ */
+static void
+clutter_entry_update_mask (ClutterEntry *entry,
+                           gint          old_n_chars)
+{
+  ClutterEntryPrivate *priv = entry->priv;
+  gint i;
+
+  if (priv->mask == NULL)
+    return;
+
+  if (priv->n_chars < old_n_chars)
+    g_string_truncate (priv->mask, priv->n_chars * priv->mask_char_len);
+  else
+    {
+      const gchar *invisible_char = priv->mask->str;
+      gchar buf[7];
+
+      if (old_n_chars == 0)
+        {
+          clutter_entry_ensure_mask (entry);
+          return;
+        }
+
+      memcpy (buf, invisible_char, priv->mask_char_len);
+
+      for (i = old_n_chars; i < priv->n_chars; i++)
+        g_string_append_len (priv->mask, buf, priv->mask_char_len);
+    }
+}
+
 static void
 clutter_entry_ensure_layout (ClutterEntry *entry, gint width)
 {
@@ -273,34 +359,6 @@ clutter_entry_ensure_layout (ClutterEntry *entry, gint width)
 
       pango_layout_set_font_description (priv->layout, priv->desc);
 
-      if (priv->text_visible)
-        pango_layout_set_text (priv->layout, priv->text, priv->n_bytes);
-      else
-        {
-          GString *str = g_string_sized_new (priv->n_bytes);
-          gunichar invisible_char;
-          gchar buf[7];
-          gint char_len, i;
-
-          if (priv->priv_char != 0)
-            invisible_char = priv->priv_char;
-          else
-            invisible_char = '*';
-
-          /* we need to convert the string built of invisible characters
-           * into UTF-8 for it to be fed to the Pango layout
-           */
-          memset (buf, 0, sizeof (buf));
-          char_len = g_unichar_to_utf8 (invisible_char, buf);
-
-          for (i = 0; i < priv->n_chars; i++)
-            g_string_append_len (str, buf, char_len);
-
-          pango_layout_set_text (priv->layout, str->str, str->len);
-
-          g_string_free (str, TRUE);
-        }
-
       if (priv->wrap)
 	pango_layout_set_wrap  (priv->layout, priv->wrap_mode);
 
@@ -309,6 +367,26 @@ clutter_entry_ensure_layout (ClutterEntry *entry, gint width)
       else
 	pango_layout_set_width (priv->layout, -1);
 
+      priv->text_dirty = TRUE;
+    }
+
+  /* edits only replace the text of the layout, and only once
+   * per frame, however many edits there were since the last one
+   */
+  if (priv->text_dirty)
+    {
+      if (priv->text == NULL)
+        pango_layout_set_text (priv->layout, "", 0);
+      else if (priv->text_visible)
+        pango_layout_set_text (priv->layout, priv->text, priv->n_bytes);
+      else
+        pango_layout_set_text (priv->layout,
+                               priv->mask->str,
+                               priv->mask->len);
+
+      priv->text_dirty = FALSE;
+      priv->cursor_valid = FALSE;
+
       /* Prime the cache for the layout */
       pango_clutter_ensure_glyph_cache_for_layout (priv->layout);
     }
@@ -327,30 +405,15 @@ clutter_entry_clear_layout (ClutterEntry *entry)
 static gint
 offset_to_bytes (const gchar *text, gint pos)
 {
-  gchar *c = NULL;
-  gint i, j, len;
+  const gchar *c;
 
-  if (pos < 1)
-    return pos;
+  if (pos < 1 || text == NULL)
+    return pos < 1 ? pos : 0;
 
-  c = g_utf8_next_char (text);
-  j = 1;
-  len = strlen (text);
+  for (c = text; *c != '\0' && pos > 0; pos--)
+    c = g_utf8_next_char (c);
 
-  for (i = 0; i < len; i++)
-    {
-      if (&text[i] == c)
-      {
-        if (j == pos)
-          break;
-        else
-          {
-            c = g_utf8_next_char (c);
-            j++;
-          }
-      }
-    }
-  return i;
+  return c - text;
 }
 
 
@@ -360,46 +423,128 @@ clutter_entry_ensure_cursor_position (ClutterEntry *entry)
   ClutterEntryPrivate  *priv;
   gint                  index_;
   PangoRectangle        rect;
-  gint                  priv_char_bytes;
 
   priv = entry->priv;
 
-  /* If characters are invisible, get the byte-length of the invisible
-   * character. If priv_char is 0, we use '*', which is ASCII (1 byte).
+  /* moving the cursor does not need to touch the layout, and
+   * painting does not need to query the cursor again
    */
-  if (!priv->text_visible && priv->priv_char)
-    priv_char_bytes = g_unichar_to_utf8 (priv->priv_char, NULL);
-  else
-    priv_char_bytes = 1;
-  
-  if (priv->position == -1)
-    {
-      if (priv->text_visible)
-        index_ = strlen (priv->text);
-      else
-        index_ = priv->n_chars * priv_char_bytes;
-    }
-  else
+  if (!priv->cursor_valid)
     {
-      if (priv->text_visible)
-        index_ = offset_to_bytes (priv->text, priv->position);
+      if (priv->position == -1)
+        {
+          if (priv->text_visible)
+            index_ = priv->n_bytes;
+          else
+            index_ = priv->n_chars * priv->mask_char_len;
+        }
       else
-        index_ = priv->position * priv_char_bytes;
-    }
+        {
+          if (priv->text_visible)
+            index_ = offset_to_bytes (priv->text, priv->position);
+          else
+            index_ = priv->position * priv->mask_char_len;
+        }
 
-  pango_layout_get_cursor_pos (priv->layout, index_, &rect, NULL);
-  priv->cursor_pos.x = rect.x / PANGO_SCALE;
-  priv->cursor_pos.y = rect.y / PANGO_SCALE;
-  priv->cursor_pos.width = ENTRY_CURSOR_WIDTH;
-  priv->cursor_pos.height = rect.height / PANGO_SCALE;
+      pango_layout_get_cursor_pos (priv->layout, index_, &rect, NULL);
+      priv->cursor_layout_pos.x = rect.x / PANGO_SCALE;
+      priv->cursor_layout_pos.y = rect.y / PANGO_SCALE;
+      priv->cursor_layout_pos.width = ENTRY_CURSOR_WIDTH;
+      priv->cursor_layout_pos.height = rect.height / PANGO_SCALE;
 
-  g_signal_emit (entry, entry_signals[CURSOR_EVENT], 0, &priv->cursor_pos);
+      priv->cursor_valid = TRUE;
+
+      g_signal_emit (entry, entry_signals[CURSOR_EVENT], 0,
+                     &priv->cursor_layout_pos);
+    }
+
+  /* painting offsets cursor_pos by the scrolling of the text */
+  priv->cursor_pos = priv->cursor_layout_pos;
 }
 
 static void
 clutter_entry_clear_cursor_position (ClutterEntry *entry)
 {
   entry->priv->cursor_pos.width = 0;
+  entry->priv->cursor_valid = FALSE;
+}
+
+/* replaces n_delete bytes of the text at byte offset start with
+ * the first length bytes of text, in place; the layout is updated
+ * on the next paint. returns the number of inserted characters,
+ * which can be less than the characters in text if the entry has
+ * a maximum length
+ */
+static gint
+clutter_entry_replace_text (ClutterEntry *entry,
+                            gint          start,
+                            gint          n_delete,
+                            const gchar  *text,
+                            gint          length)
+{
+  ClutterEntryPrivate *priv = entry->priv;
+  gint n_deleted_chars, n_inserted_chars;
+  gint old_n_chars, new_n_bytes;
+  gchar *copy = NULL;
+
+  g_assert (start >= 0 && n_delete >= 0);
+  g_assert (start + n_delete <= priv->n_bytes);
+
+  /* the text is edited in place, so it cannot be the source as well */
+  if (priv->text != NULL &&
+      text >= priv->text && text < priv->text + priv->text_size)
+    text = copy = g_strndup (text, length);
+
+  n_deleted_chars = n_delete > 0
+                  ? g_utf8_strlen (priv->text + start, n_delete)
+                  : 0;
+  n_inserted_chars = g_utf8_strlen (text, length);
+
+  if (priv->max_length > 0 &&
+      priv->n_chars - n_deleted_chars + n_inserted_chars > priv->max_length)
+    {
+      n_inserted_chars = MAX (priv->max_length
+                              - (priv->n_chars - n_deleted_chars),
+                              0);
+      length = g_utf8_offset_to_pointer (text, n_inserted_chars) - text;
+    }
+
+  new_n_bytes = priv->n_bytes - n_delete + length;
+
+  if (priv->text == NULL || (gsize) new_n_bytes + 1 > priv->text_size)
+    {
+      priv->text_size = MAX ((gsize) new_n_bytes + 1, priv->text_size * 2);
+      priv->text = g_realloc (priv->text, priv->text_size);
+
+      if (priv->n_bytes == 0)
+        priv->text[0] = '\0';
+    }
+
+  memmove (priv->text + start + length,
+           priv->text + start + n_delete,
+           priv->n_bytes - start - n_delete + 1);
+  memcpy (priv->text + start, text, length);
+
+  g_free (copy);
+
+  old_n_chars = priv->n_chars;
+
+  priv->n_bytes = new_n_bytes;
+  priv->n_chars = old_n_chars - n_deleted_chars + n_inserted_chars;
+
+  clutter_entry_update_mask (entry, old_n_chars);
+
+  priv->text_dirty = TRUE;
+  clutter_entry_clear_cursor_position (entry);
+
+  if (CLUTTER_ACTOR_IS_VISIBLE (entry))
+    clutter_actor_queue_redraw (CLUTTER_ACTOR (entry));
+
+  g_signal_emit (G_OBJECT (entry), entry_signals[TEXT_CHANGED], 0);
+
+  g_object_notify (G_OBJECT (entry), "text");
+
+  return n_inserted_chars;
 }
 
 void
@@ -419,40 +564,32 @@ clutter_entry_paint_cursor (ClutterEntry *entry)
     }
 }
 
-static void
-clutter_entry_paint (ClutterActor *self)
+/* the width available to the text */
+static gint
+clutter_entry_get_text_area_width (ClutterEntry *entry)
 {
-  ClutterEntry         *entry;
-  ClutterEntryPrivate  *priv;
-  PangoRectangle        logical;
-  gint                  width, actor_width;
-  gint                  text_width;
-  gint                  cursor_x;
-  ClutterColor          color = { 0, };
-
-  entry  = CLUTTER_ENTRY(self);
-  priv   = entry->priv;
-
-  if (priv->desc == NULL || priv->text == NULL)
-    {
-      CLUTTER_NOTE (ACTOR, "layout: %p , desc: %p, text %p",
-		    priv->layout,
-		    priv->desc,
-		    priv->text);
-      return;
-    }
+  ClutterEntryPrivate *priv = entry->priv;
+  gint width;
 
   if (priv->width < 0)
-    width = clutter_actor_get_width (self);
+    width = clutter_actor_get_width (CLUTTER_ACTOR (entry));
   else
     width = priv->width;
 
-  cogl_clip_set (0, 0, CLUTTER_INT_TO_FIXED (width),
-		 CLUTTER_INT_TO_FIXED (clutter_actor_get_height (self)));
+  return width - (2 * priv->entry_padding);
+}
 
-  actor_width = width - (2 * priv->entry_padding);
-  clutter_entry_ensure_layout (entry, actor_width);
-  clutter_entry_ensure_cursor_position (entry);
+/* scrolls the text so that the cursor is visible, and positions
+ * the cursor relative to the actor
+ */
+static void
+clutter_entry_update_scroll (ClutterEntry *entry,
+                             gint          actor_width)
+{
+  ClutterEntryPrivate  *priv = entry->priv;
+  PangoRectangle        logical;
+  gint                  text_width;
+  gint                  cursor_x;
 
   pango_layout_get_extents (priv->layout, NULL, &logical);
   text_width = logical.width / PANGO_SCALE;
@@ -496,6 +633,104 @@ clutter_entry_paint (ClutterActor *self)
       priv->text_x = (actor_width - text_width) * priv->x_align;
       priv->cursor_pos.x += priv->text_x + priv->entry_padding;
     }
+}
+
+/* queues a redraw after the cursor moved or was shown or hidden;
+ * if the text does not need to scroll, only the old and the new
+ * cursor rectangles are redrawn
+ */
+static void
+clutter_entry_queue_cursor_redraw (ClutterEntry *entry)
+{
+  ClutterEntryPrivate *priv = entry->priv;
+  ClutterGeometry old_cursor, area;
+  gint old_text_x;
+
+  if (!CLUTTER_ACTOR_IS_VISIBLE (entry))
+    return;
+
+  /* a subclass could paint a cursor of any size; if the layout is
+   * not up to date we would need to lay out the text here
+   */
+  if (CLUTTER_ENTRY_GET_CLASS (entry)->paint_cursor !=
+        clutter_entry_paint_cursor ||
+      priv->layout == NULL ||
+      priv->text_dirty ||
+      priv->text == NULL ||
+      priv->desc == NULL)
+    {
+      clutter_actor_queue_redraw (CLUTTER_ACTOR (entry));
+      return;
+    }
+
+  old_cursor = priv->painted_cursor;
+  old_text_x = priv->text_x;
+
+  clutter_entry_ensure_cursor_position (entry);
+  clutter_entry_update_scroll (entry,
+                               clutter_entry_get_text_area_width (entry));
+
+  if (priv->text_x != old_text_x)
+    {
+      clutter_actor_queue_redraw (CLUTTER_ACTOR (entry));
+      return;
+    }
+
+  if (priv->show_cursor)
+    {
+      area = priv->cursor_pos;
+
+      if (old_cursor.width > 0)
+        {
+          gint x_2 = MAX (area.x + (gint) area.width,
+                          old_cursor.x + (gint) old_cursor.width);
+          gint y_2 = MAX (area.y + (gint) area.height,
+                          old_cursor.y + (gint) old_cursor.height);
+
+          area.x = MIN (area.x, old_cursor.x);
+          area.y = MIN (area.y, old_cursor.y);
+          area.width = x_2 - area.x;
+          area.height = y_2 - area.y;
+        }
+    }
+  else
+    area = old_cursor;
+
+  clutter_actor_queue_redraw_area (CLUTTER_ACTOR (entry), &area);
+}
+
+static void
+clutter_entry_paint (ClutterActor *self)
+{
+  ClutterEntry         *entry;
+  ClutterEntryPrivate  *priv;
+  gint                  width, actor_width;
+  ClutterColor          color = { 0, };
+
+  entry  = CLUTTER_ENTRY(self);
+  priv   = entry->priv;
+
+  if (priv->desc == NULL || priv->text == NULL)
+    {
+      CLUTTER_NOTE (ACTOR, "layout: %p , desc: %p, text %p",
+		    priv->layout,
+		    priv->desc,
+		    priv->text);
+      return;
+    }
+
+  if (priv->width < 0)
+    width = clutter_actor_get_width (self);
+  else
+    width = priv->width;
+
+  cogl_clip_set (0, 0, CLUTTER_INT_TO_FIXED (width),
+		 CLUTTER_INT_TO_FIXED (clutter_actor_get_height (self)));
+
+  actor_width = clutter_entry_get_text_area_width (entry);
+  clutter_entry_ensure_layout (entry, actor_width);
+  clutter_entry_ensure_cursor_position (entry);
+  clutter_entry_update_scroll (entry, actor_width);
 
   memcpy (&color, &priv->fgcol, sizeof (ClutterColor));
   color.alpha = clutter_actor_get_paint_opacity (self);
@@ -504,6 +739,14 @@ clutter_entry_paint (ClutterActor *self)
                                priv->text_x + priv->entry_padding, 0,
                                &color, 0);
 
+  /* remember where the cursor was painted, to be able to
+   * damage just that area when it moves
+   */
+  if (priv->show_cursor)
+    priv->painted_cursor = priv->cursor_pos;
+  else
+    priv->painted_cursor.width = 0;
+
   if (CLUTTER_ENTRY_GET_CLASS (entry)->paint_cursor)
     CLUTTER_ENTRY_GET_CLASS (entry)->paint_cursor (entry);
 
@@ -523,8 +766,13 @@ clutter_entry_allocate (ClutterActor          *self,
 
   if (priv->width != width)
     {
-      clutter_entry_clear_layout (entry);
-      clutter_entry_ensure_layout (entry, width);
+      /* the width only matters to a wrapping layout */
+      if (priv->layout && priv->wrap)
+        {
+          pango_layout_set_width (priv->layout,
+                                  width > 0 ? width * PANGO_SCALE : -1);
+          clutter_entry_clear_cursor_position (entry);
+        }
 
       priv->width = width;
     }
@@ -539,12 +787,9 @@ clutter_entry_handle_key_event_internal (ClutterEntry    *entry,
   gunichar key_unichar;
   ClutterEntryPrivate *priv = entry->priv;
   gint pos = priv->position;
-  gint len = 0;
+  gint len = priv->n_chars;
   gint keyval = clutter_key_event_symbol (event);
 
-  if (priv->text)
-    len = g_utf8_strlen (priv->text, -1);
-
   switch (keyval)
     {
       case CLUTTER_Return:
@@ -652,6 +897,9 @@ clutter_entry_finalize (GObject *object)
   if (priv->desc)
     pango_font_description_free (priv->desc);
 
+  if (priv->mask)
+    g_string_free (priv->mask, TRUE);
+
   g_free (priv->text);
   g_free (priv->font_name);
 
@@ -907,6 +1155,7 @@ clutter_entry_init (ClutterEntry *self)
   priv->attrs         = NULL;
   priv->position      = -1;
   priv->priv_char     = '*';
+  priv->mask_char_len = 1;
   priv->text_visible  = TRUE;
   priv->text_x        = 0;
   priv->max_length    = 0;
@@ -1041,50 +1290,8 @@ clutter_entry_set_text (ClutterEntry *entry,
 
   g_object_ref (entry);
 
-  if (priv->max_length > 0)
-    {
-      gint len = g_utf8_strlen (text, -1);
-
-      if (len < priv->max_length)
-        {
-           g_free (priv->text);
-
-           priv->text = g_strdup (text);
-           priv->n_bytes = strlen (text);
-           priv->n_chars = len;
-        }
-      else
-        {
-          gchar * n = g_malloc0 (priv->max_length + 1);
-
-          g_utf8_strncpy (n, text, priv->max_length);
-          g_free (priv->text);
+  clutter_entry_replace_text (entry, 0, priv->n_bytes, text, strlen (text));
 
-          priv->text = n;
-          priv->n_bytes = strlen (n);
-          priv->n_chars = priv->max_length;
-        }
-    }
-  else
-    {
-      g_free (priv->text);
-
-      priv->text = g_strdup (text);
-      priv->n_bytes = strlen (text);
-      priv->n_chars = g_utf8_strlen (priv->text, -1);
-    }
-
-  clutter_entry_clear_layout (entry);
-  clutter_entry_clear_cursor_position (entry);
-  /* Recreate the layout so the glyph cache will be primed */
-  clutter_entry_ensure_layout (entry, -1);
-
-  if (CLUTTER_ACTOR_IS_VISIBLE (entry))
-    clutter_actor_queue_redraw (CLUTTER_ACTOR (entry));
-
-  g_signal_emit (G_OBJECT (entry), entry_signals[TEXT_CHANGED], 0);
-
-  g_object_notify (G_OBJECT (entry), "text");
   g_object_unref (entry);
 }
 
@@ -1341,7 +1548,7 @@ clutter_entry_set_cursor_position (ClutterEntry *entry,
   if (priv->text == NULL)
     return;
 
-  len = g_utf8_strlen (priv->text, -1);
+  len = priv->n_chars;
 
   if (position < 0 || position >= len)
     priv->position = -1;
@@ -1349,9 +1556,7 @@ clutter_entry_set_cursor_position (ClutterEntry *entry,
     priv->position = position;
 
   clutter_entry_clear_cursor_position (entry);
-
-  if (CLUTTER_ACTOR_IS_VISIBLE (entry))
-    clutter_actor_queue_redraw (CLUTTER_ACTOR (entry));
+  clutter_entry_queue_cursor_redraw (entry);
 }
 
 /**
@@ -1416,8 +1621,8 @@ clutter_entry_insert_unichar (ClutterEntry *entry,
                               gunichar      wc)
 {
   ClutterEntryPrivate *priv;
-  GString *new = NULL;
-  glong pos;
+  gchar buf[7];
+  gint len, pos;
 
   g_return_if_fail (CLUTTER_IS_ENTRY (entry));
   g_return_if_fail (g_unichar_validate (wc));
@@ -1429,18 +1634,17 @@ clutter_entry_insert_unichar (ClutterEntry *entry,
 
   g_object_ref (entry);
 
-  new = g_string_new (priv->text);
-  pos = offset_to_bytes (priv->text, priv->position);
-  new = g_string_insert_unichar (new, pos, wc);
+  len = g_unichar_to_utf8 (wc, buf);
 
-  clutter_entry_set_text (entry, new->str);
+  if (priv->position < 0)
+    pos = priv->n_bytes;
+  else
+    pos = offset_to_bytes (priv->text, priv->position);
 
-  if (priv->position >= 0)
+  if (clutter_entry_replace_text (entry, pos, 0, buf, len) > 0 &&
+      priv->position >= 0)
     clutter_entry_set_cursor_position (entry, priv->position + 1);
 
-  g_string_free (new, TRUE);
-
-  g_object_notify (G_OBJECT (entry), "text");
   g_object_unref (entry);
 }
 
@@ -1458,8 +1662,6 @@ clutter_entry_delete_chars (ClutterEntry *entry,
                             guint         num)
 {
   ClutterEntryPrivate *priv;
-  GString *new = NULL;
-  gint len;
   gint pos;
   gint num_pos;
 
@@ -1472,28 +1674,23 @@ clutter_entry_delete_chars (ClutterEntry *entry,
 
   g_object_ref (entry);
 
-  len = g_utf8_strlen (priv->text, -1);
-  new = g_string_new (priv->text);
-
   if (priv->position == -1)
-   {
-     num_pos = offset_to_bytes (priv->text, len - num);
-     new = g_string_erase (new, num_pos, -1);
-   }
+    {
+      pos = offset_to_bytes (priv->text, MAX (priv->n_chars - (gint) num, 0));
+      num_pos = priv->n_bytes;
+    }
   else
-  {
-    pos = offset_to_bytes (priv->text, priv->position - num);
-    num_pos = offset_to_bytes (priv->text, priv->position);
-    new = g_string_erase (new, pos, num_pos-pos);
-  }
-  clutter_entry_set_text (entry, new->str);
+    {
+      pos = offset_to_bytes (priv->text, MAX (priv->position - (gint) num, 0));
+      num_pos = offset_to_bytes (priv->text, priv->position);
+    }
 
-  if (priv->position > 0)
-    clutter_entry_set_cursor_position (entry, priv->position - num);
+  clutter_entry_replace_text (entry, pos, num_pos - pos, "", 0);
 
-  g_string_free (new, TRUE);
+  if (priv->position > 0)
+    clutter_entry_set_cursor_position (entry,
+                                       MAX (priv->position - (gint) num, 0));
 
-  g_object_notify (G_OBJECT (entry), "text");
   g_object_unref (entry);
 }
 
@@ -1517,18 +1714,19 @@ clutter_entry_insert_text (ClutterEntry *entry,
                            gssize        position)
 {
   ClutterEntryPrivate *priv;
-  GString *new = NULL;
+  gint pos;
 
   g_return_if_fail (CLUTTER_IS_ENTRY (entry));
+  g_return_if_fail (text != NULL);
 
   priv = entry->priv;
 
-  new = g_string_new (priv->text);
-  new = g_string_insert (new, position, text);
-
-  clutter_entry_set_text (entry, new->str);
+  if (position < 0)
+    pos = priv->n_bytes;
+  else
+    pos = offset_to_bytes (priv->text, position);
 
-  g_string_free (new, TRUE);
+  clutter_entry_replace_text (entry, pos, 0, text, strlen (text));
 }
 
 /**
@@ -1550,7 +1748,6 @@ clutter_entry_delete_text (ClutterEntry       *entry,
                            gssize              end_pos)
 {
   ClutterEntryPrivate *priv;
-  GString *new = NULL;
   gint start_bytes;
   gint end_bytes;
 
@@ -1561,15 +1758,18 @@ clutter_entry_delete_text (ClutterEntry       *entry,
   if (!priv->text)
     return;
 
-  start_bytes = offset_to_bytes (priv->text, start_pos);
-  end_bytes = offset_to_bytes (priv->text, end_pos);
+  start_bytes = offset_to_bytes (priv->text, MAX (start_pos, 0));
 
-  new = g_string_new (priv->text);
-  new = g_string_erase (new, start_bytes, end_bytes - start_bytes);
+  if (end_pos < 0)
+    end_bytes = priv->n_bytes;
+  else
+    end_bytes = offset_to_bytes (priv->text, end_pos);
 
-  clutter_entry_set_text (entry, new->str);
+  if (end_bytes <= start_bytes)
+    return;
 
-  g_string_free (new, TRUE);
+  clutter_entry_replace_text (entry, start_bytes, end_bytes - start_bytes,
+                              "", 0);
 }
 
 /**
@@ -1597,8 +1797,7 @@ clutter_entry_set_visible_cursor (ClutterEntry *entry,
 
       g_object_notify (G_OBJECT (entry), "cursor-visible");
 
-      if (CLUTTER_ACTOR_IS_VISIBLE (entry))
-        clutter_actor_queue_redraw (CLUTTER_ACTOR (entry));
+      clutter_entry_queue_cursor_redraw (entry);
     }
 }
 
@@ -1643,9 +1842,16 @@ clutter_entry_set_visibility (ClutterEntry *entry, gboolean visible)
 
   priv = entry->priv;
 
+  visible = visible != FALSE;
+
+  if (priv->text_visible == visible)
+    return;
+
   priv->text_visible = visible;
 
-  clutter_entry_clear_layout (entry);
+  clutter_entry_ensure_mask (entry);
+
+  priv->text_dirty = TRUE;
   clutter_entry_clear_cursor_position (entry);
 
   if (CLUTTER_ACTOR_IS_VISIBLE (entry))
@@ -1695,10 +1901,12 @@ clutter_entry_set_invisible_char (ClutterEntry *entry, gunichar wc)
 
   priv->priv_char = wc;
 
-  if (!priv->text_visible)
+  if (priv->text_visible)
     return;
 
-  clutter_entry_clear_layout (entry);
+  clutter_entry_ensure_mask (entry);
+
+  priv->text_dirty = TRUE;
   clutter_entry_clear_cursor_position (entry);
 
   if (CLUTTER_ACTOR_IS_VISIBLE (entry))
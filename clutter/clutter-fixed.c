@@ -32,6 +32,10 @@
 #include <glib-object.h>
 #include <gobject/gvaluecollector.h>
 
+#ifdef CLUTTER_FLOAT_MATH
+#include <math.h>
+#endif
+
 #include "clutter-fixed.h"
 #include "clutter-private.h"
 
@@ -48,6 +52,12 @@
  * It is no recommened for use on platforms with a floating point unit
  * (eg desktop systems) nor for use in bindings.
  *
+ * When Clutter is configured with --enable-float-math the functions
+ * that approximate with lookup tables, such as clutter_sinx() or
+ * clutter_sqrtx(), use the C library instead, and the actor transformations
+ * and projections are computed in floating point. The fixed point API is
+ * kept for compatibility.
+ *
  * Basic rules of Fixed Point arithmethic:
  *
  * <itemizedlist>
@@ -255,6 +265,9 @@ clutter_double_to_uint (double val)
 ClutterFixed
 clutter_sinx (ClutterFixed angle)
 {
+#ifdef CLUTTER_FLOAT_MATH
+    return CLUTTER_FLOAT_TO_FIXED (sin (CLUTTER_FIXED_TO_DOUBLE (angle)));
+#else
     int sign = 1, indx1, indx2;
     ClutterFixed low, high, d1, d2;
 
@@ -322,6 +335,7 @@ clutter_sinx (ClutterFixed angle)
 	angle = (1 + ~angle);
 
     return angle;
+#endif
 }
 
 /**
@@ -555,6 +569,9 @@ static guint16 atan_tbl[] =
 ClutterFixed
 clutter_atani (ClutterFixed x)
 {
+#ifdef CLUTTER_FLOAT_MATH
+  return CLUTTER_FLOAT_TO_FIXED (atan (CLUTTER_FIXED_TO_DOUBLE (x)));
+#else
   gboolean negative = FALSE;
   ClutterFixed angle;
 
@@ -571,6 +588,7 @@ clutter_atani (ClutterFixed x)
     angle = atan_tbl[x >> 8];
 
   return negative ? -angle : angle;
+#endif
 }
 
 /**
@@ -586,6 +604,10 @@ clutter_atani (ClutterFixed x)
 ClutterFixed
 clutter_atan2i (ClutterFixed y, ClutterFixed x)
 {
+#ifdef CLUTTER_FLOAT_MATH
+  return CLUTTER_FLOAT_TO_FIXED (atan2 (CLUTTER_FIXED_TO_DOUBLE (y),
+                                        CLUTTER_FIXED_TO_DOUBLE (x)));
+#else
   ClutterFixed angle;
 
   if (x == 0)
@@ -599,6 +621,7 @@ clutter_atan2i (ClutterFixed y, ClutterFixed x)
     }
 
   return angle;
+#endif
 }
 
 ClutterFixed sqrt_tbl [] =
@@ -699,6 +722,12 @@ clutter_sqrtx (ClutterFixed x)
      * producing errors < 1%.
      *
      */
+#ifdef CLUTTER_FLOAT_MATH
+    if (x <= 0)
+	return 0;
+
+    return CLUTTER_FLOAT_TO_FIXED (sqrt (CLUTTER_FIXED_TO_DOUBLE (x)));
+#else
     int t = 0;
     int sh = 0;    
     unsigned fract = x & 0x0000ffff;
@@ -785,6 +814,7 @@ clutter_sqrtx (ClutterFixed x)
 	x = (x >> (1 + ~sh));
 
     return x;
+#endif
 }
 
 /**
@@ -43,6 +43,7 @@
 #include <stdarg.h>
 
 #include "clutter-group.h"
+#include "clutter-clone-texture.h"
 
 #include "clutter-container.h"
 #include "clutter-main.h"
@@ -91,18 +92,39 @@ clutter_group_paint (ClutterActor *actor)
                 clutter_actor_get_name (actor) ? clutter_actor_get_name (actor)
                                               : "unknown");
 
-  for (child_item = priv->children;
-       child_item != NULL;
-       child_item = child_item->next)
+  /* project the children with visibility detection all at once */
+  _clutter_actor_begin_cull_children (actor, priv->children);
+
+  child_item = priv->children;
+
+  while (child_item != NULL)
     {
       ClutterActor *child = child_item->data;
+      GList        *next;
 
       g_assert (child != NULL);
 
+      /* clones of the same texture next to each other are drawn
+       * together */
+      if (CLUTTER_IS_CLONE_TEXTURE (child))
+        {
+          next = _clutter_clone_texture_paint_run (child_item);
+
+          if (next != child_item)
+            {
+              child_item = next;
+              continue;
+            }
+        }
+
       if (CLUTTER_ACTOR_IS_VISIBLE (child))
 	clutter_actor_paint (child);
+
+      child_item = child_item->next;
     }
 
+  _clutter_actor_end_cull_children (actor);
+
   CLUTTER_NOTE (PAINT, "ClutterGroup paint leave '%s'",
                 clutter_actor_get_name (actor) ? clutter_actor_get_name (actor)
                                               : "unknown");
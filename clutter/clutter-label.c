@@ -753,6 +753,18 @@ clutter_label_set_text (ClutterLabel *label,
 
   clutter_label_dirty_cache (label);
 
+  /* When the glyphs can be rasterised in the background, start on
+   * them now so that they are ready by the time the label is painted;
+   * the layouts used for painting are still made by the relayout */
+  if (g_thread_supported ())
+    {
+      PangoLayout *layout;
+
+      layout = clutter_label_create_layout_no_cache (label, -1);
+      pango_clutter_queue_glyphs_for_layout (layout);
+      g_object_unref (layout);
+    }
+
   clutter_actor_queue_relayout (CLUTTER_ACTOR (label));
 
   g_object_notify (G_OBJECT (label), "text");
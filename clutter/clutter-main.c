@@ -181,6 +181,8 @@ _clutter_stage_maybe_setup_viewport (ClutterStage *stage)
 			   perspective.z_far);
 
       CLUTTER_UNSET_PRIVATE_FLAGS (stage, CLUTTER_ACTOR_SYNC_MATRICES);
+
+      _clutter_actor_transforms_changed ();
     }
 }
 
@@ -2612,6 +2614,92 @@ clutter_set_motion_events_frequency (guint frequency)
   context->motion_frequency = CLAMP (frequency, 1, clutter_default_fps);
 }
 
+/**
+ * clutter_is_idle:
+ *
+ * Checks whether Clutter has any work scheduled: a running
+ * #ClutterTimeline, a queued redraw on any stage or an event waiting
+ * to be dispatched. When this function returns %TRUE none of the
+ * Clutter sources will wake up the main loop until something happens
+ * in the application or in the windowing system, so it is safe for
+ * the device to enter a low power state.
+ *
+ * Return value: %TRUE if Clutter has nothing left to do
+ *
+ * Since: 0.8.2-maemo
+ */
+gboolean
+clutter_is_idle (void)
+{
+  ClutterMainContext *context = clutter_context_get_default ();
+  GSList *l;
+
+  if (_clutter_timeline_get_n_active () > 0)
+    return FALSE;
+
+  if (context->stage_manager != NULL)
+    {
+      for (l = context->stage_manager->stages; l != NULL; l = l->next)
+        if (_clutter_stage_has_queued_redraw (l->data))
+          return FALSE;
+    }
+
+  return !clutter_events_pending ();
+}
+
+void
+_clutter_record_wakeup (ClutterWakeupSource source)
+{
+  ClutterMainContext *context = clutter_context_get_default ();
+
+  g_assert (source <= CLUTTER_WAKEUP_MOTION);
+
+  context->wakeup_counts[source] += 1;
+
+  CLUTTER_NOTE (SCHEDULER, "Wakeup from source %d (%u so far)",
+                source,
+                context->wakeup_counts[source]);
+}
+
+/**
+ * clutter_get_wakeup_count:
+ * @source: a #ClutterWakeupSource
+ *
+ * Retrieves how many times @source has woken up the main loop since
+ * Clutter was initialised, or since the last call to
+ * clutter_reset_wakeup_counts(). An application that is supposed to be
+ * idle can use this function to find out which part of Clutter is
+ * still keeping the CPU busy.
+ *
+ * Return value: the number of wakeups caused by @source
+ *
+ * Since: 0.8.2-maemo
+ */
+guint
+clutter_get_wakeup_count (ClutterWakeupSource source)
+{
+  ClutterMainContext *context = clutter_context_get_default ();
+
+  g_return_val_if_fail (source <= CLUTTER_WAKEUP_MOTION, 0);
+
+  return context->wakeup_counts[source];
+}
+
+/**
+ * clutter_reset_wakeup_counts:
+ *
+ * Resets the counters returned by clutter_get_wakeup_count() to zero.
+ *
+ * Since: 0.8.2-maemo
+ */
+void
+clutter_reset_wakeup_counts (void)
+{
+  ClutterMainContext *context = clutter_context_get_default ();
+
+  memset (context->wakeup_counts, 0, sizeof (context->wakeup_counts));
+}
+
 /**
  * clutter_clear_glyph_cache:
  *
@@ -2637,6 +2725,9 @@ clutter_clear_glyph_cache (void)
  * mipmapped textures or not. Using mipmapped textures will improve
  * the quality for scaled down text but will use more texture memory.
  *
+ * Mipmapped and plain text share the same glyph textures; each of them
+ * only gets mipmaps once text from it is drawn scaled down.
+ *
  * Since: 0.8
  */
 void
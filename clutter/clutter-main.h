@@ -87,6 +87,27 @@ GQuark clutter_init_error_quark (void);
  */
 #define CLUTTER_REDRAW_DAMAGE_INTERVAL         (0)
 
+/**
+ * ClutterWakeupSource:
+ * @CLUTTER_WAKEUP_TIMELINE: a frame of a #ClutterTimeline, or the end
+ *   of the delay of a timeline
+ * @CLUTTER_WAKEUP_REDRAW: a queued redraw of a stage
+ * @CLUTTER_WAKEUP_EVENT: an event from the windowing system, other
+ *   than a motion event
+ * @CLUTTER_WAKEUP_MOTION: a motion event from the windowing system
+ *
+ * The Clutter sources that can wake up the main loop; see
+ * clutter_get_wakeup_count().
+ *
+ * Since: 0.8.2-maemo
+ */
+typedef enum {
+  CLUTTER_WAKEUP_TIMELINE,
+  CLUTTER_WAKEUP_REDRAW,
+  CLUTTER_WAKEUP_EVENT,
+  CLUTTER_WAKEUP_MOTION
+} ClutterWakeupSource;
+
 /* Initialisation */
 void             clutter_base_init        (void);
 ClutterInitError clutter_init             (int          *argc,
@@ -153,6 +174,10 @@ guint            clutter_get_motion_events_frequency (void);
 void             clutter_set_default_frame_rate      (guint    frames_per_sec);
 guint            clutter_get_default_frame_rate      (void);
 
+gboolean         clutter_is_idle                     (void);
+guint            clutter_get_wakeup_count            (ClutterWakeupSource source);
+void             clutter_reset_wakeup_counts         (void);
+
 void             clutter_grab_pointer                (ClutterActor *actor);
 void             clutter_grab_pointer_without_pick   (ClutterActor *actor);
 void             clutter_ungrab_pointer              (void);
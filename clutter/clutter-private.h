@@ -42,9 +42,11 @@
 #include "clutter-event.h"
 #include "clutter-feature.h"
 #include "clutter-id-pool.h"
+#include "clutter-main.h"
 #include "clutter-stage-manager.h"
 #include "clutter-stage-window.h"
 #include "clutter-stage.h"
+#include "clutter-texture.h"
 #include "pango/pangoclutter.h"
 
 G_BEGIN_DECLS
@@ -135,12 +137,24 @@ struct _ClutterMainContext
   gboolean             software_selection; /* Whether to perform old clutter
                                 selection using rendering + readback (FALSE)
                                 or selection purely in software (TRUE) */
+
+  guint                wakeup_counts[CLUTTER_WAKEUP_MOTION + 1];
+
+  guint                occlusion_serial; /* identifies the stage paint whose
+                                            occluded actors are skipped, or
+                                            0 outside of it */
+
+  guint                transform_stamp;  /* bumped whenever the on-stage
+                                            position of actors may have
+                                            changed */
 };
 
 #define CLUTTER_CONTEXT()	(clutter_context_get_default ())
 ClutterMainContext *clutter_context_get_default (void);
 PangoContext *_clutter_context_create_pango_context (ClutterMainContext *self);
 
+void          _clutter_record_wakeup (ClutterWakeupSource source);
+
 #define CLUTTER_PRIVATE_FLAGS(a)	 (((ClutterActor *) (a))->private_flags)
 #define CLUTTER_SET_PRIVATE_FLAGS(a,f)	 (CLUTTER_PRIVATE_FLAGS (a) |= (f))
 #define CLUTTER_UNSET_PRIVATE_FLAGS(a,f) (CLUTTER_PRIVATE_FLAGS (a) &= ~(f))
@@ -166,6 +180,7 @@ void _clutter_stage_manager_add_stage    (ClutterStageManager *stage_manager,
                                           ClutterStage        *stage);
 void _clutter_stage_manager_remove_stage (ClutterStageManager *stage_manager,
                                           ClutterStage        *stage);
+void _clutter_stage_manager_redraw       (ClutterStageManager *stage_manager);
 
 /* stage */
 
@@ -175,6 +190,11 @@ ClutterStageWindow *_clutter_stage_get_window           (ClutterStage       *sta
 ClutterStageWindow *_clutter_stage_get_default_window   (void);
 void                _clutter_stage_maybe_setup_viewport (ClutterStage       *stage);
 void                _clutter_stage_maybe_relayout       (ClutterActor       *stage);
+gboolean            _clutter_stage_has_queued_redraw    (ClutterStage       *stage);
+gboolean            _clutter_stage_take_queued_redraw   (ClutterStage       *stage);
+
+/* timeline */
+guint               _clutter_timeline_get_n_active      (void);
 
 /* vfuncs implemented by backend */
 GType         _clutter_backend_impl_get_type  (void);
@@ -198,6 +218,10 @@ void          _clutter_backend_init_events    (ClutterBackend  *backend);
 int           _clutter_backend_buffer_age     (ClutterBackend *backend,
                                                ClutterStage   *stage);
 
+void          _clutter_backend_begin_redraw_pass (ClutterBackend *backend);
+void          _clutter_backend_end_redraw_pass   (ClutterBackend *backend);
+gboolean      _clutter_backend_in_redraw_pass    (ClutterBackend *backend);
+
 ClutterFeatureFlags _clutter_backend_get_features (ClutterBackend *backend);
 
 void          _clutter_feature_init (void);
@@ -225,6 +249,29 @@ gboolean _clutter_boolean_handled_accumulator (GSignalInvocationHint *ihint,
 void _clutter_actor_apply_modelview_transform_recursive (ClutterActor *self,
 						       ClutterActor *ancestor);
 
+gboolean _clutter_actor_get_paint_box (ClutterActor    *self,
+                                       ClutterActorBox *box,
+                                       guint8          *paint_opacity);
+
+GList *_clutter_clone_texture_paint_run (GList *children);
+
+void          _clutter_texture_add_clone       (ClutterTexture *texture,
+                                                ClutterActor   *clone);
+void          _clutter_texture_remove_clone    (ClutterTexture *texture,
+                                                ClutterActor   *clone);
+const GSList *_clutter_texture_get_clones      (ClutterTexture *texture);
+void          _clutter_texture_update_contents (ClutterTexture *texture);
+
+void _clutter_actor_transforms_changed (void);
+
+void _clutter_actor_begin_cull_children (ClutterActor *parent,
+                                         GList        *children);
+void _clutter_actor_end_cull_children   (ClutterActor *parent);
+
+guint _clutter_actor_cull_occluded (ClutterActor          *stage,
+                                    const ClutterGeometry *area,
+                                    guint                  serial);
+
 int _clutter_stage_get_shaped_mode (ClutterActor *self);
 
 // Big hack to remove threading calls
@@ -97,45 +97,60 @@ clutter_rectangle_paint (ClutterActor *self)
    */
   if (priv->has_border)
     {
-      tmp_col.red   = priv->border_color.red;
-      tmp_col.green = priv->border_color.green;
-      tmp_col.blue  = priv->border_color.blue;
-      tmp_col.alpha = clutter_actor_get_paint_opacity (self)
-                      * priv->border_color.alpha
-                      / 255;
-
-      cogl_color (&tmp_col);
-
-      /* this sucks, but it's the only way to make a border */
-      cogl_rectangle (priv->border_width, 0,
-                      geom.width - priv->border_width,
-                      priv->border_width);
-
-      cogl_rectangle (geom.width - priv->border_width,
-                      priv->border_width,
-                      priv->border_width,
-                      geom.height - priv->border_width);
-
-      cogl_rectangle (0, geom.height - priv->border_width,
-                      geom.width - priv->border_width,
-                      priv->border_width);
-
-      cogl_rectangle (0, 0,
-                      priv->border_width,
-                      geom.height - priv->border_width);
-
-      tmp_col.red   = priv->color.red;
-      tmp_col.green = priv->color.green;
-      tmp_col.blue  = priv->color.blue;
-      tmp_col.alpha = clutter_actor_get_paint_opacity (self)
-                      * priv->color.alpha
-                      / 255;
-
-      cogl_color (&tmp_col);
-
-      cogl_rectangle (priv->border_width, priv->border_width,
-                      geom.width - priv->border_width * 2,
-                      geom.height - priv->border_width * 2);
+      CoglColoredRectangle rects[5];
+      ClutterFixed         border = CLUTTER_INT_TO_FIXED (priv->border_width);
+      ClutterFixed         width = CLUTTER_INT_TO_FIXED (geom.width);
+      ClutterFixed         height = CLUTTER_INT_TO_FIXED (geom.height);
+      guint8               paint_opacity;
+      gint                 i, n_rects;
+
+      paint_opacity = clutter_actor_get_paint_opacity (self);
+
+      /* the four sides of the border, then the inside, all in one go */
+      rects[0].x = border;
+      rects[0].y = 0;
+      rects[0].width = width - border;
+      rects[0].height = border;
+
+      rects[1].x = width - border;
+      rects[1].y = border;
+      rects[1].width = border;
+      rects[1].height = height - border;
+
+      rects[2].x = 0;
+      rects[2].y = height - border;
+      rects[2].width = width - border;
+      rects[2].height = border;
+
+      rects[3].x = 0;
+      rects[3].y = 0;
+      rects[3].width = border;
+      rects[3].height = height - border;
+
+      for (i = 0; i < 4; i++)
+        {
+          rects[i].color = priv->border_color;
+          rects[i].color.alpha = paint_opacity
+                                 * priv->border_color.alpha
+                                 / 255;
+        }
+
+      n_rects = 4;
+
+      if (width > border * 2 && height > border * 2)
+        {
+          rects[4].x = border;
+          rects[4].y = border;
+          rects[4].width = width - border * 2;
+          rects[4].height = height - border * 2;
+          rects[4].color = priv->color;
+          rects[4].color.alpha = paint_opacity
+                                 * priv->color.alpha
+                                 / 255;
+          n_rects += 1;
+        }
+
+      cogl_rectangles_with_color (rects, n_rects);
     }
   else
     {
@@ -152,6 +167,42 @@ clutter_rectangle_paint (ClutterActor *self)
     }
 }
 
+static gboolean
+clutter_rectangle_get_opaque_area (ClutterActor    *self,
+                                   ClutterActorBox *box)
+{
+  ClutterRectanglePrivate *priv = CLUTTER_RECTANGLE (self)->priv;
+  ClutterActorClass       *klass = CLUTTER_ACTOR_GET_CLASS (self);
+  ClutterGeometry          geom;
+  gint                     inset = 0;
+
+  /* a subclass painting something else only covers the same area if
+   * it says so, by overriding this function as well
+   */
+  if (klass->paint != clutter_rectangle_paint &&
+      klass->get_opaque_area == clutter_rectangle_get_opaque_area)
+    return FALSE;
+
+  if (priv->color.alpha != 0xff)
+    return FALSE;
+
+  clutter_actor_get_allocation_geometry (self, &geom);
+
+  /* a translucent border leaves only the inside opaque */
+  if (priv->has_border && priv->border_color.alpha != 0xff)
+    inset = priv->border_width;
+
+  if ((gint) geom.width <= inset * 2 || (gint) geom.height <= inset * 2)
+    return FALSE;
+
+  box->x1 = CLUTTER_UNITS_FROM_INT (inset);
+  box->y1 = CLUTTER_UNITS_FROM_INT (inset);
+  box->x2 = CLUTTER_UNITS_FROM_INT (geom.width - inset);
+  box->y2 = CLUTTER_UNITS_FROM_INT (geom.height - inset);
+
+  return TRUE;
+}
+
 static void
 clutter_rectangle_set_property (GObject      *object,
 				guint         prop_id,
@@ -234,6 +285,7 @@ clutter_rectangle_class_init (ClutterRectangleClass *klass)
   ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
 
   actor_class->paint        = clutter_rectangle_paint;
+  actor_class->get_opaque_area = clutter_rectangle_get_opaque_area;
 
   gobject_class->finalize     = clutter_rectangle_finalize;
   gobject_class->dispose      = clutter_rectangle_dispose;
@@ -98,8 +98,11 @@ struct _ClutterScoreEntry
 
   /* the optional marker on the parent */
   gchar *marker;
+  GQuark marker_quark;
 
-  /* signal handlers id */
+  /* signal handlers id; the marker-reached handler is connected
+   * to our own timeline and starts the children attached to markers
+   */
   gulong complete_id;
   gulong marker_id;
 
@@ -107,6 +110,13 @@ struct _ClutterScoreEntry
 
   /* pointer back to the tree structure */
   GNode *node;
+
+  /* the children of node, split by what starts them: the children
+   * to start on completion, and a GQuark -> GQueue map of the children
+   * to start when a marker is reached
+   */
+  GQueue      on_completed;
+  GHashTable *on_marker;
 };
 
 #define CLUTTER_SCORE_GET_PRIVATE(obj)  (clutter_score_get_instance_private (CLUTTER_SCORE (obj)))
@@ -115,6 +125,14 @@ struct _ClutterScorePrivate
 {
   GNode      *root;
 
+  /* ClutterTimeline -> GSList of GNode, in append order; a timeline
+   * can be appended more than once
+   */
+  GHashTable *entries_by_timeline;
+
+  /* entry id -> GNode */
+  GHashTable *entries_by_id;
+
   GHashTable *running_timelines;
 
   gulong      last_id;
@@ -195,10 +213,14 @@ static void
 clutter_score_finalize (GObject *object)
 {
   ClutterScore *score = CLUTTER_SCORE (object);
+  ClutterScorePrivate *priv = score->priv;
 
   clutter_score_stop (score);
   clutter_score_clear (score);
 
+  g_hash_table_destroy (priv->entries_by_timeline);
+  g_hash_table_destroy (priv->entries_by_id);
+
   G_OBJECT_CLASS (clutter_score_parent_class)->finalize (object);
 }
 
@@ -325,6 +347,12 @@ clutter_score_init (ClutterScore *self)
   /* sentinel */
   priv->root = g_node_new (NULL);
 
+  priv->entries_by_timeline =
+    g_hash_table_new_full (NULL, NULL,
+                           NULL,
+                           (GDestroyNotify) g_slist_free);
+  priv->entries_by_id = g_hash_table_new (NULL, NULL);
+
   priv->running_timelines = NULL;
 
   priv->is_paused = FALSE;
@@ -414,6 +442,63 @@ clutter_score_is_playing (ClutterScore *score)
     && g_hash_table_size (score->priv->running_timelines) != 0;
 }
 
+static void
+free_marker_queue (gpointer data)
+{
+  g_queue_free (data);
+}
+
+/* unlink_entry:
+ * @entry: a #ClutterScoreEntry
+ *
+ * Removes @entry from the indices of the score and from the children
+ * lists of its parent entry.
+ */
+static void
+unlink_entry (ClutterScoreEntry *entry)
+{
+  ClutterScorePrivate *priv = entry->score->priv;
+  ClutterScoreEntry *parent_entry;
+  GSList *nodes;
+
+  g_hash_table_remove (priv->entries_by_id, GUINT_TO_POINTER (entry->id));
+
+  if (priv->running_timelines)
+    g_hash_table_remove (priv->running_timelines,
+                         GUINT_TO_POINTER (entry->id));
+
+  /* the list might lose its head, so take it out of the table
+   * before modifying it
+   */
+  nodes = g_hash_table_lookup (priv->entries_by_timeline, entry->timeline);
+  g_hash_table_steal (priv->entries_by_timeline, entry->timeline);
+
+  nodes = g_slist_remove (nodes, entry->node);
+  if (nodes)
+    g_hash_table_insert (priv->entries_by_timeline, entry->timeline, nodes);
+
+  parent_entry = entry->node->parent ? entry->node->parent->data : NULL;
+  if (parent_entry == NULL)
+    return;
+
+  if (entry->marker)
+    {
+      GQueue *queue;
+
+      queue = g_hash_table_lookup (parent_entry->on_marker,
+                                   GUINT_TO_POINTER (entry->marker_quark));
+      if (queue)
+        {
+          g_queue_remove (queue, entry);
+          if (g_queue_is_empty (queue))
+            g_hash_table_remove (parent_entry->on_marker,
+                                 GUINT_TO_POINTER (entry->marker_quark));
+        }
+    }
+  else
+    g_queue_remove (&parent_entry->on_completed, entry);
+}
+
 /* destroy_entry:
  * @node: a #GNode
  *
@@ -429,7 +514,7 @@ destroy_entry (GNode                  *node,
     {
       if (entry->marker_id)
         {
-          g_signal_handler_disconnect (entry->parent, entry->marker_id);
+          g_signal_handler_disconnect (entry->timeline, entry->marker_id);
           entry->marker_id = 0;
         }
 
@@ -439,6 +524,10 @@ destroy_entry (GNode                  *node,
           entry->complete_id = 0;
         }
 
+      g_queue_clear (&entry->on_completed);
+      if (entry->on_marker)
+        g_hash_table_destroy (entry->on_marker);
+
       g_object_unref (entry->timeline);
       g_free (entry->marker);
       g_slice_free (ClutterScoreEntry, entry);
@@ -450,157 +539,72 @@ destroy_entry (GNode                  *node,
   return FALSE;
 }
 
-typedef enum {
-  FIND_BY_TIMELINE,
-  FIND_BY_ID,
-  REMOVE_BY_ID,
-  LIST_TIMELINES
-} TraverseAction;
-
-typedef struct {
-  TraverseAction action;
-
-  ClutterScore *score;
-
-  /* parameters */
-  union {
-    ClutterTimeline *timeline;
-    gulong id;
-    ClutterScoreEntry *entry;
-  } d;
+/* unlink_subtree:
+ * @node: a #GNode
+ *
+ * Removes every entry below @node from the indices of the score.
+ */
+static gboolean
+unlink_subtree (GNode                  *node,
+                G_GNUC_UNUSED gpointer  data)
+{
+  if (G_LIKELY (node->data != NULL))
+    unlink_entry (node->data);
 
-  gpointer result;
-} TraverseClosure;
+  /* continue */
+  return FALSE;
+}
 
-/* multi-purpose traversal function for the N-ary tree used by the score */
 static gboolean
-traverse_children (GNode    *node,
-                   gpointer  data)
+list_timelines (GNode    *node,
+                gpointer  data)
 {
-  TraverseClosure *closure = data;
   ClutterScoreEntry *entry = node->data;
-  gboolean retval = FALSE;
+  GSList **timelines = data;
 
   /* root */
-  if (!entry)
-    return TRUE;
-
-  switch (closure->action)
-    {
-    case FIND_BY_TIMELINE:
-      if (closure->d.timeline == entry->timeline)
-        {
-          closure->result = node;
-          retval = TRUE;
-        }
-      break;
-
-    case FIND_BY_ID:
-      if (closure->d.id == entry->id)
-        {
-          closure->result = node;
-          retval = TRUE;
-        }
-      break;
+  if (entry)
+    *timelines = g_slist_prepend (*timelines, entry->timeline);
 
-    case REMOVE_BY_ID:
-      if (closure->d.id == entry->id)
-        {
-          if (entry->complete_id)
-            {
-              g_signal_handler_disconnect (entry->timeline, entry->complete_id);
-              entry->complete_id = 0;
-            }
-
-          if (entry->marker_id)
-            {
-              g_signal_handler_disconnect (entry->timeline, entry->marker_id);
-              entry->marker_id = 0;
-            }
-
-          g_object_unref (entry->timeline);
-
-          g_node_traverse (node,
-                           G_POST_ORDER,
-                           G_TRAVERSE_ALL,
-                           -1,
-                           destroy_entry, NULL);
-
-          g_free (entry->marker);
-          g_slice_free (ClutterScoreEntry, entry);
-
-          closure->result = node;
-          retval = TRUE;
-        }
-      break;
-
-    case LIST_TIMELINES:
-      closure->result = g_slist_prepend (closure->result, entry->timeline);
-      retval = FALSE;
-      break;
-    }
-
-  return retval;
+  return FALSE;
 }
 
 static GNode *
 find_entry_by_timeline (ClutterScore    *score,
                         ClutterTimeline *timeline)
 {
-  ClutterScorePrivate *priv = score->priv;
-  TraverseClosure closure;
+  GSList *nodes;
 
-  closure.action = FIND_BY_TIMELINE;
-  closure.score = score;
-  closure.d.timeline = timeline;
-  closure.result = NULL;
+  nodes = g_hash_table_lookup (score->priv->entries_by_timeline, timeline);
 
-  g_node_traverse (priv->root,
-                   G_POST_ORDER,
-                   G_TRAVERSE_ALL,
-                   -1,
-                   traverse_children, &closure);
-
-  if (closure.result)
-    return closure.result;
-
-  return NULL;
+  return nodes ? nodes->data : NULL;
 }
 
 static GNode *
 find_entry_by_id (ClutterScore *score,
                   gulong        id)
 {
-  ClutterScorePrivate *priv = score->priv;
-  TraverseClosure closure;
-
-  closure.action = FIND_BY_ID;
-  closure.score = score;
-  closure.d.id = id;
-  closure.result = NULL;
-
-  g_node_traverse (priv->root,
-                   G_POST_ORDER,
-                   G_TRAVERSE_ALL,
-                   -1,
-                   traverse_children, &closure);
-
-  if (closure.result)
-    return closure.result;
-
-  return NULL;
+  return g_hash_table_lookup (score->priv->entries_by_id,
+                              GUINT_TO_POINTER (id));
 }
 
 /* forward declaration */
 static void start_entry (ClutterScoreEntry *entry);
 
 static void
-start_children_entries (GNode    *node,
-                        gpointer  data)
+start_entries (GQueue *entries)
 {
-  ClutterScoreEntry *entry = node->data;
+  GList *l, *next;
+
+  /* starting a timeline might complete it straight away, so
+   * keep a pointer to the next link around
+   */
+  for (l = entries->head; l != NULL; l = next)
+    {
+      next = l->next;
 
-  start_entry (entry);
+      start_entry (l->data);
+    }
 }
 
 static void
@@ -609,23 +613,17 @@ on_timeline_marker (ClutterTimeline   *timeline,
                     gint               frame_num,
                     ClutterScoreEntry *entry)
 {
-  GNode *parent;
+  GQueue *children;
+
   CLUTTER_NOTE (SCHEDULER, "timeline [%p] marker ('%s') reached",
 		entry->timeline,
-                entry->marker);
-
-  parent = find_entry_by_timeline (entry->score, timeline);
-  if (!parent)
-    return;
+                marker_name);
 
-  /* start every child */
-  if (parent->children)
-    {
-      g_node_children_foreach (parent,
-                               G_TRAVERSE_ALL,
-                               start_children_entries,
-                               NULL);
-    }
+  /* the marker names are interned by the timeline */
+  children = g_hash_table_lookup (entry->on_marker,
+                                  GUINT_TO_POINTER (g_quark_try_string (marker_name)));
+  if (children)
+    start_entries (children);
 }
 
 static void
@@ -647,14 +645,10 @@ on_timeline_completed (ClutterTimeline   *timeline,
   g_signal_emit (entry->score, score_signals[TIMELINE_COMPLETED], 0,
                  entry->timeline);
 
-  /* start every child */
-  if (entry->node->children)
-    {
-      g_node_children_foreach (entry->node,
-                               G_TRAVERSE_ALL,
-                               start_children_entries,
-                               NULL);
-    }
+  /* start every child attached to the end of the timeline; the
+   * children attached to a marker have been started already
+   */
+  start_entries (&entry->on_completed);
 
   /* score has finished - fire 'completed' signal */
   if (g_hash_table_size (priv->running_timelines) == 0)
@@ -704,6 +698,13 @@ start_entry (ClutterScoreEntry *entry)
                  entry->timeline);
 }
 
+static void
+start_root_entries (GNode    *node,
+                    gpointer  data)
+{
+  start_entry (node->data);
+}
+
 enum
 {
   ACTION_START,
@@ -768,7 +769,7 @@ clutter_score_start (ClutterScore *score)
     {
       g_node_children_foreach (priv->root,
                                G_TRAVERSE_ALL,
-                               start_children_entries,
+                               start_root_entries,
                                NULL);
     }
 }
@@ -863,6 +864,82 @@ clutter_score_clear (ClutterScore *score)
                    -1,
                    destroy_entry, NULL);
   g_node_destroy (priv->root);
+
+  g_hash_table_remove_all (priv->entries_by_timeline);
+  g_hash_table_remove_all (priv->entries_by_id);
+}
+
+static ClutterScoreEntry *
+clutter_score_add_entry (ClutterScore    *score,
+                         GNode           *parent_node,
+                         ClutterTimeline *timeline,
+                         const gchar     *marker_name)
+{
+  ClutterScorePrivate *priv = score->priv;
+  ClutterScoreEntry *entry, *parent_entry;
+  GSList *nodes;
+
+  parent_entry = parent_node->data;
+
+  entry = g_slice_new0 (ClutterScoreEntry);
+  entry->timeline = g_object_ref (timeline);
+  entry->parent = parent_entry ? parent_entry->timeline : NULL;
+  entry->id = priv->last_id;
+  entry->score = score;
+  g_queue_init (&entry->on_completed);
+
+  entry->node = g_node_append_data (parent_node, entry);
+
+  if (marker_name)
+    {
+      GQueue *queue;
+
+      entry->marker = g_strdup (marker_name);
+      entry->marker_quark = g_quark_from_string (marker_name);
+
+      if (parent_entry->on_marker == NULL)
+        {
+          parent_entry->on_marker =
+            g_hash_table_new_full (NULL, NULL, NULL, free_marker_queue);
+          parent_entry->marker_id =
+            g_signal_connect (parent_entry->timeline, "marker-reached",
+                              G_CALLBACK (on_timeline_marker),
+                              parent_entry);
+        }
+
+      queue = g_hash_table_lookup (parent_entry->on_marker,
+                                   GUINT_TO_POINTER (entry->marker_quark));
+      if (queue == NULL)
+        {
+          queue = g_queue_new ();
+          g_hash_table_insert (parent_entry->on_marker,
+                               GUINT_TO_POINTER (entry->marker_quark),
+                               queue);
+        }
+
+      g_queue_push_tail (queue, entry);
+    }
+  else if (parent_entry)
+    g_queue_push_tail (&parent_entry->on_completed, entry);
+
+  g_hash_table_insert (priv->entries_by_id,
+                       GUINT_TO_POINTER (entry->id),
+                       entry->node);
+
+  /* keep the first node appended for a timeline at the head, so that
+   * it is the one used as the parent by clutter_score_append()
+   */
+  nodes = g_hash_table_lookup (priv->entries_by_timeline, timeline);
+  if (nodes)
+    nodes = g_slist_append (nodes, entry->node);
+  else
+    g_hash_table_insert (priv->entries_by_timeline,
+                         timeline,
+                         g_slist_prepend (NULL, entry->node));
+
+  priv->last_id += 1;
+
+  return entry;
 }
 
 /**
@@ -892,6 +969,7 @@ clutter_score_append (ClutterScore    *score,
 {
   ClutterScorePrivate *priv;
   ClutterScoreEntry *entry;
+  GNode *node;
 
   g_return_val_if_fail (CLUTTER_IS_SCORE (score), 0);
   g_return_val_if_fail (parent == NULL || CLUTTER_IS_TIMELINE (parent), 0);
@@ -900,42 +978,18 @@ clutter_score_append (ClutterScore    *score,
   priv = score->priv;
 
   if (!parent)
-    {
-      entry = g_slice_new (ClutterScoreEntry);
-      entry->timeline = g_object_ref (timeline);
-      entry->parent = NULL;
-      entry->id = priv->last_id;
-      entry->marker = NULL;
-      entry->marker_id = 0;
-      entry->complete_id = 0;
-      entry->score = score;
-
-      entry->node = g_node_append_data (priv->root, entry);
-    }
+    node = priv->root;
   else
     {
-      GNode *node;
-
       node = find_entry_by_timeline (score, parent);
       if (G_UNLIKELY (!node))
         {
           g_warning ("Unable to find the parent timeline inside the score.");
           return 0;
         }
-
-      entry = g_slice_new (ClutterScoreEntry);
-      entry->timeline = g_object_ref (timeline);
-      entry->parent = parent;
-      entry->id = priv->last_id;
-      entry->marker = NULL;
-      entry->marker_id = 0;
-      entry->complete_id = 0;
-      entry->score = score;
-
-      entry->node = g_node_append_data (node, entry);
     }
 
-  priv->last_id += 1;
+  entry = clutter_score_add_entry (score, node, timeline, NULL);
 
   return entry->id;
 }
@@ -967,10 +1021,8 @@ clutter_score_append_at_marker (ClutterScore    *score,
                                 const gchar     *marker_name,
                                 ClutterTimeline *timeline)
 {
-  ClutterScorePrivate *priv;
   GNode *node;
   ClutterScoreEntry *entry;
-  gchar *marker_reached_signal;
 
   g_return_val_if_fail (CLUTTER_IS_SCORE (score), 0);
   g_return_val_if_fail (CLUTTER_IS_TIMELINE (parent), 0);
@@ -983,8 +1035,6 @@ clutter_score_append_at_marker (ClutterScore    *score,
       return 0;
     }
 
-  priv = score->priv;
-
   node = find_entry_by_timeline (score, parent);
   if (G_UNLIKELY (!node))
     {
@@ -992,24 +1042,7 @@ clutter_score_append_at_marker (ClutterScore    *score,
       return 0;
     }
 
-  entry = g_slice_new (ClutterScoreEntry);
-  entry->timeline = g_object_ref (timeline);
-  entry->parent = parent;
-  entry->marker = g_strdup (marker_name);
-  entry->id = priv->last_id;
-  entry->score = score;
-
-  marker_reached_signal = g_strdup_printf ("marker-reached::%s", marker_name);
-  entry->marker_id = g_signal_connect (entry->parent,
-                                       marker_reached_signal,
-                                       G_CALLBACK (on_timeline_marker),
-                                       entry);
-
-  entry->node = g_node_append_data (node, entry);
-
-  g_free (marker_reached_signal);
-
-  priv->last_id += 1;
+  entry = clutter_score_add_entry (score, node, timeline, marker_name);
 
   return entry->id;
 }
@@ -1029,27 +1062,26 @@ void
 clutter_score_remove (ClutterScore *score,
                       gulong        id)
 {
-  ClutterScorePrivate *priv;
-  TraverseClosure closure;
+  GNode *node;
 
   g_return_if_fail (CLUTTER_IS_SCORE (score));
   g_return_if_fail (id > 0);
 
-  priv = score->priv;
-
-  closure.action = REMOVE_BY_ID;
-  closure.score = score;
-  closure.d.id = id;
-  closure.result = NULL;
+  node = find_entry_by_id (score, id);
+  if (G_UNLIKELY (!node))
+    return;
 
-  g_node_traverse (priv->root,
+  g_node_traverse (node,
                    G_POST_ORDER,
                    G_TRAVERSE_ALL,
                    -1,
-                   traverse_children, &closure);
-
-  if (closure.result)
-    g_node_destroy (closure.result);
+                   unlink_subtree, NULL);
+  g_node_traverse (node,
+                   G_POST_ORDER,
+                   G_TRAVERSE_ALL,
+                   -1,
+                   destroy_entry, NULL);
+  g_node_destroy (node);
 }
 
 /**
@@ -1126,24 +1158,15 @@ clutter_score_get_timeline (ClutterScore *score,
 GSList *
 clutter_score_list_timelines (ClutterScore *score)
 {
-  ClutterScorePrivate *priv;
-  TraverseClosure closure;
-  GSList *retval;
+  GSList *retval = NULL;
 
   g_return_val_if_fail (CLUTTER_IS_SCORE (score), NULL);
 
-  priv = score->priv;
-
-  closure.action = LIST_TIMELINES;
-  closure.result = NULL;
-
-  g_node_traverse (priv->root,
+  g_node_traverse (score->priv->root,
                    G_POST_ORDER,
                    G_TRAVERSE_ALL,
                    -1,
-                   traverse_children, &closure);
-
-  retval = closure.result;
+                   list_timelines, &retval);
 
   return retval;
 }
@@ -0,0 +1,1302 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2006 OpenedHand
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Compiled UI definitions
+ *
+ * clutter-script-compiler turns a JSON UI definition into a flat,
+ * position independent blob that ClutterScript can load without
+ * tokenizing the JSON or building a JsonNode tree. The blob can be
+ * mapped straight from disk.
+ *
+ * Layout (host byte order, every table is 4 or 8 bytes aligned):
+ *
+ *   BinaryHeader
+ *   guint32 string offsets[n_strings]   (string 0 is the empty string)
+ *   NUL-terminated string data
+ *   BinaryValue values[n_values]
+ *   BinaryObject objects[n_objects]
+ *   BinaryMember members[n_members]
+ *   BinarySignal signals[n_signals]
+ *
+ * Strings are interned, so every property name, class name and id
+ * is stored once. Objects carry the name of their type function,
+ * computed at compile time, so that loading does not need to mangle
+ * class names. Scalar values keep their JSON type and are loaded
+ * straight into a GValue; arrays and objects (colors, knots, alphas)
+ * are turned into a JsonNode only for the property that uses them.
+ *
+ * Objects are stored in the same order in which the JSON parser
+ * would have emitted them, that is children before their parents,
+ * and every value is stored after the values it contains.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include "clutter-script.h"
+#include "clutter-script-private.h"
+
+#include "clutter-debug.h"
+#include "clutter-private.h"
+
+#define BINARY_MAGIC            "CLTRSCB\n"
+#define BINARY_MAGIC_LEN        8
+#define BINARY_VERSION          1
+#define BINARY_BYTE_ORDER       0x01020304
+
+typedef enum {
+  BINARY_VALUE_NULL,
+  BINARY_VALUE_INT,
+  BINARY_VALUE_DOUBLE,
+  BINARY_VALUE_BOOLEAN,
+  BINARY_VALUE_STRING,
+  BINARY_VALUE_ARRAY,
+  BINARY_VALUE_OBJECT,
+  BINARY_VALUE_OBJECT_REF
+} BinaryValueType;
+
+typedef enum {
+  BINARY_OBJECT_ANONYMOUS          = 1 << 0,
+  BINARY_OBJECT_STAGE_DEFAULT      = 1 << 1,
+  BINARY_OBJECT_EXPLICIT_TYPE_FUNC = 1 << 2
+} BinaryObjectFlags;
+
+typedef struct {
+  gchar   magic[BINARY_MAGIC_LEN];
+  guint32 version;
+  guint32 byte_order;
+  guint32 size;
+
+  guint32 n_strings;
+  guint32 strings;
+  guint32 n_values;
+  guint32 values;
+  guint32 n_objects;
+  guint32 objects;
+  guint32 n_members;
+  guint32 members;
+  guint32 n_signals;
+  guint32 signals;
+
+  guint32 reserved;
+} BinaryHeader;
+
+typedef struct {
+  guint32 type;
+  guint32 n_members;
+
+  union {
+    gint32 v_int;
+    guint32 v_boolean;
+    guint32 v_string;
+    guint32 first_member;
+    guint32 object;
+    gdouble v_double;
+  } data;
+} BinaryValue;
+
+typedef struct {
+  guint32 id;
+  guint32 class_name;
+  guint32 type_func;
+  guint32 flags;
+
+  guint32 first_property;
+  guint32 n_properties;
+  guint32 first_child;
+  guint32 n_children;
+  guint32 first_behaviour;
+  guint32 n_behaviours;
+  guint32 first_signal;
+  guint32 n_signals;
+} BinaryObject;
+
+typedef struct {
+  guint32 name;
+  guint32 value;
+} BinaryMember;
+
+typedef struct {
+  guint32 name;
+  guint32 handler;
+  guint32 object;
+  guint32 flags;
+} BinarySignal;
+
+/*
+ * compiler
+ */
+
+typedef struct {
+  GHashTable *string_ids;
+  GString *string_data;
+  GArray *string_offsets;
+
+  GArray *values;
+  GArray *objects;
+  GArray *members;
+  GArray *signals;
+} ScriptCompiler;
+
+static guint32 compile_value  (ScriptCompiler *sc,
+                               JsonNode       *node);
+static guint32 compile_object (ScriptCompiler *sc,
+                               JsonObject     *object,
+                               guint32        *inline_value);
+
+static guint32
+intern_string (ScriptCompiler *sc,
+               const gchar    *str)
+{
+  gpointer res;
+  guint32 offset, id;
+
+  if (str == NULL || *str == '\0')
+    return 0;
+
+  if (g_hash_table_lookup_extended (sc->string_ids, str, NULL, &res))
+    return GPOINTER_TO_UINT (res);
+
+  offset = sc->string_data->len;
+  g_string_append_len (sc->string_data, str, strlen (str) + 1);
+
+  id = sc->string_offsets->len;
+  g_array_append_val (sc->string_offsets, offset);
+
+  g_hash_table_insert (sc->string_ids, g_strdup (str), GUINT_TO_POINTER (id));
+
+  return id;
+}
+
+static guint32
+append_value (ScriptCompiler    *sc,
+              const BinaryValue *value)
+{
+  g_array_append_vals (sc->values, value, 1);
+
+  return sc->values->len - 1;
+}
+
+static guint32
+append_members (ScriptCompiler *sc,
+                GArray         *members)
+{
+  guint32 first = sc->members->len;
+
+  if (members->len == 0)
+    return 0;
+
+  g_array_append_vals (sc->members, members->data, members->len);
+
+  return first;
+}
+
+static const gchar *
+get_string_member (JsonObject  *object,
+                   const gchar *name)
+{
+  JsonNode *val = json_object_get_member (object, name);
+
+  if (val && JSON_NODE_TYPE (val) == JSON_NODE_VALUE)
+    return json_node_get_string (val);
+
+  return NULL;
+}
+
+static gboolean
+get_boolean_member (JsonObject  *object,
+                    const gchar *name)
+{
+  JsonNode *val = json_object_get_member (object, name);
+
+  if (val && JSON_NODE_TYPE (val) == JSON_NODE_VALUE)
+    return json_node_get_boolean (val);
+
+  return FALSE;
+}
+
+static guint32
+compile_reference (ScriptCompiler *sc,
+                   JsonNode       *node)
+{
+  BinaryValue value = { 0, };
+
+  /* this matches get_id_from_node() in clutter-script.c */
+  if (JSON_NODE_TYPE (node) == JSON_NODE_OBJECT)
+    {
+      JsonObject *object = json_node_get_object (node);
+      const gchar *id;
+
+      if (get_string_member (object, "type") != NULL)
+        {
+          guint32 inline_value;
+
+          value.type = BINARY_VALUE_OBJECT_REF;
+          value.data.object = compile_object (sc, object, &inline_value);
+
+          return append_value (sc, &value);
+        }
+
+      id = get_string_member (object, "id");
+      if (id != NULL)
+        {
+          value.type = BINARY_VALUE_STRING;
+          value.data.v_string = intern_string (sc, id);
+
+          return append_value (sc, &value);
+        }
+    }
+  else if (JSON_NODE_TYPE (node) == JSON_NODE_VALUE &&
+           json_node_get_string (node) != NULL)
+    {
+      value.type = BINARY_VALUE_STRING;
+      value.data.v_string = intern_string (sc, json_node_get_string (node));
+
+      return append_value (sc, &value);
+    }
+
+  return G_MAXUINT32;
+}
+
+static void
+compile_references (ScriptCompiler *sc,
+                    JsonNode       *node,
+                    guint32        *first,
+                    guint32        *n_refs)
+{
+  JsonArray *array;
+  GArray *refs;
+  guint i, array_len;
+
+  *first = *n_refs = 0;
+
+  if (JSON_NODE_TYPE (node) != JSON_NODE_ARRAY)
+    return;
+
+  array = json_node_get_array (node);
+  array_len = json_array_get_length (array);
+
+  refs = g_array_sized_new (FALSE, FALSE, sizeof (BinaryMember), array_len);
+
+  for (i = 0; i < array_len; i++)
+    {
+      BinaryMember ref = { 0, };
+
+      ref.value = compile_reference (sc, json_array_get_element (array, i));
+      if (ref.value != G_MAXUINT32)
+        g_array_append_val (refs, ref);
+    }
+
+  *first = append_members (sc, refs);
+  *n_refs = refs->len;
+
+  g_array_free (refs, TRUE);
+}
+
+static void
+compile_signals (ScriptCompiler *sc,
+                 const gchar    *id,
+                 JsonNode       *node,
+                 guint32        *first,
+                 guint32        *n_signals)
+{
+  JsonArray *array;
+  guint i, array_len;
+
+  *first = sc->signals->len;
+  *n_signals = 0;
+
+  if (JSON_NODE_TYPE (node) != JSON_NODE_ARRAY)
+    {
+      g_warning ("Invalid `signals' attribute for object `%s': "
+                 "an Array is expected",
+                 id ? id : "<anonymous>");
+      return;
+    }
+
+  array = json_node_get_array (node);
+  array_len = json_array_get_length (array);
+
+  for (i = 0; i < array_len; i++)
+    {
+      JsonNode *val = json_array_get_element (array, i);
+      BinarySignal sinfo = { 0, };
+      JsonObject *object;
+      const gchar *name, *handler;
+
+      if (JSON_NODE_TYPE (val) != JSON_NODE_OBJECT)
+        continue;
+
+      object = json_node_get_object (val);
+
+      name = get_string_member (object, "name");
+      handler = get_string_member (object, "handler");
+      if (name == NULL || handler == NULL)
+        {
+          g_warning ("Signal definition for object `%s' without a "
+                     "valid `name' or `handler' attribute",
+                     id ? id : "<anonymous>");
+          continue;
+        }
+
+      sinfo.name = intern_string (sc, name);
+      sinfo.handler = intern_string (sc, handler);
+      sinfo.object = intern_string (sc, get_string_member (object, "object"));
+
+      if (get_boolean_member (object, "after"))
+        sinfo.flags |= G_CONNECT_AFTER;
+
+      if (get_boolean_member (object, "swapped"))
+        sinfo.flags |= G_CONNECT_SWAPPED;
+
+      g_array_append_val (sc->signals, sinfo);
+      *n_signals += 1;
+    }
+}
+
+static guint32
+compile_object (ScriptCompiler *sc,
+                JsonObject     *object,
+                guint32        *inline_value)
+{
+  BinaryObject record = { 0, };
+  BinaryValue value = { 0, };
+  BinaryMember member = { 0, };
+  GArray *properties, *members;
+  const gchar *id, *class_name, *type_func;
+  GList *names, *l;
+  guint32 object_id;
+
+  id = get_string_member (object, "id");
+  class_name = get_string_member (object, "type");
+  type_func = get_string_member (object, "type_func");
+
+  if (id)
+    record.id = intern_string (sc, id);
+  else
+    record.flags |= BINARY_OBJECT_ANONYMOUS;
+
+  record.class_name = intern_string (sc, class_name);
+
+  /* resolve the type function name now instead of at load time */
+  if (type_func)
+    {
+      record.type_func = intern_string (sc, type_func);
+      record.flags |= BINARY_OBJECT_EXPLICIT_TYPE_FUNC;
+    }
+  else
+    {
+      gchar *symbol = clutter_script_get_symbol_from_class (class_name);
+
+      record.type_func = intern_string (sc, symbol);
+      g_free (symbol);
+    }
+
+  properties = g_array_new (FALSE, FALSE, sizeof (BinaryMember));
+
+  names = json_object_get_members (object);
+  for (l = names; l != NULL; l = l->next)
+    {
+      const gchar *name = l->data;
+      JsonNode *node = json_object_get_member (object, name);
+
+      if (strcmp (name, "id") == 0 ||
+          strcmp (name, "type") == 0 ||
+          strcmp (name, "type_func") == 0)
+        continue;
+
+      if (strcmp (name, "children") == 0)
+        compile_references (sc, node, &record.first_child, &record.n_children);
+      else if (strcmp (name, "behaviours") == 0)
+        compile_references (sc, node,
+                            &record.first_behaviour,
+                            &record.n_behaviours);
+      else if (strcmp (name, "signals") == 0)
+        compile_signals (sc, id, node, &record.first_signal, &record.n_signals);
+      else if (strcmp (name, "is-default") == 0 &&
+               strcmp (class_name, "ClutterStage") == 0)
+        {
+          if (JSON_NODE_TYPE (node) == JSON_NODE_VALUE &&
+              json_node_get_boolean (node))
+            record.flags |= BINARY_OBJECT_STAGE_DEFAULT;
+        }
+      else
+        {
+          member.name = intern_string (sc, name);
+          member.value = compile_value (sc, node);
+          g_array_append_val (properties, member);
+        }
+    }
+
+  g_list_free (names);
+
+  record.first_property = append_members (sc, properties);
+  record.n_properties = properties->len;
+
+  g_array_append_val (sc->objects, record);
+  object_id = sc->objects->len - 1;
+
+  /* the JSON parser leaves the object definition in place as well,
+   * with its id and type, in case it is used as a property value
+   */
+  members = g_array_sized_new (FALSE, FALSE, sizeof (BinaryMember),
+                               properties->len + 2);
+
+  if (id)
+    {
+      value.type = BINARY_VALUE_STRING;
+      value.data.v_string = record.id;
+    }
+  else
+    {
+      value.type = BINARY_VALUE_OBJECT_REF;
+      value.data.object = object_id;
+    }
+
+  member.name = intern_string (sc, "id");
+  member.value = append_value (sc, &value);
+  g_array_append_val (members, member);
+
+  value.type = BINARY_VALUE_STRING;
+  value.data.v_string = record.class_name;
+
+  member.name = intern_string (sc, "type");
+  member.value = append_value (sc, &value);
+  g_array_append_val (members, member);
+
+  g_array_append_vals (members, properties->data, properties->len);
+
+  value.type = BINARY_VALUE_OBJECT;
+  value.n_members = members->len;
+  value.data.first_member = append_members (sc, members);
+
+  *inline_value = append_value (sc, &value);
+
+  g_array_free (members, TRUE);
+  g_array_free (properties, TRUE);
+
+  return object_id;
+}
+
+static guint32
+compile_value (ScriptCompiler *sc,
+               JsonNode       *node)
+{
+  BinaryValue value = { 0, };
+
+  switch (JSON_NODE_TYPE (node))
+    {
+    case JSON_NODE_NULL:
+      value.type = BINARY_VALUE_NULL;
+      break;
+
+    case JSON_NODE_VALUE:
+      {
+        GValue node_value = { 0, };
+
+        json_node_get_value (node, &node_value);
+
+        switch (G_VALUE_TYPE (&node_value))
+          {
+          case G_TYPE_INT:
+            value.type = BINARY_VALUE_INT;
+            value.data.v_int = g_value_get_int (&node_value);
+            break;
+
+          case G_TYPE_DOUBLE:
+            value.type = BINARY_VALUE_DOUBLE;
+            value.data.v_double = g_value_get_double (&node_value);
+            break;
+
+          case G_TYPE_BOOLEAN:
+            value.type = BINARY_VALUE_BOOLEAN;
+            value.data.v_boolean = g_value_get_boolean (&node_value);
+            break;
+
+          case G_TYPE_STRING:
+            value.type = BINARY_VALUE_STRING;
+            value.data.v_string =
+              intern_string (sc, g_value_get_string (&node_value));
+            break;
+
+          default:
+            value.type = BINARY_VALUE_NULL;
+            break;
+          }
+
+        g_value_unset (&node_value);
+      }
+      break;
+
+    case JSON_NODE_ARRAY:
+      {
+        JsonArray *array = json_node_get_array (node);
+        guint i, array_len = json_array_get_length (array);
+        GArray *members;
+
+        members = g_array_sized_new (FALSE, FALSE,
+                                     sizeof (BinaryMember),
+                                     array_len);
+
+        for (i = 0; i < array_len; i++)
+          {
+            BinaryMember member = { 0, };
+
+            member.value = compile_value (sc,
+                                          json_array_get_element (array, i));
+            g_array_append_val (members, member);
+          }
+
+        value.type = BINARY_VALUE_ARRAY;
+        value.n_members = members->len;
+        value.data.first_member = append_members (sc, members);
+
+        g_array_free (members, TRUE);
+      }
+      break;
+
+    case JSON_NODE_OBJECT:
+      {
+        JsonObject *object = json_node_get_object (node);
+        GArray *members;
+        GList *names, *l;
+
+        /* typed objects become object definitions of their own */
+        if (get_string_member (object, "type") != NULL)
+          {
+            guint32 inline_value;
+
+            compile_object (sc, object, &inline_value);
+
+            return inline_value;
+          }
+
+        if (json_object_has_member (object, "id"))
+          g_warning ("Object `%s' has no `type' attribute",
+                     get_string_member (object, "id"));
+
+        members = g_array_new (FALSE, FALSE, sizeof (BinaryMember));
+
+        names = json_object_get_members (object);
+        for (l = names; l != NULL; l = l->next)
+          {
+            BinaryMember member = { 0, };
+            const gchar *name = l->data;
+
+            member.name = intern_string (sc, name);
+            member.value = compile_value (sc,
+                                          json_object_get_member (object,
+                                                                  name));
+            g_array_append_val (members, member);
+          }
+
+        g_list_free (names);
+
+        value.type = BINARY_VALUE_OBJECT;
+        value.n_members = members->len;
+        value.data.first_member = append_members (sc, members);
+
+        g_array_free (members, TRUE);
+      }
+      break;
+    }
+
+  return append_value (sc, &value);
+}
+
+static gsize
+align_offset (gsize offset,
+              gsize alignment)
+{
+  return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+/*
+ * clutter_script_binary_compile:
+ * @root: the root node of a UI definition
+ * @length: return location for the length of the compiled data
+ * @error: return location for a #GError, or %NULL
+ *
+ * Compiles the UI definition in @root into the binary format
+ * understood by clutter_script_load_from_file() and
+ * clutter_script_load_from_data().
+ *
+ * Return value: a newly allocated buffer, or %NULL on error
+ */
+gchar *
+clutter_script_binary_compile (JsonNode  *root,
+                               gsize     *length,
+                               GError   **error)
+{
+  ScriptCompiler sc;
+  BinaryHeader header;
+  gsize offset, string_data;
+  gchar *retval;
+  guint i;
+
+  g_return_val_if_fail (length != NULL, NULL);
+
+  if (root == NULL)
+    {
+      g_set_error (error, CLUTTER_SCRIPT_ERROR,
+                   CLUTTER_SCRIPT_ERROR_INVALID_VALUE,
+                   "Empty UI definition");
+      return NULL;
+    }
+
+  sc.string_ids = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         g_free,
+                                         NULL);
+  sc.string_data = g_string_new (NULL);
+  sc.string_offsets = g_array_new (FALSE, FALSE, sizeof (guint32));
+  sc.values = g_array_new (FALSE, FALSE, sizeof (BinaryValue));
+  sc.objects = g_array_new (FALSE, FALSE, sizeof (BinaryObject));
+  sc.members = g_array_new (FALSE, FALSE, sizeof (BinaryMember));
+  sc.signals = g_array_new (FALSE, FALSE, sizeof (BinarySignal));
+
+  /* string 0 is the empty string, and it's used for "no string" */
+  g_string_append_c (sc.string_data, '\0');
+  offset = 0;
+  g_array_append_val (sc.string_offsets, offset);
+
+  /* the root value itself is not needed, only the objects */
+  compile_value (&sc, root);
+
+  memset (&header, 0, sizeof (BinaryHeader));
+  memcpy (header.magic, BINARY_MAGIC, BINARY_MAGIC_LEN);
+  header.version = BINARY_VERSION;
+  header.byte_order = BINARY_BYTE_ORDER;
+
+  offset = sizeof (BinaryHeader);
+
+  header.n_strings = sc.string_offsets->len;
+  header.strings = offset;
+  offset += sc.string_offsets->len * sizeof (guint32);
+
+  string_data = offset;
+  offset += sc.string_data->len;
+  offset = align_offset (offset, 8);
+
+  header.n_values = sc.values->len;
+  header.values = offset;
+  offset += sc.values->len * sizeof (BinaryValue);
+
+  header.n_objects = sc.objects->len;
+  header.objects = offset;
+  offset += sc.objects->len * sizeof (BinaryObject);
+
+  header.n_members = sc.members->len;
+  header.members = offset;
+  offset += sc.members->len * sizeof (BinaryMember);
+
+  header.n_signals = sc.signals->len;
+  header.signals = offset;
+  offset += sc.signals->len * sizeof (BinarySignal);
+
+  header.size = offset;
+
+  /* relocate the string offsets */
+  for (i = 0; i < sc.string_offsets->len; i++)
+    g_array_index (sc.string_offsets, guint32, i) += string_data;
+
+  retval = g_malloc0 (offset);
+
+  memcpy (retval, &header, sizeof (BinaryHeader));
+  memcpy (retval + header.strings,
+          sc.string_offsets->data,
+          sc.string_offsets->len * sizeof (guint32));
+  memcpy (retval + string_data, sc.string_data->str, sc.string_data->len);
+  memcpy (retval + header.values,
+          sc.values->data,
+          sc.values->len * sizeof (BinaryValue));
+  memcpy (retval + header.objects,
+          sc.objects->data,
+          sc.objects->len * sizeof (BinaryObject));
+  memcpy (retval + header.members,
+          sc.members->data,
+          sc.members->len * sizeof (BinaryMember));
+  memcpy (retval + header.signals,
+          sc.signals->data,
+          sc.signals->len * sizeof (BinarySignal));
+
+  *length = offset;
+
+  g_hash_table_destroy (sc.string_ids);
+  g_string_free (sc.string_data, TRUE);
+  g_array_free (sc.string_offsets, TRUE);
+  g_array_free (sc.values, TRUE);
+  g_array_free (sc.objects, TRUE);
+  g_array_free (sc.members, TRUE);
+  g_array_free (sc.signals, TRUE);
+
+  return retval;
+}
+
+/*
+ * loader
+ */
+
+typedef struct {
+  const gchar *data;
+  gsize size;
+
+  const BinaryHeader *header;
+  const guint32 *strings;
+  const BinaryValue *values;
+  const BinaryObject *objects;
+  const BinaryMember *members;
+  const BinarySignal *signals;
+
+  gchar **ids;
+} ScriptLoader;
+
+/*
+ * clutter_script_binary_check:
+ * @data: a buffer
+ * @length: the length of @data, or -1 if unknown
+ *
+ * Checks whether @data contains a compiled UI definition.
+ *
+ * Return value: %TRUE if @data starts with the compiled script magic
+ */
+gboolean
+clutter_script_binary_check (const gchar *data,
+                             gssize       length)
+{
+  if (data == NULL)
+    return FALSE;
+
+  if (length >= 0 && (gsize) length < sizeof (BinaryHeader))
+    return FALSE;
+
+  /* strncmp() stops on the NUL of a short string */
+  return strncmp (data, BINARY_MAGIC, BINARY_MAGIC_LEN) == 0;
+}
+
+static gboolean
+check_table (const BinaryHeader *header,
+             guint32             offset,
+             guint32             n_elements,
+             gsize               element_size,
+             gsize               alignment)
+{
+  if (offset % alignment != 0 || offset > header->size)
+    return FALSE;
+
+  return n_elements <= (header->size - offset) / element_size;
+}
+
+static const gchar *
+loader_get_string (ScriptLoader *loader,
+                   guint32       string_id)
+{
+  guint32 offset;
+
+  if (string_id == 0 || string_id >= loader->header->n_strings)
+    return NULL;
+
+  offset = loader->strings[string_id];
+  if (offset >= loader->size ||
+      memchr (loader->data + offset, '\0', loader->size - offset) == NULL)
+    return NULL;
+
+  return loader->data + offset;
+}
+
+static gboolean
+loader_check_members (ScriptLoader *loader,
+                      guint32       first,
+                      guint32       n_members)
+{
+  if (n_members == 0)
+    return TRUE;
+
+  return first < loader->header->n_members &&
+         n_members <= loader->header->n_members - first;
+}
+
+static JsonNode *
+loader_get_node (ScriptLoader *loader,
+                 guint32       value_id)
+{
+  const BinaryValue *value;
+  JsonNode *retval;
+  guint i;
+
+  if (value_id >= loader->header->n_values)
+    return NULL;
+
+  value = &loader->values[value_id];
+
+  switch (value->type)
+    {
+    case BINARY_VALUE_NULL:
+      return json_node_new (JSON_NODE_NULL);
+
+    case BINARY_VALUE_INT:
+      retval = json_node_new (JSON_NODE_VALUE);
+      json_node_set_int (retval, value->data.v_int);
+      return retval;
+
+    case BINARY_VALUE_DOUBLE:
+      retval = json_node_new (JSON_NODE_VALUE);
+      json_node_set_double (retval, value->data.v_double);
+      return retval;
+
+    case BINARY_VALUE_BOOLEAN:
+      retval = json_node_new (JSON_NODE_VALUE);
+      json_node_set_boolean (retval, value->data.v_boolean);
+      return retval;
+
+    case BINARY_VALUE_STRING:
+      retval = json_node_new (JSON_NODE_VALUE);
+      json_node_set_string (retval,
+                            value->data.v_string == 0
+                              ? ""
+                              : loader_get_string (loader,
+                                                   value->data.v_string));
+      return retval;
+
+    case BINARY_VALUE_OBJECT_REF:
+      if (value->data.object >= loader->header->n_objects)
+        return NULL;
+
+      retval = json_node_new (JSON_NODE_VALUE);
+      json_node_set_string (retval, loader->ids[value->data.object]);
+      return retval;
+
+    case BINARY_VALUE_ARRAY:
+    case BINARY_VALUE_OBJECT:
+      if (!loader_check_members (loader,
+                                 value->data.first_member,
+                                 value->n_members))
+        return NULL;
+
+      if (value->type == BINARY_VALUE_ARRAY)
+        {
+          retval = json_node_new (JSON_NODE_ARRAY);
+          json_node_take_array (retval, json_array_sized_new (value->n_members));
+        }
+      else
+        {
+          retval = json_node_new (JSON_NODE_OBJECT);
+          json_node_take_object (retval, json_object_new ());
+        }
+
+      for (i = 0; i < value->n_members; i++)
+        {
+          const BinaryMember *member;
+          JsonNode *child;
+
+          member = &loader->members[value->data.first_member + i];
+
+          /* values are always stored after their members; this also
+           * guarantees that we cannot recurse forever on bad data
+           */
+          child = NULL;
+          if (member->value < value_id)
+            child = loader_get_node (loader, member->value);
+
+          if (child == NULL)
+            {
+              json_node_free (retval);
+              return NULL;
+            }
+
+          if (value->type == BINARY_VALUE_ARRAY)
+            json_array_add_element (json_node_get_array (retval), child);
+          else
+            {
+              const gchar *name = loader_get_string (loader, member->name);
+
+              if (name == NULL)
+                {
+                  json_node_free (child);
+                  json_node_free (retval);
+                  return NULL;
+                }
+
+              json_object_add_member (json_node_get_object (retval),
+                                      name,
+                                      child);
+            }
+        }
+
+      return retval;
+    }
+
+  return NULL;
+}
+
+static PropertyInfo *
+loader_get_property (ScriptLoader       *loader,
+                     const BinaryMember *member)
+{
+  const BinaryValue *value;
+  PropertyInfo *pinfo;
+  const gchar *name;
+
+  name = loader_get_string (loader, member->name);
+  if (name == NULL || member->value >= loader->header->n_values)
+    return NULL;
+
+  value = &loader->values[member->value];
+
+  pinfo = g_slice_new0 (PropertyInfo);
+  pinfo->name = g_strdup (name);
+
+  switch (value->type)
+    {
+    case BINARY_VALUE_INT:
+      g_value_init (&pinfo->value, G_TYPE_INT);
+      g_value_set_int (&pinfo->value, value->data.v_int);
+      pinfo->has_value = TRUE;
+      break;
+
+    case BINARY_VALUE_DOUBLE:
+      g_value_init (&pinfo->value, G_TYPE_DOUBLE);
+      g_value_set_double (&pinfo->value, value->data.v_double);
+      pinfo->has_value = TRUE;
+      break;
+
+    case BINARY_VALUE_BOOLEAN:
+      g_value_init (&pinfo->value, G_TYPE_BOOLEAN);
+      g_value_set_boolean (&pinfo->value, value->data.v_boolean);
+      pinfo->has_value = TRUE;
+      break;
+
+    case BINARY_VALUE_STRING:
+      g_value_init (&pinfo->value, G_TYPE_STRING);
+      /* the compiled data might go away after loading, so we copy */
+      g_value_set_string (&pinfo->value,
+                          value->data.v_string == 0
+                            ? ""
+                            : loader_get_string (loader,
+                                                 value->data.v_string));
+      pinfo->has_value = TRUE;
+      break;
+
+    default:
+      pinfo->node = loader_get_node (loader, member->value);
+      pinfo->owns_node = TRUE;
+
+      if (pinfo->node == NULL)
+        {
+          property_info_free (pinfo);
+          return NULL;
+        }
+      break;
+    }
+
+  return pinfo;
+}
+
+static gboolean
+loader_get_references (ScriptLoader  *loader,
+                       guint32        first,
+                       guint32        n_refs,
+                       GList        **refs)
+{
+  guint i;
+
+  if (!loader_check_members (loader, first, n_refs))
+    return FALSE;
+
+  for (i = 0; i < n_refs; i++)
+    {
+      const BinaryMember *member = &loader->members[first + i];
+      const BinaryValue *value;
+      const gchar *id;
+
+      if (member->value >= loader->header->n_values)
+        return FALSE;
+
+      value = &loader->values[member->value];
+
+      if (value->type == BINARY_VALUE_OBJECT_REF &&
+          value->data.object < loader->header->n_objects)
+        id = loader->ids[value->data.object];
+      else if (value->type == BINARY_VALUE_STRING)
+        id = loader_get_string (loader, value->data.v_string);
+      else
+        id = NULL;
+
+      if (id == NULL)
+        return FALSE;
+
+      *refs = g_list_append (*refs, g_strdup (id));
+    }
+
+  return TRUE;
+}
+
+static ObjectInfo *
+loader_get_object (ScriptLoader *loader,
+                   guint         object_id,
+                   guint         merge_id,
+                   gboolean      resolve_types)
+{
+  const BinaryObject *record = &loader->objects[object_id];
+  const gchar *class_name, *type_func;
+  ObjectInfo *oinfo;
+  guint i;
+
+  class_name = loader_get_string (loader, record->class_name);
+  type_func = loader_get_string (loader, record->type_func);
+  if (class_name == NULL || type_func == NULL)
+    return NULL;
+
+  oinfo = g_slice_new0 (ObjectInfo);
+  oinfo->merge_id = merge_id;
+  oinfo->id = g_strdup (loader->ids[object_id]);
+  oinfo->class_name = g_strdup (class_name);
+
+  if (record->flags & BINARY_OBJECT_EXPLICIT_TYPE_FUNC)
+    oinfo->type_func = g_strdup (type_func);
+  else if (resolve_types)
+    {
+      /* the type is most likely already registered; if not, we
+       * already know the name of its type function
+       */
+      oinfo->gtype = g_type_from_name (class_name);
+      if (oinfo->gtype == G_TYPE_INVALID)
+        oinfo->type_func = g_strdup (type_func);
+    }
+
+  oinfo->is_stage_default =
+    (record->flags & BINARY_OBJECT_STAGE_DEFAULT) ? TRUE : FALSE;
+  oinfo->is_toplevel = FALSE;
+  oinfo->is_unmerged = FALSE;
+  oinfo->has_unresolved = TRUE;
+
+  if (!loader_check_members (loader,
+                             record->first_property,
+                             record->n_properties) ||
+      !loader_get_references (loader,
+                              record->first_child,
+                              record->n_children,
+                              &oinfo->children) ||
+      !loader_get_references (loader,
+                              record->first_behaviour,
+                              record->n_behaviours,
+                              &oinfo->behaviours))
+    goto error;
+
+  for (i = 0; i < record->n_properties; i++)
+    {
+      const BinaryMember *member;
+      PropertyInfo *pinfo;
+
+      member = &loader->members[record->first_property + i];
+
+      pinfo = loader_get_property (loader, member);
+      if (pinfo == NULL)
+        goto error;
+
+      oinfo->properties = g_list_prepend (oinfo->properties, pinfo);
+    }
+
+  if (record->n_signals > 0 &&
+      (record->first_signal >= loader->header->n_signals ||
+       record->n_signals > loader->header->n_signals - record->first_signal))
+    goto error;
+
+  for (i = 0; i < record->n_signals; i++)
+    {
+      const BinarySignal *signal = &loader->signals[record->first_signal + i];
+      SignalInfo *sinfo;
+      const gchar *name, *handler;
+
+      name = loader_get_string (loader, signal->name);
+      handler = loader_get_string (loader, signal->handler);
+      if (name == NULL || handler == NULL)
+        goto error;
+
+      sinfo = g_slice_new0 (SignalInfo);
+      sinfo->name = g_strdup (name);
+      sinfo->handler = g_strdup (handler);
+      sinfo->object = g_strdup (loader_get_string (loader, signal->object));
+      sinfo->flags = signal->flags;
+
+      oinfo->signals = g_list_prepend (oinfo->signals, sinfo);
+    }
+
+  CLUTTER_NOTE (SCRIPT,
+                "Loaded compiled object `%s' (type:%s, id:%d, props:%d)",
+                oinfo->id,
+                oinfo->class_name,
+                oinfo->merge_id,
+                record->n_properties);
+
+  return oinfo;
+
+error:
+  object_info_free (oinfo);
+
+  return NULL;
+}
+
+/*
+ * clutter_script_binary_load:
+ * @data: compiled UI definition data
+ * @length: the length of @data, or -1 to use the size in the header
+ * @merge_id: the merge id for the loaded objects
+ * @last_unknown: counter used to name anonymous objects
+ * @resolve_types: whether the type functions stored in @data should
+ *   be used to resolve the types of the objects
+ * @error: return location for a #GError, or %NULL
+ *
+ * Loads the objects from a UI definition compiled with
+ * clutter_script_binary_compile().
+ *
+ * Return value: a list of newly allocated #ObjectInfo, in definition
+ *   order, or %NULL if @error is set
+ */
+GList *
+clutter_script_binary_load (const gchar  *data,
+                            gssize        length,
+                            guint         merge_id,
+                            guint        *last_unknown,
+                            gboolean      resolve_types,
+                            GError      **error)
+{
+  const BinaryHeader *header;
+  ScriptLoader loader;
+  gchar *aligned = NULL;
+  GList *retval = NULL;
+  const gchar *reason = NULL;
+  guint i;
+
+  g_return_val_if_fail (clutter_script_binary_check (data, length), NULL);
+
+  /* the tables are accessed in place, so they must be aligned */
+  header = (const BinaryHeader *) data;
+  if (length < 0)
+    length = header->byte_order == BINARY_BYTE_ORDER ? header->size : 0;
+
+  if (GPOINTER_TO_SIZE (data) % 8 != 0 &&
+      (gsize) length >= sizeof (BinaryHeader))
+    {
+      aligned = g_malloc (length);
+      memcpy (aligned, data, length);
+      data = aligned;
+      header = (const BinaryHeader *) data;
+    }
+
+  if ((gsize) length < sizeof (BinaryHeader))
+    reason = "truncated header";
+  else if (header->byte_order != BINARY_BYTE_ORDER)
+    reason = "compiled for a different byte order";
+  else if (header->version != BINARY_VERSION)
+    reason = "unsupported version";
+  else if (header->size > (gsize) length ||
+           header->size < sizeof (BinaryHeader))
+    reason = "truncated data";
+  else if (!check_table (header, header->strings, header->n_strings,
+                         sizeof (guint32), 4) ||
+           !check_table (header, header->values, header->n_values,
+                         sizeof (BinaryValue), 8) ||
+           !check_table (header, header->objects, header->n_objects,
+                         sizeof (BinaryObject), 4) ||
+           !check_table (header, header->members, header->n_members,
+                         sizeof (BinaryMember), 4) ||
+           !check_table (header, header->signals, header->n_signals,
+                         sizeof (BinarySignal), 4))
+    reason = "invalid table";
+
+  if (reason)
+    goto error;
+
+  loader.data = data;
+  loader.size = header->size;
+  loader.header = header;
+  loader.strings = (const guint32 *) (data + header->strings);
+  loader.values = (const BinaryValue *) (data + header->values);
+  loader.objects = (const BinaryObject *) (data + header->objects);
+  loader.members = (const BinaryMember *) (data + header->members);
+  loader.signals = (const BinarySignal *) (data + header->signals);
+
+  /* anonymous objects are named at load time, exactly like the
+   * JSON parser would do, so that ids are unique across merges
+   */
+  loader.ids = g_new0 (gchar*, header->n_objects + 1);
+  for (i = 0; i < header->n_objects; i++)
+    {
+      const BinaryObject *record = &loader.objects[i];
+
+      if (record->flags & BINARY_OBJECT_ANONYMOUS)
+        loader.ids[i] = g_strdup_printf ("script-%d-%d",
+                                         merge_id,
+                                         (*last_unknown)++);
+      else
+        loader.ids[i] = g_strdup (loader_get_string (&loader, record->id));
+
+      if (loader.ids[i] == NULL)
+        {
+          reason = "invalid object id";
+          break;
+        }
+    }
+
+  for (i = 0; reason == NULL && i < header->n_objects; i++)
+    {
+      ObjectInfo *oinfo;
+
+      oinfo = loader_get_object (&loader, i, merge_id, resolve_types);
+      if (oinfo == NULL)
+        reason = "invalid object definition";
+      else
+        retval = g_list_prepend (retval, oinfo);
+    }
+
+  g_strfreev (loader.ids);
+
+  if (reason)
+    {
+      g_list_foreach (retval, (GFunc) object_info_free, NULL);
+      g_list_free (retval);
+      retval = NULL;
+
+      goto error;
+    }
+
+  g_free (aligned);
+
+  return g_list_reverse (retval);
+
+error:
+  g_set_error (error, CLUTTER_SCRIPT_ERROR,
+               CLUTTER_SCRIPT_ERROR_INVALID_VALUE,
+               "Invalid compiled UI definition: %s",
+               reason);
+
+  g_free (aligned);
+
+  return NULL;
+}
@@ -0,0 +1,128 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2006 OpenedHand
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* clutter-script-compiler: compiles a JSON UI definition into the
+ * binary format that ClutterScript loads without parsing JSON.
+ *
+ *   clutter-script-compiler [-o OUTPUT] INPUT.json
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include "clutter-script-private.h"
+
+#include "json/json-parser.h"
+
+static gchar *output = NULL;
+
+static GOptionEntry entries[] = {
+  { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output,
+    "Write the compiled definition to FILE", "FILE" },
+  { NULL }
+};
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *context;
+  JsonParser *parser;
+  GError *error = NULL;
+  gchar *data;
+  gsize length;
+
+  g_type_init ();
+
+  context = g_option_context_new ("INPUT - compile a ClutterScript definition");
+  g_option_context_add_main_entries (context, entries, NULL);
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      return EXIT_FAILURE;
+    }
+
+  g_option_context_free (context);
+
+  if (argc != 2)
+    {
+      g_printerr ("Usage: %s [-o OUTPUT] INPUT\n", g_get_prgname ());
+      return EXIT_FAILURE;
+    }
+
+  if (output == NULL)
+    {
+      if (g_str_has_suffix (argv[1], ".json"))
+        {
+          gchar *base = g_strndup (argv[1], strlen (argv[1]) - 5);
+
+          output = g_strconcat (base, ".csb", NULL);
+          g_free (base);
+        }
+      else
+        output = g_strconcat (argv[1], ".csb", NULL);
+    }
+
+  parser = json_parser_new ();
+
+  if (!json_parser_load_from_file (parser, argv[1], &error))
+    {
+      g_printerr ("%s: %s\n", argv[1], error->message);
+      g_error_free (error);
+      g_object_unref (parser);
+      return EXIT_FAILURE;
+    }
+
+  data = clutter_script_binary_compile (json_parser_get_root (parser),
+                                        &length,
+                                        &error);
+  g_object_unref (parser);
+
+  if (data == NULL)
+    {
+      g_printerr ("%s: %s\n", argv[1], error->message);
+      g_error_free (error);
+      return EXIT_FAILURE;
+    }
+
+  if (!g_file_set_contents (output, data, length, &error))
+    {
+      g_printerr ("%s: %s\n", output, error->message);
+      g_error_free (error);
+      g_free (data);
+      return EXIT_FAILURE;
+    }
+
+  g_free (data);
+  g_free (output);
+
+  return EXIT_SUCCESS;
+}
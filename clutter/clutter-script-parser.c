@@ -35,19 +35,12 @@ clutter_script_get_type_from_symbol (const gchar *symbol)
   return gtype;
 }
 
-GType
-clutter_script_get_type_from_class (const gchar *name)
+gchar *
+clutter_script_get_symbol_from_class (const gchar *name)
 {
-  static GModule *module = NULL;
   GString *symbol_name = g_string_sized_new (64);
-  GType gtype = G_TYPE_INVALID;
-  GTypeGetFunc func;
-  gchar *symbol;
   gint i;
 
-  if (G_UNLIKELY (!module))
-    module = g_module_open (NULL, G_MODULE_BIND_LAZY);
-  
   for (i = 0; name[i] != '\0'; i++)
     {
       gchar c = name[i];
@@ -81,8 +74,22 @@ clutter_script_get_type_from_class (const gchar *name)
     }
 
   g_string_append (symbol_name, "_get_type");
-  
-  symbol = g_string_free (symbol_name, FALSE);
+
+  return g_string_free (symbol_name, FALSE);
+}
+
+GType
+clutter_script_get_type_from_class (const gchar *name)
+{
+  static GModule *module = NULL;
+  GType gtype = G_TYPE_INVALID;
+  GTypeGetFunc func;
+  gchar *symbol;
+
+  if (G_UNLIKELY (!module))
+    module = g_module_open (NULL, G_MODULE_BIND_LAZY);
+
+  symbol = clutter_script_get_symbol_from_class (name);
 
   if (g_module_symbol (module, symbol, (gpointer)&func))
     {
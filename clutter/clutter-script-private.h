@@ -63,6 +63,12 @@ typedef struct {
   gchar *name;
   JsonNode *node;
   GParamSpec *pspec;
+
+  /* pre-typed scalar value, used by compiled scripts */
+  GValue value;
+
+  guint has_value : 1;
+  guint owns_node : 1;
 } PropertyInfo;
 
 typedef struct {
@@ -74,6 +80,7 @@ typedef struct {
 } SignalInfo;
 
 void property_info_free (gpointer data);
+void signal_info_free   (gpointer data);
 
 gboolean clutter_script_parse_node        (ClutterScript *script,
                                            GValue        *value,
@@ -81,8 +88,15 @@ gboolean clutter_script_parse_node        (ClutterScript *script,
                                            JsonNode      *node,
                                            GParamSpec    *pspec);
 
+gboolean clutter_script_parse_value       (ClutterScript *script,
+                                           GValue        *value,
+                                           const gchar   *name,
+                                           const GValue  *node_value,
+                                           GParamSpec    *pspec);
+
 GType    clutter_script_get_type_from_symbol (const gchar *symbol);
 GType    clutter_script_get_type_from_class  (const gchar *name);
+gchar *  clutter_script_get_symbol_from_class (const gchar *name);
 
 GObject *clutter_script_construct_object  (ClutterScript *script,
                                            ObjectInfo    *info);
@@ -106,6 +120,19 @@ gboolean clutter_script_parse_color       (ClutterScript   *script,
 GObject *clutter_script_parse_alpha       (ClutterScript   *script,
                                            JsonNode        *node);
 
+/* compiled (binary) scripts, see clutter-script-binary.c */
+gboolean clutter_script_binary_check      (const gchar     *data,
+                                           gssize           length);
+gchar *  clutter_script_binary_compile    (JsonNode        *root,
+                                           gsize           *length,
+                                           GError         **error);
+GList *  clutter_script_binary_load       (const gchar     *data,
+                                           gssize           length,
+                                           guint            merge_id,
+                                           guint           *last_unknown,
+                                           gboolean         resolve_types,
+                                           GError         **error);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_SCRIPT_PRIVATE_H__ */
@@ -149,6 +149,12 @@
  *   "signals"    := an array of signal definitions to connect to an object
  * ]]></programlisting>
  *
+ * Large UI definitions can be compiled ahead of time with the
+ * clutter-script-compiler tool, which stores them in a compact binary
+ * format with interned strings and pre-typed values. Compiled files
+ * are loaded with the same functions used for JSON files, but without
+ * building a JSON tree, and are much faster to load.
+ *
  * #ClutterScript is available since Clutter 0.6
  */
 
@@ -186,7 +192,8 @@ enum
   PROP_0,
 
   PROP_FILENAME_SET,
-  PROP_FILENAME
+  PROP_FILENAME,
+  PROP_LAZY_CONSTRUCTION
 };
 
 #define CLUTTER_SCRIPT_GET_PRIVATE(obj) \
@@ -205,6 +212,13 @@ struct _ClutterScriptPrivate
 
   gchar *filename;
   guint is_filename : 1;
+
+  guint lazy_construction : 1;
+
+  /* signal connection used for objects constructed on demand */
+  ClutterScriptConnectFunc connect_func;
+  gpointer connect_data;
+  GDestroyNotify connect_notify;
 };
 
 G_DEFINE_TYPE_WITH_CODE (ClutterScript,
@@ -788,12 +802,20 @@ json_object_end (JsonParser *parser,
 
       node = json_object_get_member (object, name);
 
-      pinfo = g_slice_new (PropertyInfo);
+      pinfo = g_slice_new0 (PropertyInfo);
 
       pinfo->name = g_strdup (name);
-      pinfo->node = node;
       pinfo->pspec = NULL;
 
+      /* objects constructed on demand can outlive the parser's tree */
+      if (priv->lazy_construction)
+        {
+          pinfo->node = json_node_copy (node);
+          pinfo->owns_node = TRUE;
+        }
+      else
+        pinfo->node = node;
+
       oinfo->properties = g_list_prepend (oinfo->properties, pinfo);
     }
 
@@ -810,7 +832,8 @@ json_object_end (JsonParser *parser,
   g_hash_table_steal (priv->objects, oinfo->id);
   g_hash_table_insert (priv->objects, oinfo->id, oinfo);
 
-  oinfo->object = clutter_script_construct_object (script, oinfo);
+  if (!priv->lazy_construction)
+    oinfo->object = clutter_script_construct_object (script, oinfo);
 }
 
 gboolean
@@ -974,163 +997,232 @@ clutter_script_parse_node (ClutterScript *script,
 
     case JSON_NODE_VALUE:
       json_node_get_value (node, &node_value);
+      retval = clutter_script_parse_value (script, value, name,
+                                           &node_value,
+                                           pspec);
+      g_value_unset (&node_value);
+      break;
+    }
 
-      if (pspec)
-        g_value_init (value, G_PARAM_SPEC_VALUE_TYPE (pspec));
-      else
-        g_value_init (value, G_VALUE_TYPE (&node_value));
+  return retval;
+}
 
-      switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (value)))
+/*
+ * clutter_script_parse_value:
+ * @script: a #ClutterScript
+ * @value: return location for the parsed value
+ * @name: the name of the property
+ * @node_value: a fundamental JSON value (integer, double, string or boolean)
+ * @pspec: the #GParamSpec of the property, or %NULL
+ *
+ * Converts @node_value into the type of @pspec and stores it inside
+ * @value. This is used for both the scalar JSON nodes and the pre-typed
+ * values stored inside compiled scripts.
+ *
+ * Return value: %TRUE if the conversion was successful
+ */
+gboolean
+clutter_script_parse_value (ClutterScript *script,
+                            GValue        *value,
+                            const gchar   *name,
+                            const GValue  *node_value,
+                            GParamSpec    *pspec)
+{
+  gboolean retval = FALSE;
+
+  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), FALSE);
+  g_return_val_if_fail (name != NULL, FALSE);
+  g_return_val_if_fail (G_IS_VALUE (node_value), FALSE);
+
+  if (pspec)
+    g_value_init (value, G_PARAM_SPEC_VALUE_TYPE (pspec));
+  else
+    g_value_init (value, G_VALUE_TYPE (node_value));
+
+  switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (value)))
+    {
+    /* fundamental JSON types */
+    case G_TYPE_INT:
+    case G_TYPE_DOUBLE:
+    case G_TYPE_STRING:
+    case G_TYPE_BOOLEAN:
+      g_value_copy (node_value, value);
+      retval = TRUE;
+      break;
+
+    case G_TYPE_UINT:
+      g_value_set_uint (value, (guint) g_value_get_int (node_value));
+      retval = TRUE;
+      break;
+
+    case G_TYPE_ULONG:
+      g_value_set_ulong (value, (gulong) g_value_get_int (node_value));
+      retval = TRUE;
+      break;
+
+    case G_TYPE_UCHAR:
+      g_value_set_uchar (value, (guchar) g_value_get_int (node_value));
+      retval = TRUE;
+      break;
+
+    case G_TYPE_ENUM:
+      if (G_VALUE_HOLDS (node_value, G_TYPE_INT))
         {
-        /* fundamental JSON types */
-        case G_TYPE_INT:
-        case G_TYPE_DOUBLE:
-        case G_TYPE_STRING:
-        case G_TYPE_BOOLEAN:
-          g_value_copy (&node_value, value);
+          g_value_set_enum (value, g_value_get_int (node_value));
           retval = TRUE;
-          break;
+        }
+      else if (G_VALUE_HOLDS (node_value, G_TYPE_STRING))
+        {
+          gint enum_value;
 
-        case G_TYPE_UINT:
-          g_value_set_uint (value, (guint) g_value_get_int (&node_value));
-          retval = TRUE;
-          break;
+          retval = clutter_script_enum_from_string (G_VALUE_TYPE (value),
+                                                    g_value_get_string (node_value),
+                                                    &enum_value);
+          if (retval)
+            g_value_set_enum (value, enum_value);
+        }
+      break;
 
-        case G_TYPE_ULONG:
-          g_value_set_ulong (value, (gulong) g_value_get_int (&node_value));
+    case G_TYPE_FLAGS:
+      if (G_VALUE_HOLDS (node_value, G_TYPE_INT))
+        {
+          g_value_set_flags (value, g_value_get_int (node_value));
           retval = TRUE;
-          break;
+        }
+      else if (G_VALUE_HOLDS (node_value, G_TYPE_STRING))
+        {
+          gint flags_value;
 
-        case G_TYPE_UCHAR:
-          g_value_set_uchar (value, (guchar) g_value_get_int (&node_value));
-          retval = TRUE;
-          break;
+          retval = clutter_script_flags_from_string (G_VALUE_TYPE (value),
+                                                     g_value_get_string (node_value),
+                                                     &flags_value);
+          if (retval)
+            g_value_set_flags (value, flags_value);
+        }
+      break;
 
-        case G_TYPE_ENUM:
-          if (G_VALUE_HOLDS (&node_value, G_TYPE_INT))
-            {
-              g_value_set_enum (value, g_value_get_int (&node_value));
-              retval = TRUE;
-            }
-          else if (G_VALUE_HOLDS (&node_value, G_TYPE_STRING))
+    case G_TYPE_BOXED:
+      if (G_VALUE_HOLDS (value, CLUTTER_TYPE_COLOR))
+        {
+          if (G_VALUE_HOLDS (node_value, G_TYPE_STRING))
             {
-              gint enum_value;
+              const gchar *str = g_value_get_string (node_value);
+              ClutterColor color = { 0, };
 
-              retval = clutter_script_enum_from_string (G_VALUE_TYPE (value),
-                                                        g_value_get_string (&node_value),
-                                                        &enum_value);
-              if (retval)
-                g_value_set_enum (value, enum_value);
-            }
-          break;
+              if (str && str[0] != '\0')
+                clutter_color_parse (str, &color);
 
-        case G_TYPE_FLAGS:
-          if (G_VALUE_HOLDS (&node_value, G_TYPE_INT))
-            {
-              g_value_set_flags (value, g_value_get_int (&node_value));
+              g_value_set_boxed (value, &color);
               retval = TRUE;
             }
-          else if (G_VALUE_HOLDS (&node_value, G_TYPE_STRING))
-            {
-              gint flags_value;
-
-              retval = clutter_script_flags_from_string (G_VALUE_TYPE (value),
-                                                         g_value_get_string (&node_value),
-                                                         &flags_value);
-              if (retval)
-                g_value_set_flags (value, flags_value);
-            }
-          break;
+        }
+      break;
 
-        case G_TYPE_BOXED:
-          if (G_VALUE_HOLDS (value, CLUTTER_TYPE_COLOR))
+    case G_TYPE_OBJECT:
+#ifdef USE_GDKPIXBUF
+      if (G_VALUE_HOLDS (value, GDK_TYPE_PIXBUF))
+        {
+          if (G_VALUE_HOLDS (node_value, G_TYPE_STRING))
             {
-              if (G_VALUE_HOLDS (&node_value, G_TYPE_STRING))
+              const gchar *str = g_value_get_string (node_value);
+              GdkPixbuf *pixbuf = NULL;
+              gchar *path;
+              GError *error;
+
+              if (g_path_is_absolute (str))
+                path = g_strdup (str);
+              else
                 {
-                  const gchar *str = g_value_get_string (&node_value);
-                  ClutterColor color = { 0, };
+                  gchar *dirname = NULL;
 
-                  if (str && str[0] != '\0')
-                    clutter_color_parse (str, &color);
+                  if (script->priv->is_filename)
+                    dirname = g_path_get_dirname (script->priv->filename);
+                  else
+                    dirname = g_get_current_dir ();
 
-                  g_value_set_boxed (value, &color);
-                  retval = TRUE;
+                  path = g_build_filename (dirname, str, NULL);
+                  g_free (dirname);
                 }
-            }
-          break;
 
-        case G_TYPE_OBJECT:
-#ifdef USE_GDKPIXBUF
-          if (G_VALUE_HOLDS (value, GDK_TYPE_PIXBUF))
-            {
-              if (G_VALUE_HOLDS (&node_value, G_TYPE_STRING))
+              error = NULL;
+              pixbuf = gdk_pixbuf_new_from_file (path, &error);
+              if (error)
                 {
-                  const gchar *str = g_value_get_string (&node_value);
-                  GdkPixbuf *pixbuf = NULL;
-                  gchar *path;
-                  GError *error;
-
-                  if (g_path_is_absolute (str))
-                    path = g_strdup (str);
-                  else
-                    {
-                      gchar *dirname = NULL;
-
-                      if (script->priv->is_filename)
-                        dirname = g_path_get_dirname (script->priv->filename);
-                      else
-                        dirname = g_get_current_dir ();
-
-                      path = g_build_filename (dirname, str, NULL);
-                      g_free (dirname);
-                    }
-
-                  error = NULL;
-                  pixbuf = gdk_pixbuf_new_from_file (path, &error);
-                  if (error)
-                    {
-                      g_warning ("Unable to open image at path `%s': %s",
-                                 path,
-                                 error->message);
-                      g_error_free (error);
-                    }
-                  else
-                    {
-                      g_value_take_object (value, pixbuf);
-                      retval = TRUE;
-                    }
-
-                  g_free (path);
+                  g_warning ("Unable to open image at path `%s': %s",
+                             path,
+                             error->message);
+                  g_error_free (error);
+                }
+              else
+                {
+                  g_value_take_object (value, pixbuf);
+                  retval = TRUE;
                 }
+
+              g_free (path);
             }
-          else
+        }
+      else
+        {
+          if (G_VALUE_HOLDS (node_value, G_TYPE_STRING))
             {
-              if (G_VALUE_HOLDS (&node_value, G_TYPE_STRING))
+              const gchar *str = g_value_get_string (node_value);
+              GObject *object = clutter_script_get_object (script, str);
+              if (object)
                 {
-                  const gchar *str = g_value_get_string (&node_value);
-                  GObject *object = clutter_script_get_object (script, str);
-                  if (object)
-                    {
-                      g_value_set_object (value, object);
-                      retval = TRUE;
-                    }
+                  g_value_set_object (value, object);
+                  retval = TRUE;
                 }
             }
-          break;
-#endif
-
-        default:
-          retval = FALSE;
-          break;
         }
+      break;
+#endif
 
-      g_value_unset (&node_value);
+    default:
+      retval = FALSE;
       break;
     }
 
   return retval;
 }
 
+/* compiled scripts store scalar values already typed, and only
+ * materialize a JsonNode if a ClutterScriptable implementation
+ * asks for one
+ */
+static JsonNode *
+property_info_get_node (PropertyInfo *pinfo)
+{
+  if (pinfo->node == NULL && pinfo->has_value)
+    {
+      pinfo->node = json_node_new (JSON_NODE_VALUE);
+      json_node_set_value (pinfo->node, &pinfo->value);
+      pinfo->owns_node = TRUE;
+    }
+
+  return pinfo->node;
+}
+
+static gboolean
+parse_property (ClutterScript *script,
+                GValue        *value,
+                PropertyInfo  *pinfo)
+{
+  if (pinfo->node)
+    return clutter_script_parse_node (script, value,
+                                      pinfo->name,
+                                      pinfo->node,
+                                      pinfo->pspec);
+
+  if (pinfo->has_value)
+    return clutter_script_parse_value (script, value,
+                                       pinfo->name,
+                                       &pinfo->value,
+                                       pinfo->pspec);
+
+  return FALSE;
+}
+
 static GList *
 clutter_script_translate_parameters (ClutterScript  *script,
                                      GObject        *object,
@@ -1169,13 +1261,10 @@ clutter_script_translate_parameters (ClutterScript  *script,
       if (parse_custom)
         res = iface->parse_custom_node (scriptable, script, &param.value,
                                         pinfo->name,
-                                        pinfo->node);
+                                        property_info_get_node (pinfo));
 
       if (!res)
-        res = clutter_script_parse_node (script, &param.value,
-                                         pinfo->name,
-                                         pinfo->node,
-                                         pinfo->pspec);
+        res = parse_property (script, &param.value, pinfo);
 
       if (!res)
         {
@@ -1241,10 +1330,7 @@ clutter_script_construct_parameters (ClutterScript  *script,
 
       param.name = g_strdup (pinfo->name);
       
-      if (!clutter_script_parse_node (script, &param.value,
-                                      pinfo->name,
-                                      pinfo->node,
-                                      pinfo->pspec))
+      if (!parse_property (script, &param.value, pinfo))
         {
           unparsed = g_list_prepend (unparsed, pinfo);
           continue;
@@ -1346,6 +1432,47 @@ add_children (ClutterScript    *script,
   oinfo->children = unresolved;
 }
 
+static void
+connect_object_signals (ClutterScript            *script,
+                        GObject                  *object,
+                        ObjectInfo               *oinfo,
+                        ClutterScriptConnectFunc  func,
+                        gpointer                  user_data)
+{
+  GList *unresolved, *l;
+
+  unresolved = NULL;
+  for (l = oinfo->signals; l != NULL; l = l->next)
+    {
+      SignalInfo *sinfo = l->data;
+      GObject *connect_object = NULL;
+
+      if (sinfo->object)
+        connect_object = clutter_script_get_object (script, sinfo->object);
+
+      if (sinfo->object && !connect_object)
+        unresolved = g_list_prepend (unresolved, sinfo);
+      else
+        {
+          func (script, object,
+                sinfo->name,
+                sinfo->handler,
+                connect_object,
+                sinfo->flags,
+                user_data);
+
+          signal_info_free (sinfo);
+        }
+    }
+
+  /* keep the unresolved signal handlers around, in case
+   * clutter_script_connect_signals() is called multiple
+   * times (e.g. after a UI definition merge)
+   */
+  g_list_free (oinfo->signals);
+  oinfo->signals = unresolved;
+}
+
 /* top-level classes: these classes are the roots of the
  * hiearchy; some of them must be unreferenced, whilst
  * others are owned by other instances
@@ -1377,6 +1504,7 @@ clutter_script_construct_object (ClutterScript *script,
   ClutterScriptable *scriptable = NULL;
   ClutterScriptableIface *iface = NULL;
   gboolean set_custom_property = FALSE;
+  gboolean is_new;
 
   g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), NULL);
   g_return_val_if_fail (oinfo != NULL, NULL);
@@ -1396,6 +1524,8 @@ clutter_script_construct_object (ClutterScript *script,
   if (G_UNLIKELY (oinfo->gtype == G_TYPE_INVALID))
     return NULL;
 
+  is_new = (oinfo->object == NULL);
+
   if (oinfo->object)
     object = oinfo->object;
   else if (oinfo->gtype == CLUTTER_TYPE_STAGE && oinfo->is_stage_default)
@@ -1452,6 +1582,12 @@ clutter_script_construct_object (ClutterScript *script,
       g_array_free (construct_params, TRUE);
    }
 
+  /* store the object right away, so that every later request for it,
+   * including the ones made while adding its children, gets this
+   * instance instead of constructing a new one
+   */
+  oinfo->object = object;
+
   /* shortcut, to avoid typechecking every time */
   if (CLUTTER_IS_SCRIPTABLE (object))
     {
@@ -1538,6 +1674,14 @@ clutter_script_construct_object (ClutterScript *script,
                             g_strdup (oinfo->id),
                             g_free);
 
+  /* objects constructed on demand after clutter_script_connect_signals()
+   * has been called still need their handlers
+   */
+  if (is_new && script->priv->connect_func && oinfo->signals)
+    connect_object_signals (script, object, oinfo,
+                            script->priv->connect_func,
+                            script->priv->connect_data);
+
   return object;
 }
 
@@ -1554,13 +1698,37 @@ construct_each_object (gpointer key,
 }
 
 static void
-json_parse_end (JsonParser *parser,
-                gpointer    user_data)
+resolve_each_object (gpointer key,
+                     gpointer value,
+                     gpointer data)
+{
+  ClutterScript *script = data;
+  ObjectInfo *oinfo = value;
+
+  /* with lazy construction we only need to update the objects
+   * that have already been constructed and that reference
+   * definitions which were not available at the time
+   */
+  if (oinfo->object && oinfo->has_unresolved)
+    clutter_script_construct_object (script, oinfo);
+}
+
+static void
+clutter_script_resolve_objects (ClutterScript *script)
 {
-  ClutterScript *script = user_data;
   ClutterScriptPrivate *priv = script->priv;
 
-  g_hash_table_foreach (priv->objects, construct_each_object, script);
+  if (priv->lazy_construction)
+    g_hash_table_foreach (priv->objects, resolve_each_object, script);
+  else
+    g_hash_table_foreach (priv->objects, construct_each_object, script);
+}
+
+static void
+json_parse_end (JsonParser *parser,
+                gpointer    user_data)
+{
+  clutter_script_resolve_objects (user_data);
 }
 
 static GType
@@ -1576,6 +1744,88 @@ clutter_script_real_get_type_from_name (ClutterScript *script,
   return clutter_script_get_type_from_class (type_name);
 }
 
+static ObjectInfo *
+merge_object_info (ClutterScript *script,
+                   ObjectInfo    *oinfo)
+{
+  ClutterScriptPrivate *priv = script->priv;
+  ObjectInfo *old_info;
+
+  old_info = g_hash_table_lookup (priv->objects, oinfo->id);
+  if (G_LIKELY (!old_info))
+    {
+      g_hash_table_insert (priv->objects, oinfo->id, oinfo);
+      return oinfo;
+    }
+
+  /* same rules as json_object_end(): the old definition is kept
+   * and the new attributes are added to it
+   */
+  old_info->properties = g_list_concat (oinfo->properties,
+                                        old_info->properties);
+  old_info->signals = g_list_concat (oinfo->signals, old_info->signals);
+  old_info->children = g_list_concat (old_info->children, oinfo->children);
+  old_info->behaviours = g_list_concat (old_info->behaviours,
+                                        oinfo->behaviours);
+  old_info->is_stage_default = oinfo->is_stage_default;
+  old_info->has_unresolved = TRUE;
+
+  oinfo->properties = NULL;
+  oinfo->signals = NULL;
+  oinfo->children = NULL;
+  oinfo->behaviours = NULL;
+  object_info_free (oinfo);
+
+  return old_info;
+}
+
+static gboolean
+clutter_script_load_compiled (ClutterScript  *script,
+                              const gchar    *data,
+                              gssize          length,
+                              GError        **error)
+{
+  ClutterScriptPrivate *priv = script->priv;
+  GError *internal_error;
+  gboolean resolve_types;
+  GList *objects, *l;
+
+  /* the type functions stored in the compiled data can only be
+   * used if the type lookup has not been overridden
+   */
+  resolve_types = CLUTTER_SCRIPT_GET_CLASS (script)->get_type_from_name ==
+                  clutter_script_real_get_type_from_name;
+
+  internal_error = NULL;
+  objects = clutter_script_binary_load (data, length,
+                                        priv->last_merge_id,
+                                        &priv->last_unknown,
+                                        resolve_types,
+                                        &internal_error);
+  if (internal_error)
+    {
+      g_propagate_error (error, internal_error);
+      return FALSE;
+    }
+
+  for (l = objects; l != NULL; l = l->next)
+    l->data = merge_object_info (script, l->data);
+
+  /* objects are stored in the order the JSON parser emits them */
+  for (l = objects; l != NULL && !priv->lazy_construction; l = l->next)
+    {
+      ObjectInfo *oinfo = l->data;
+
+      oinfo->object = clutter_script_construct_object (script, oinfo);
+    }
+
+  g_list_free (objects);
+
+  clutter_script_resolve_objects (script);
+
+  return TRUE;
+}
+
 void
 property_info_free (gpointer data)
 {
@@ -1586,6 +1836,12 @@ property_info_free (gpointer data)
       if (pinfo->pspec)
         g_param_spec_unref (pinfo->pspec);
 
+      if (pinfo->has_value)
+        g_value_unset (&pinfo->value);
+
+      if (pinfo->owns_node)
+        json_node_free (pinfo->node);
+
       g_free (pinfo->name);
 
       g_slice_free (PropertyInfo, pinfo);
@@ -1667,6 +1923,9 @@ clutter_script_finalize (GObject *gobject)
 {
   ClutterScriptPrivate *priv = CLUTTER_SCRIPT_GET_PRIVATE (gobject);
 
+  if (priv->connect_notify)
+    priv->connect_notify (priv->connect_data);
+
   g_object_unref (priv->parser);
   g_hash_table_destroy (priv->objects);
   g_strfreev (priv->search_paths);
@@ -1675,6 +1934,26 @@ clutter_script_finalize (GObject *gobject)
   G_OBJECT_CLASS (clutter_script_parent_class)->finalize (gobject);
 }
 
+static void
+clutter_script_set_property (GObject      *gobject,
+                             guint         prop_id,
+                             const GValue *value,
+                             GParamSpec   *pspec)
+{
+  ClutterScript *script = CLUTTER_SCRIPT (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_LAZY_CONSTRUCTION:
+      clutter_script_set_lazy_construction (script,
+                                            g_value_get_boolean (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
 static void
 clutter_script_get_property (GObject    *gobject,
                              guint       prop_id,
@@ -1691,6 +1970,9 @@ clutter_script_get_property (GObject    *gobject,
     case PROP_FILENAME:
       g_value_set_string (value, script->priv->filename);
       break;
+    case PROP_LAZY_CONSTRUCTION:
+      g_value_set_boolean (value, script->priv->lazy_construction);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -1704,6 +1986,7 @@ clutter_script_class_init (ClutterScriptClass *klass)
 
   klass->get_type_from_name = clutter_script_real_get_type_from_name;
 
+  gobject_class->set_property = clutter_script_set_property;
   gobject_class->get_property = clutter_script_get_property;
   gobject_class->finalize = clutter_script_finalize;
 
@@ -1738,6 +2021,22 @@ clutter_script_class_init (ClutterScriptClass *klass)
                                                         "The path of the currently parsed file",
                                                         NULL,
                                                         CLUTTER_PARAM_READABLE));
+  /**
+   * ClutterScript:lazy-construction:
+   *
+   * Whether the objects defined in the loaded UI definitions should
+   * be constructed only when they are first requested, see
+   * clutter_script_set_lazy_construction().
+   *
+   * Since: 0.8.2-maemo
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_LAZY_CONSTRUCTION,
+                                   g_param_spec_boolean ("lazy-construction",
+                                                         "Lazy Construction",
+                                                         "Whether objects are constructed on demand",
+                                                         FALSE,
+                                                         CLUTTER_PARAM_READWRITE));
 }
 
 static void
@@ -1792,6 +2091,10 @@ clutter_script_new (void)
  * Loads the definitions from @filename into @script and merges with
  * the currently loaded ones, if any.
  *
+ * @filename can either contain JSON or a definition compiled with
+ * the clutter-script-compiler tool; compiled definitions are mapped
+ * and loaded without parsing any JSON.
+ *
  * Return value: on error, zero is returned and @error is set
  *   accordingly. On success, the merge id for the UI definitions is
  *   returned. You can use the merge id with clutter_script_unmerge().
@@ -1804,6 +2107,7 @@ clutter_script_load_from_file (ClutterScript  *script,
                                GError        **error)
 {
   ClutterScriptPrivate *priv;
+  GMappedFile *mapped;
   GError *internal_error;
 
   g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), 0);
@@ -1817,7 +2121,24 @@ clutter_script_load_from_file (ClutterScript  *script,
   priv->last_merge_id += 1;
 
   internal_error = NULL;
-  json_parser_load_from_file (priv->parser, filename, &internal_error);
+
+  /* compiled definitions are used straight from the mapped file */
+  mapped = g_mapped_file_new (filename, FALSE, NULL);
+  if (mapped &&
+      clutter_script_binary_check (g_mapped_file_get_contents (mapped),
+                                   g_mapped_file_get_length (mapped)))
+    {
+      clutter_script_load_compiled (script,
+                                    g_mapped_file_get_contents (mapped),
+                                    g_mapped_file_get_length (mapped),
+                                    &internal_error);
+    }
+  else
+    json_parser_load_from_file (priv->parser, filename, &internal_error);
+
+  if (mapped)
+    g_mapped_file_unref (mapped);
+
   if (internal_error)
     {
       g_propagate_error (error, internal_error);
@@ -1839,6 +2160,10 @@ clutter_script_load_from_file (ClutterScript  *script,
  * Loads the definitions from @data into @script and merges with
  * the currently loaded ones, if any.
  *
+ * @data can also contain a compiled definition, as created by the
+ * clutter-script-compiler tool; in that case, if @length is -1 the
+ * length stored inside the compiled definition is used.
+ *
  * Return value: on error, zero is returned and @error is set
  *   accordingly. On success, the merge id for the UI definitions is
  *   returned. You can use the merge id with clutter_script_unmerge().
@@ -1857,9 +2182,6 @@ clutter_script_load_from_data (ClutterScript  *script,
   g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), 0);
   g_return_val_if_fail (data != NULL, 0);
 
-  if (length < 0)
-    length = strlen (data);
-
   priv = script->priv;
 
   g_free (priv->filename);
@@ -1868,7 +2190,17 @@ clutter_script_load_from_data (ClutterScript  *script,
   priv->last_merge_id += 1;
 
   internal_error = NULL;
-  json_parser_load_from_data (priv->parser, data, length, &internal_error);
+
+  if (clutter_script_binary_check (data, length))
+    clutter_script_load_compiled (script, data, length, &internal_error);
+  else
+    {
+      if (length < 0)
+        length = strlen (data);
+
+      json_parser_load_from_data (priv->parser, data, length,
+                                  &internal_error);
+    }
   if (internal_error)
     {
       g_propagate_error (error, internal_error);
@@ -1887,6 +2219,9 @@ clutter_script_load_from_data (ClutterScript  *script,
  * Retrieves the object bound to @name. This function does not increment
  * the reference count of the returned object.
  *
+ * If #ClutterScript:lazy-construction is set, the object is constructed
+ * the first time it is requested.
+ *
  * Return value: the named object, or %NULL if no object with the
  *   given name was available
  *
@@ -2040,7 +2375,65 @@ clutter_script_unmerge_objects (ClutterScript *script,
   g_slist_foreach (data.ids, (GFunc) g_free, NULL);
   g_slist_free (data.ids);
 
-  clutter_script_ensure_objects (script);
+  clutter_script_resolve_objects (script);
+}
+
+/**
+ * clutter_script_set_lazy_construction:
+ * @script: a #ClutterScript
+ * @lazy: whether objects should be constructed on demand
+ *
+ * Sets whether @script should construct objects on demand.
+ *
+ * By default, every object in a UI definition is constructed as soon
+ * as the definition has been loaded. If @lazy is %TRUE, the definitions
+ * loaded afterwards are only parsed, and each object is constructed,
+ * together with its children and behaviours, the first time it is
+ * retrieved with clutter_script_get_object() or referenced by another
+ * object being constructed. Definitions that are never used are never
+ * constructed.
+ *
+ * Signal handlers connected with clutter_script_connect_signals() are
+ * also connected to the objects constructed later on.
+ *
+ * This function should be called before loading any definition.
+ *
+ * Since: 0.8.2-maemo
+ */
+void
+clutter_script_set_lazy_construction (ClutterScript *script,
+                                      gboolean       lazy)
+{
+  ClutterScriptPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_SCRIPT (script));
+
+  priv = script->priv;
+
+  if (priv->lazy_construction != lazy)
+    {
+      priv->lazy_construction = lazy;
+
+      g_object_notify (G_OBJECT (script), "lazy-construction");
+    }
+}
+
+/**
+ * clutter_script_get_lazy_construction:
+ * @script: a #ClutterScript
+ *
+ * Retrieves whether @script constructs objects on demand.
+ *
+ * Return value: %TRUE if objects are constructed on demand
+ *
+ * Since: 0.8.2-maemo
+ */
+gboolean
+clutter_script_get_lazy_construction (ClutterScript *script)
+{
+  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), FALSE);
+
+  return script->priv->lazy_construction;
 }
 
 /**
@@ -2115,6 +2508,13 @@ typedef struct {
   gpointer data;
 } ConnectData;
 
+static void
+connect_data_free (ConnectData *cd)
+{
+  g_module_close (cd->module);
+  g_free (cd);
+}
+
 /* default signal connection code */
 static void
 clutter_script_default_connect (ClutterScript *script,
@@ -2205,9 +2605,11 @@ clutter_script_connect_signals (ClutterScript *script,
                                        clutter_script_default_connect,
                                        cd);
 
-  g_module_close (cd->module);
-
-  g_free (cd);
+  /* objects constructed later on will use the same data */
+  if (script->priv->lazy_construction)
+    script->priv->connect_notify = (GDestroyNotify) connect_data_free;
+  else
+    connect_data_free (cd);
 }
 
 typedef struct {
@@ -2224,42 +2626,21 @@ connect_each_object (gpointer key,
   SignalConnectData *connect_data = data;
   ClutterScript *script = connect_data->script;
   ObjectInfo *oinfo = value;
-  GObject *object = oinfo->object;
-  GList *unresolved, *l;
 
+  /* objects that have not been constructed yet will be
+   * connected when they are
+   */
   if (G_UNLIKELY (!oinfo->object))
-    oinfo->object = clutter_script_construct_object (script, oinfo);
-
-  unresolved = NULL;
-  for (l = oinfo->signals; l != NULL; l = l->next)
     {
-      SignalInfo *sinfo = l->data;
-      GObject *connect_object = NULL;
-
-      if (sinfo->object)
-        connect_object = clutter_script_get_object (script, sinfo->object);
-
-      if (sinfo->object && !connect_object)
-        unresolved = g_list_prepend (unresolved, sinfo);
-      else
-        {
-          connect_data->func (script, object,
-                              sinfo->name,
-                              sinfo->handler,
-                              connect_object,
-                              sinfo->flags,
-                              connect_data->user_data);
+      if (script->priv->lazy_construction)
+        return;
 
-          signal_info_free (sinfo);
-        }
+      oinfo->object = clutter_script_construct_object (script, oinfo);
     }
 
-  /* keep the unresolved signal handlers around, in case
-   * clutter_script_connect_signals() is called multiple
-   * times (e.g. after a UI definition merge)
-   */
-  g_list_free (oinfo->signals);
-  oinfo->signals = unresolved;
+  connect_object_signals (script, oinfo->object, oinfo,
+                          connect_data->func,
+                          connect_data->user_data);
 }
 
 /**
@@ -2295,6 +2676,18 @@ clutter_script_connect_signals_full (ClutterScript            *script,
   data.user_data = user_data;
 
   g_hash_table_foreach (script->priv->objects, connect_each_object, &data);
+
+  if (script->priv->lazy_construction)
+    {
+      ClutterScriptPrivate *priv = script->priv;
+
+      if (priv->connect_notify)
+        priv->connect_notify (priv->connect_data);
+
+      priv->connect_func = func;
+      priv->connect_data = user_data;
+      priv->connect_notify = NULL;
+    }
 }
 
 GQuark
@@ -137,6 +137,10 @@ void           clutter_script_unmerge_objects      (ClutterScript  *script,
                                                     guint           merge_id);
 void           clutter_script_ensure_objects       (ClutterScript  *script);
 
+void           clutter_script_set_lazy_construction (ClutterScript *script,
+                                                     gboolean       lazy);
+gboolean       clutter_script_get_lazy_construction (ClutterScript *script);
+
 GType          clutter_script_get_type_from_name   (ClutterScript  *script,
                                                     const gchar    *type_name);
 
@@ -57,6 +57,12 @@
 
 static GList *clutter_shaders_list = NULL;
 
+/* the shader whose program is currently in use, if any; this allows
+ * enabling a shader to skip the program switch when it is already
+ * bound, e.g. when restoring the shader of a parent actor
+ */
+static ClutterShader *clutter_shader_current = NULL;
+
 #define CLUTTER_SHADER_GET_PRIVATE(obj) \
   (clutter_shader_get_instance_private (obj))
 
@@ -65,6 +71,30 @@ typedef enum {
   CLUTTER_FRAGMENT_SHADER
 } ClutterShaderType;
 
+#define UNRESOLVED_LOCATION     (-2)
+
+typedef enum {
+  SHADER_UNIFORM_FLOAT,
+  SHADER_UNIFORM_INT,
+  SHADER_UNIFORM_MATRIX
+} ShaderUniformType;
+
+/* A uniform known to the shader; the location is resolved once after
+ * linking the program and the value is kept so that it can be compared
+ * against new values and re-uploaded after the program is relinked
+ */
+typedef struct _ShaderUniform
+{
+  COGLint            location;
+  ShaderUniformType  type;
+  gint               size;
+  gint               count;
+  gboolean           transpose;
+  guint              dirty : 1; /* value not uploaded to the program yet */
+  gsize              n_bytes;
+  gpointer           value;
+} ShaderUniform;
+
 struct _ClutterShaderPrivate
 {
   guint       compiled         : 1; /* Shader is bound to the GL context */
@@ -80,6 +110,9 @@ struct _ClutterShaderPrivate
 
   CoglHandle  vertex_shader;
   CoglHandle  fragment_shader;
+
+  GHashTable *uniforms;             /* name -> ShaderUniform */
+  guint       uniforms_dirty   : 1; /* at least one uniform is dirty */
 };
 
 enum 
@@ -100,6 +133,18 @@ G_DEFINE_TYPE_WITH_CODE (ClutterShader,
 const gchar *clutter_shader_get_source (ClutterShader      *shader,
                                         ClutterShaderType   type);
 
+static void
+shader_uniform_free (gpointer data)
+{
+  ShaderUniform *uniform = data;
+
+  if (G_LIKELY (uniform))
+    {
+      g_free (uniform->value);
+      g_slice_free (ShaderUniform, uniform);
+    }
+}
+
 static void
 clutter_shader_finalize (GObject *object)
 {
@@ -111,11 +156,16 @@ clutter_shader_finalize (GObject *object)
 
   clutter_shader_release (shader);
 
+  if (clutter_shader_current == shader)
+    clutter_shader_current = NULL;
+
   clutter_shaders_list = g_list_remove (clutter_shaders_list, object);
 
   g_free (priv->fragment_source);
   g_free (priv->vertex_source);
 
+  g_hash_table_destroy (priv->uniforms);
+
   G_OBJECT_CLASS (clutter_shader_parent_class)->finalize (object);
 }
 
@@ -284,6 +334,10 @@ clutter_shader_init (ClutterShader *self)
   priv->program = COGL_INVALID_HANDLE;
   priv->vertex_shader = COGL_INVALID_HANDLE;
   priv->fragment_shader = COGL_INVALID_HANDLE;
+
+  priv->uniforms = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                          g_free,
+                                          shader_uniform_free);
 }
 
 /**
@@ -468,6 +522,103 @@ bind_glsl_shader (ClutterShader  *self,
   return TRUE;
 }
 
+static void
+resolve_each_uniform (gpointer key,
+                      gpointer value,
+                      gpointer user_data)
+{
+  ClutterShaderPrivate *priv = user_data;
+  ShaderUniform *uniform = value;
+
+  uniform->location = cogl_program_get_uniform_location (priv->program, key);
+}
+
+static void
+invalidate_each_uniform (gpointer key,
+                         gpointer value,
+                         gpointer user_data)
+{
+  ShaderUniform *uniform = value;
+
+  uniform->location = UNRESOLVED_LOCATION;
+  uniform->dirty = TRUE;
+}
+
+/* Uploads the value of @uniform to the program, which must be the
+ * currently used one, if it changed since the last upload
+ */
+static void
+clutter_shader_flush_uniform (ClutterShader *shader,
+                              const gchar   *name,
+                              ShaderUniform *uniform)
+{
+  ClutterShaderPrivate *priv = shader->priv;
+
+  if (!uniform->dirty || !priv->compiled)
+    return;
+
+  if (uniform->location == UNRESOLVED_LOCATION)
+    uniform->location = cogl_program_get_uniform_location (priv->program,
+                                                           name);
+
+  /* uniforms not used by the program have no location; there is
+   * nothing to upload but they should not be looked up again
+   */
+  if (uniform->location >= 0)
+    {
+      switch (uniform->type)
+        {
+        case SHADER_UNIFORM_FLOAT:
+          if (uniform->size == 1 && uniform->count == 1)
+            cogl_program_uniform_1f (uniform->location,
+                                     *((gfloat *) uniform->value));
+          else
+            cogl_program_uniform_float (uniform->location,
+                                        uniform->size,
+                                        uniform->count,
+                                        uniform->value);
+          break;
+
+        case SHADER_UNIFORM_INT:
+          cogl_program_uniform_int (uniform->location,
+                                    uniform->size,
+                                    uniform->count,
+                                    uniform->value);
+          break;
+
+        case SHADER_UNIFORM_MATRIX:
+          cogl_program_uniform_matrix (uniform->location,
+                                       uniform->size,
+                                       uniform->count,
+                                       uniform->transpose,
+                                       uniform->value);
+          break;
+        }
+    }
+
+  uniform->dirty = FALSE;
+}
+
+static void
+flush_each_uniform (gpointer key,
+                    gpointer value,
+                    gpointer user_data)
+{
+  clutter_shader_flush_uniform (user_data, key, value);
+}
+
+static void
+clutter_shader_flush_uniforms (ClutterShader *shader)
+{
+  ClutterShaderPrivate *priv = shader->priv;
+
+  if (!priv->uniforms_dirty)
+    return;
+
+  g_hash_table_foreach (priv->uniforms, flush_each_uniform, shader);
+  priv->uniforms_dirty = FALSE;
+}
+
 /**
  * clutter_shader_compile:
  * @shader: a #ClutterShader
@@ -516,6 +667,13 @@ clutter_shader_compile (ClutterShader  *shader,
     }
 
   priv->compiled = bind_glsl_shader (shader, error);
+
+  /* resolve the location of every uniform we already know about
+   * right after linking, so that painting never needs to query it
+   */
+  if (priv->compiled)
+    g_hash_table_foreach (priv->uniforms, resolve_each_uniform, priv);
+
   g_object_notify (G_OBJECT (shader), "compiled");
 
   return priv->compiled;
@@ -552,11 +710,21 @@ clutter_shader_release (ClutterShader *shader)
   if (priv->program != COGL_INVALID_HANDLE)
     cogl_program_unref (priv->program);
 
+  /* the program is gone, so it must be bound again on the next use */
+  if (clutter_shader_current == shader)
+    clutter_shader_current = NULL;
+
   priv->vertex_shader = COGL_INVALID_HANDLE;
   priv->fragment_shader = COGL_INVALID_HANDLE;
   priv->program = COGL_INVALID_HANDLE;
   priv->compiled = FALSE;
 
+  /* the uniform values survive the release and will be uploaded
+   * to the new program once it has been linked and enabled again
+   */
+  g_hash_table_foreach (priv->uniforms, invalidate_each_uniform, NULL);
+  priv->uniforms_dirty = TRUE;
+
   g_object_notify (G_OBJECT (shader), "compiled");
 }
 
@@ -602,13 +770,11 @@ clutter_shader_set_is_enabled (ClutterShader *shader,
 
   priv = shader->priv;
 
-  if (priv->is_enabled != enabled)
+  if (enabled)
     {
       GError *error = NULL;
-      gboolean res;
 
-      res = clutter_shader_compile (shader, &error);
-      if (!res)
+      if (!clutter_shader_compile (shader, &error))
         {
           g_warning ("Unable to bind the shader: %s",
                      error ? error->message : "unknown error");
@@ -618,12 +784,27 @@ clutter_shader_set_is_enabled (ClutterShader *shader,
           return;
         }
 
-      priv->is_enabled = enabled;
+      /* an enabled shader might not be the one in use if another
+       * shader was enabled after it, like a shader set on a child
+       * actor; in that case we only need to switch the program back
+       */
+      if (clutter_shader_current != shader)
+        {
+          cogl_program_use (priv->program);
+          clutter_shader_current = shader;
+        }
 
-      if (priv->is_enabled)
-        cogl_program_use (priv->program);
-      else
-        cogl_program_use (COGL_INVALID_HANDLE);
+      clutter_shader_flush_uniforms (shader);
+    }
+  else if (clutter_shader_current == shader)
+    {
+      cogl_program_use (COGL_INVALID_HANDLE);
+      clutter_shader_current = NULL;
+    }
+
+  if (priv->is_enabled != enabled)
+    {
+      priv->is_enabled = enabled;
 
       g_object_notify (G_OBJECT (shader), "enabled");
     }
@@ -647,6 +828,68 @@ clutter_shader_get_is_enabled (ClutterShader *shader)
   return shader->priv->is_enabled;
 }
 
+/*
+ * Stores a new value for the uniform @name; the value is uploaded to
+ * the program right away if it is the one in use, or the next time the
+ * shader gets enabled otherwise. Setting a uniform to the value it
+ * already has does not cause an upload.
+ */
+static void
+clutter_shader_set_uniform_internal (ClutterShader     *shader,
+                                     const gchar       *name,
+                                     ShaderUniformType  type,
+                                     gint               size,
+                                     gint               count,
+                                     gboolean           transpose,
+                                     gconstpointer      value,
+                                     gsize              n_bytes)
+{
+  ClutterShaderPrivate *priv = shader->priv;
+  ShaderUniform *uniform;
+
+  uniform = g_hash_table_lookup (priv->uniforms, name);
+  if (!uniform)
+    {
+      uniform = g_slice_new0 (ShaderUniform);
+      uniform->location = UNRESOLVED_LOCATION;
+
+      if (priv->compiled)
+        uniform->location = cogl_program_get_uniform_location (priv->program,
+                                                               name);
+
+      g_hash_table_insert (priv->uniforms, g_strdup (name), uniform);
+    }
+  else if (uniform->type == type &&
+           uniform->size == size &&
+           uniform->count == count &&
+           uniform->transpose == transpose &&
+           uniform->n_bytes == n_bytes &&
+           memcmp (uniform->value, value, n_bytes) == 0)
+    {
+      /* unchanged; if it is still dirty it will be flushed on enable */
+      return;
+    }
+
+  if (uniform->n_bytes != n_bytes)
+    {
+      g_free (uniform->value);
+      uniform->value = g_malloc (n_bytes);
+      uniform->n_bytes = n_bytes;
+    }
+
+  memcpy (uniform->value, value, n_bytes);
+  uniform->type = type;
+  uniform->size = size;
+  uniform->count = count;
+  uniform->transpose = transpose;
+  uniform->dirty = TRUE;
+
+  if (clutter_shader_current == shader)
+    clutter_shader_flush_uniform (shader, name, uniform);
+  else
+    priv->uniforms_dirty = TRUE;
+}
+
 /**
  * clutter_shader_set_uniform_1f:
  * @shader: a #ClutterShader
@@ -663,16 +906,117 @@ clutter_shader_set_uniform_1f (ClutterShader *shader,
                                const gchar   *name,
                                gfloat         value)
 {
-  ClutterShaderPrivate *priv;
-  GLint                 location = 0;
-  GLfloat               foo      = value;
+  g_return_if_fail (CLUTTER_IS_SHADER (shader));
+  g_return_if_fail (name != NULL);
+
+  clutter_shader_set_uniform_internal (shader, name,
+                                       SHADER_UNIFORM_FLOAT, 1, 1, FALSE,
+                                       &value, sizeof (gfloat));
+}
 
+/**
+ * clutter_shader_set_uniform_float:
+ * @shader: a #ClutterShader
+ * @name: name of uniform in vertex or fragment program to set.
+ * @size: number of components of the vector, between 1 and 4
+ * @count: number of vectors, if the uniform is an array
+ * @value: @size * @count floats holding the new value of the uniform
+ *
+ * Sets a float, vec2, vec3 or vec4 variable, or an array of them, in
+ * the shader programs attached to a #ClutterShader.
+ *
+ * The location of the uniform is looked up only once, and setting a
+ * uniform to the value it already holds does not upload it again.
+ *
+ * Since: 0.8.2-maemo
+ */
+void
+clutter_shader_set_uniform_float (ClutterShader *shader,
+                                  const gchar   *name,
+                                  gint           size,
+                                  gint           count,
+                                  const gfloat  *value)
+{
   g_return_if_fail (CLUTTER_IS_SHADER (shader));
+  g_return_if_fail (name != NULL);
+  g_return_if_fail (size >= 1 && size <= 4);
+  g_return_if_fail (count >= 1);
+  g_return_if_fail (value != NULL);
+
+  clutter_shader_set_uniform_internal (shader, name,
+                                       SHADER_UNIFORM_FLOAT,
+                                       size, count, FALSE,
+                                       value,
+                                       sizeof (gfloat) * size * count);
+}
 
-  priv = shader->priv;
+/**
+ * clutter_shader_set_uniform_int:
+ * @shader: a #ClutterShader
+ * @name: name of uniform in vertex or fragment program to set.
+ * @size: number of components of the vector, between 1 and 4
+ * @count: number of vectors, if the uniform is an array
+ * @value: @size * @count integers holding the new value of the uniform
+ *
+ * Sets an int, ivec2, ivec3, ivec4 or sampler variable, or an array
+ * of them, in the shader programs attached to a #ClutterShader.
+ *
+ * Since: 0.8.2-maemo
+ */
+void
+clutter_shader_set_uniform_int (ClutterShader *shader,
+                                const gchar   *name,
+                                gint           size,
+                                gint           count,
+                                const gint    *value)
+{
+  g_return_if_fail (CLUTTER_IS_SHADER (shader));
+  g_return_if_fail (name != NULL);
+  g_return_if_fail (size >= 1 && size <= 4);
+  g_return_if_fail (count >= 1);
+  g_return_if_fail (value != NULL);
+
+  clutter_shader_set_uniform_internal (shader, name,
+                                       SHADER_UNIFORM_INT,
+                                       size, count, FALSE,
+                                       value,
+                                       sizeof (gint) * size * count);
+}
 
-  location = cogl_program_get_uniform_location (priv->program, name);
-  cogl_program_uniform_1f (location, foo);
+/**
+ * clutter_shader_set_uniform_matrix:
+ * @shader: a #ClutterShader
+ * @name: name of uniform in vertex or fragment program to set.
+ * @size: number of rows and columns of the matrix, between 2 and 4
+ * @count: number of matrices, if the uniform is an array
+ * @transpose: whether the matrices are stored in row-major order
+ * @value: @size * @size * @count floats holding the new value of
+ *   the uniform
+ *
+ * Sets a mat2, mat3 or mat4 variable, or an array of them, in the
+ * shader programs attached to a #ClutterShader.
+ *
+ * Since: 0.8.2-maemo
+ */
+void
+clutter_shader_set_uniform_matrix (ClutterShader *shader,
+                                   const gchar   *name,
+                                   gint           size,
+                                   gint           count,
+                                   gboolean       transpose,
+                                   const gfloat  *value)
+{
+  g_return_if_fail (CLUTTER_IS_SHADER (shader));
+  g_return_if_fail (name != NULL);
+  g_return_if_fail (size >= 2 && size <= 4);
+  g_return_if_fail (count >= 1);
+  g_return_if_fail (value != NULL);
+
+  clutter_shader_set_uniform_internal (shader, name,
+                                       SHADER_UNIFORM_MATRIX,
+                                       size, count, transpose != FALSE,
+                                       value,
+                                       sizeof (gfloat) * size * size * count);
 }
 
 /*
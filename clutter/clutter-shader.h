@@ -101,6 +101,22 @@ const gchar *         clutter_shader_get_fragment_source (ClutterShader      *sh
 void                  clutter_shader_set_uniform_1f      (ClutterShader      *shader,
                                                           const gchar        *name,
                                                           gfloat              value);
+void                  clutter_shader_set_uniform_float   (ClutterShader      *shader,
+                                                          const gchar        *name,
+                                                          gint                size,
+                                                          gint                count,
+                                                          const gfloat       *value);
+void                  clutter_shader_set_uniform_int     (ClutterShader      *shader,
+                                                          const gchar        *name,
+                                                          gint                size,
+                                                          gint                count,
+                                                          const gint         *value);
+void                  clutter_shader_set_uniform_matrix  (ClutterShader      *shader,
+                                                          const gchar        *name,
+                                                          gint                size,
+                                                          gint                count,
+                                                          gboolean            transpose,
+                                                          const gfloat       *value);
 /* should be private and internal */
 void                  _clutter_shader_release_all        (void);
 
@@ -281,3 +281,41 @@ _clutter_stage_manager_remove_stage (ClutterStageManager *stage_manager,
 
   g_object_unref (stage);
 }
+
+/* Redraws every stage with a queued redraw as one frame. With more
+ * than one of them the backend may swap them all together, so that
+ * they do not each wait for their own vertical blank
+ */
+void
+_clutter_stage_manager_redraw (ClutterStageManager *stage_manager)
+{
+  ClutterBackend *backend = clutter_get_default_backend ();
+  GSList *dirty = NULL, *l;
+
+  for (l = stage_manager->stages; l; l = l->next)
+    if (_clutter_stage_take_queued_redraw (l->data))
+      dirty = g_slist_prepend (dirty, g_object_ref (l->data));
+
+  if (dirty == NULL)
+    return;
+
+  dirty = g_slist_reverse (dirty);
+
+  if (dirty->next == NULL)
+    clutter_redraw (dirty->data);
+  else
+    {
+      CLUTTER_NOTE (MULTISTAGE, "redrawing %d stages in one pass",
+                    g_slist_length (dirty));
+
+      _clutter_backend_begin_redraw_pass (backend);
+
+      for (l = dirty; l; l = l->next)
+        clutter_redraw (l->data);
+
+      _clutter_backend_end_redraw_pass (backend);
+    }
+
+  g_slist_foreach (dirty, (GFunc) g_object_unref, NULL);
+  g_slist_free (dirty);
+}
@@ -273,8 +273,11 @@ _clutter_stage_get_shaped_mode (ClutterActor *self)
 static void
 clutter_stage_paint (ClutterActor *self)
 {
+  static guint         occlusion_serial = 0;
   ClutterStagePrivate *priv = CLUTTER_STAGE (self)->priv;
+  ClutterMainContext  *context;
   ClutterGeometry      *damage;
+  ClutterGeometry      visible_area;
   gboolean             update_area;
   guint                width, height;
 
@@ -412,9 +415,32 @@ clutter_stage_paint (ClutterActor *self)
 
   CLUTTER_UNSET_PRIVATE_FLAGS (self, CLUTTER_ACTOR_IN_PAINT);
 
+  /* find the children hidden behind opaque actors inside the area
+   * being redrawn, so that painting them can be skipped
+   */
+  context = clutter_context_get_default ();
+
+  if (update_area)
+    visible_area = priv->damaged_area;
+  else
+    {
+      visible_area.x = 0;
+      visible_area.y = 0;
+      visible_area.width = width;
+      visible_area.height = height;
+    }
+
+  if (++occlusion_serial == 0)
+    occlusion_serial = 1;
+
+  if (_clutter_actor_cull_occluded (self, &visible_area, occlusion_serial) > 0)
+    context->occlusion_serial = occlusion_serial;
+
   /* this will take care of painting every child */
   CLUTTER_ACTOR_CLASS (clutter_stage_parent_class)->paint (self);
 
+  context->occlusion_serial = 0;
+
   if (update_area)
     {
 #if VIEWPORT_DAMAGE
@@ -2020,20 +2046,13 @@ static gboolean
 redraw_update_idle (gpointer user_data)
 {
   ClutterStage *stage = user_data;
-  ClutterStagePrivate *priv = stage->priv;
-
-  if (priv->update_idle)
-    {
-      g_source_remove (priv->update_idle);
-      priv->update_idle = 0;
-    }
 
-  if (priv->shaped_mode)
-    /* Clutter drawing should not be done in 'shaped mode' */
-    return FALSE;
+  _clutter_record_wakeup (CLUTTER_WAKEUP_REDRAW);
 
   CLUTTER_NOTE (MULTISTAGE, "redrawing via idle for stage:%p", stage);
-  clutter_redraw (stage);
+
+  /* every stage with a queued redraw is painted in the same frame */
+  _clutter_stage_manager_redraw (clutter_stage_manager_get_default ());
 
   return FALSE;
 }
@@ -2123,6 +2142,36 @@ clutter_stage_queue_redraw_damage (ClutterStage *stage)
     }
 }
 
+gboolean
+_clutter_stage_has_queued_redraw (ClutterStage *stage)
+{
+  g_assert (CLUTTER_IS_STAGE (stage));
+
+  return stage->priv->update_idle != 0;
+}
+
+/* Removes the queued redraw of @stage, if any. Returns whether the
+ * stage should be redrawn now
+ */
+gboolean
+_clutter_stage_take_queued_redraw (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv;
+
+  g_assert (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+
+  if (priv->update_idle == 0)
+    return FALSE;
+
+  g_source_remove (priv->update_idle);
+  priv->update_idle = 0;
+
+  /* Clutter drawing should not be done in 'shaped mode' */
+  return !priv->shaped_mode;
+}
+
 /**
  * clutter_stage_is_default:
  * @stage: a #ClutterStage
@@ -90,6 +90,9 @@ struct _ClutterTexturePrivate
 
   guint                        in_dispose : 1;
   guint                        keep_aspect_ratio : 1;
+
+  /* the ClutterCloneTextures drawing this texture */
+  GSList                      *clones;
 };
 
 G_DEFINE_TYPE_WITH_CODE (ClutterTexture,
@@ -509,6 +512,7 @@ clutter_texture_paint (ClutterActor *self)
       ClutterShader      *shader = NULL;
       ClutterActor       *stage = NULL;
       ClutterPerspective  perspective;
+      guint               occlusion_serial;
 
       context = clutter_context_get_default ();
 
@@ -557,9 +561,15 @@ clutter_texture_paint (ClutterActor *self)
 	 clipped then it won't affect drawing the source */
       cogl_clip_stack_save ();
 
-      /* Render out actor scene to fbo */
+      /* Render out actor scene to fbo; the source may well be hidden
+       * on the stage, but it must not be skipped here */
+      occlusion_serial = context->occlusion_serial;
+      context->occlusion_serial = 0;
+
       clutter_actor_paint (priv->fbo_source);
 
+      context->occlusion_serial = occlusion_serial;
+
       cogl_clip_stack_restore ();
 
       /* Restore drawing to the frame buffer */
@@ -611,6 +621,33 @@ clutter_texture_paint (ClutterActor *self)
 			  0, 0, t_w, t_h);
 }
 
+static gboolean
+clutter_texture_get_opaque_area (ClutterActor    *self,
+                                 ClutterActorBox *box)
+{
+  ClutterTexturePrivate *priv = CLUTTER_TEXTURE (self)->priv;
+  ClutterActorClass     *klass = CLUTTER_ACTOR_GET_CLASS (self);
+
+  /* a subclass painting something else only covers the same area if
+   * it says so, by overriding this function as well
+   */
+  if (klass->paint != clutter_texture_paint &&
+      klass->get_opaque_area == clutter_texture_get_opaque_area)
+    return FALSE;
+
+  if (priv->texture == COGL_INVALID_HANDLE ||
+      (cogl_texture_get_format (priv->texture) & COGL_A_BIT))
+    return FALSE;
+
+  /* paint() stretches or repeats the texture over the allocation */
+  clutter_actor_get_allocation_box (self, box);
+  box->x2 -= box->x1;
+  box->y2 -= box->y1;
+  box->x1 = box->y1 = 0;
+
+  return TRUE;
+}
+
 static void
 clutter_texture_dispose (GObject *object)
 {
@@ -762,6 +799,7 @@ clutter_texture_class_init (ClutterTextureClass *klass)
   actor_class = (ClutterActorClass*) klass;
 
   actor_class->paint          = clutter_texture_paint;
+  actor_class->get_opaque_area = clutter_texture_get_opaque_area;
   actor_class->realize        = clutter_texture_realize;
   actor_class->unrealize      = clutter_texture_unrealize;
 
@@ -1069,6 +1107,41 @@ clutter_texture_get_cogl_texture (ClutterTexture *texture)
   return texture->priv->texture;
 }
 
+/* ClutterCloneTexture keeps this list so that subclasses updating the
+ * texture contents can queue redraws of the clones as well
+ */
+void
+_clutter_texture_add_clone (ClutterTexture *texture,
+                            ClutterActor   *clone)
+{
+  texture->priv->clones = g_slist_prepend (texture->priv->clones, clone);
+}
+
+void
+_clutter_texture_remove_clone (ClutterTexture *texture,
+                               ClutterActor   *clone)
+{
+  g_assert (g_slist_find (texture->priv->clones, clone) != NULL);
+
+  texture->priv->clones = g_slist_remove (texture->priv->clones, clone);
+}
+
+const GSList *
+_clutter_texture_get_clones (ClutterTexture *texture)
+{
+  return texture->priv->clones;
+}
+
+/* Called by clones before drawing the texture */
+void
+_clutter_texture_update_contents (ClutterTexture *texture)
+{
+  ClutterTextureClass *klass = CLUTTER_TEXTURE_GET_CLASS (texture);
+
+  if (klass->update_contents)
+    klass->update_contents (texture);
+}
+
 /**
  * clutter_texture_set_cogl_texture
  * @texture: A #ClutterTexture
@@ -1520,7 +1593,9 @@ clutter_texture_get_filter_quality (ClutterTexture *texture)
  * Sets the maximum number of pixels in either axis that can be wasted
  * for an individual texture slice. If -1 is specified then the
  * texture is forced not to be sliced and the texture creation will
- * fail if the hardware can't create a texture large enough.
+ * fail if the hardware can't create a texture large enough. COGL
+ * always allows up to a third of the texture size to be wasted when
+ * that avoids slicing, since every slice costs an extra draw.
  *
  * The value is only used when first creating a texture so changing it
  * after the texture data has been set has no effect.
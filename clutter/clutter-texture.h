@@ -82,8 +82,11 @@ struct _ClutterTextureClass
   void (*pixbuf_change) (ClutterTexture *texture);
 
   /*< private >*/
+  /* brings the texture contents up to date before they are drawn by
+   * a clone, for subclasses deferring updates to their own paint */
+  void (*update_contents) (ClutterTexture *texture);
+
   /* padding, for future expansion */
-  void (*_clutter_texture1) (void);
   void (*_clutter_texture2) (void);
   void (*_clutter_texture3) (void);
   void (*_clutter_texture4) (void);
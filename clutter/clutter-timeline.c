@@ -156,6 +156,7 @@ enum
 static guint               timeline_signals[LAST_SIGNAL] = { 0 };
 static gint                timeline_use_pool = -1;
 static ClutterTimeoutPool *timeline_pool = NULL;
+static guint               timeline_n_active = 0;
 
 static inline void
 timeline_pool_init (void)
@@ -178,11 +179,21 @@ timeline_pool_init (void)
     }
 }
 
+/* the timeouts are added without a destroy notify, so we use it to
+ * keep track of how many of them are alive; see clutter_is_idle()
+ */
+static void
+timeout_destroyed (gpointer data)
+{
+  g_assert (timeline_n_active > 0);
+
+  timeline_n_active -= 1;
+}
+
 static guint
 timeout_add (guint          interval,
              GSourceFunc    func,
-             gpointer       data,
-             GDestroyNotify notify)
+             gpointer       data)
 {
   guint res;
 
@@ -191,18 +202,28 @@ timeout_add (guint          interval,
       g_assert (timeline_pool != NULL);
       res = clutter_timeout_pool_add (timeline_pool,
                                       interval,
-                                      func, data, notify);
+                                      func, data,
+                                      timeout_destroyed);
     }
   else
     {
       res = clutter_threads_add_frame_source_full (CLUTTER_PRIORITY_TIMELINE,
 						   interval,
-						   func, data, notify);
+						   func, data,
+                                                   timeout_destroyed);
     }
 
+  timeline_n_active += 1;
+
   return res;
 }
 
+guint
+_clutter_timeline_get_n_active (void)
+{
+  return timeline_n_active;
+}
+
 static void
 timeout_remove (guint tag)
 {
@@ -590,6 +611,8 @@ timeline_timeout_func (gpointer data)
   priv = timeline->priv;
   context = clutter_context_get_default ();
 
+  _clutter_record_wakeup (CLUTTER_WAKEUP_TIMELINE);
+
   g_object_ref (timeline);
 
   /* Figure out potential frame skips */
@@ -790,8 +813,7 @@ static guint
 timeline_timeout_add (ClutterTimeline *timeline,
                       guint          interval,
                       GSourceFunc    func,
-                      gpointer       data,
-                      GDestroyNotify notify)
+                      gpointer       data)
 {
   ClutterTimelinePrivate *priv;
   GTimeVal timeval;
@@ -807,7 +829,7 @@ timeline_timeout_add (ClutterTimeline *timeline,
   priv->msecs_delta      = 0;
   priv->msecs_jitter     = 0;
 
-  return timeout_add (interval, func, data, notify);
+  return timeout_add (interval, func, data);
 }
 
 static gboolean
@@ -816,12 +838,14 @@ delay_timeout_func (gpointer data)
   ClutterTimeline *timeline = data;
   ClutterTimelinePrivate *priv = timeline->priv;
 
+  _clutter_record_wakeup (CLUTTER_WAKEUP_TIMELINE);
+
   priv->delay_id = 0;
 
   priv->timeout_id = timeline_timeout_add (timeline,
                                            FPS_TO_INTERVAL (priv->fps),
                                            timeline_timeout_func,
-                                           timeline, NULL);
+                                           timeline);
 
   g_signal_emit (timeline, timeline_signals[STARTED], 0);
 
@@ -853,14 +877,14 @@ clutter_timeline_start (ClutterTimeline *timeline)
     {
       priv->delay_id = timeout_add (priv->delay,
                                     delay_timeout_func,
-                                    timeline, NULL);
+                                    timeline);
     }
   else
     {
       priv->timeout_id = timeline_timeout_add (timeline,
                                                FPS_TO_INTERVAL (priv->fps),
                                                timeline_timeout_func,
-                                               timeline, NULL);
+                                               timeline);
 
       g_signal_emit (timeline, timeline_signals[STARTED], 0);
     }
@@ -1123,7 +1147,7 @@ clutter_timeline_set_speed (ClutterTimeline *timeline,
           priv->timeout_id = timeline_timeout_add (timeline,
                                                    FPS_TO_INTERVAL (priv->fps),
                                                    timeline_timeout_func,
-                                                   timeline, NULL);
+                                                   timeline);
         }
 
       g_object_freeze_notify (G_OBJECT (timeline));
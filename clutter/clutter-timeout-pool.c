@@ -271,6 +271,13 @@ clutter_timeout_pool_check (GSource *source)
   ClutterTimeoutPool *pool = (ClutterTimeoutPool *) source;
   GList *l = pool->timeouts;
 
+  /* an empty pool is checked on every iteration of the main loop
+   * even when nothing is running; avoid taking the Clutter lock
+   * for it
+   */
+  if (l == NULL)
+    return FALSE;
+
   clutter_threads_enter ();
 
   for (l = pool->timeouts; l; l = l->next)
@@ -30,6 +30,7 @@
 #include "cogl.h"
 #include "cogl-internal.h"
 #include "cogl-context.h"
+#include "cogl-handle.h"
 
 #include <string.h>
 #include <gmodule.h>
@@ -37,11 +38,6 @@
 #define _COGL_MAX_BEZ_RECURSE_DEPTH 16
 
 /* these are defined in the particular backend(float in gl vs fixed in gles)*/
-void _cogl_path_clear_nodes ();
-void _cogl_path_add_node    (ClutterFixed x,
-                             ClutterFixed y);
-void _cogl_path_fill_nodes    ();
-void _cogl_path_stroke_nodes  ();
 void _cogl_rectangle (gint x,
                       gint y,
                       guint width,
@@ -50,6 +46,8 @@ void _cogl_rectanglex (ClutterFixed x,
                        ClutterFixed y,
                        ClutterFixed width,
                        ClutterFixed height);
+void _cogl_rectangles_with_color (const CoglColoredRectangle *rects,
+                                  guint                       n_rects);
 void
 cogl_rectangle (gint x,
                 gint y,
@@ -59,6 +57,16 @@ cogl_rectangle (gint x,
   _cogl_rectangle (x, y, width, height);
 }
 
+void
+cogl_rectangles_with_color (const CoglColoredRectangle *rects,
+                            guint                       n_rects)
+{
+  if (n_rects == 0)
+    return;
+
+  _cogl_rectangles_with_color (rects, n_rects);
+}
+
 void
 cogl_rectanglex (ClutterFixed x,
                  ClutterFixed y,
@@ -69,15 +77,134 @@ cogl_rectanglex (ClutterFixed x,
 }
 
 
+static void _cogl_path_free (CoglPath *path);
+
+COGL_HANDLE_DEFINE (Path, path, path_handles);
+
+static inline void
+_cogl_path_get_node (CoglPath      *path,
+                     guint          index_,
+                     CoglFixedVec2 *node)
+{
+#ifdef CLUTTER_COGL_HAS_GL
+  node->x = CLUTTER_FLOAT_TO_FIXED (path->nodes[index_].x);
+  node->y = CLUTTER_FLOAT_TO_FIXED (path->nodes[index_].y);
+#else
+  *node = path->nodes[index_];
+#endif
+}
+
+/* Checks whether the closed polygon described by the nodes of @path
+ * is convex: every corner turns the same way and the outline goes
+ * around only once, so that it does not cross itself.
+ */
+static gboolean
+_cogl_path_check_convex (CoglPath *path)
+{
+  CoglFixedVec2 a, b, d, prev = { 0, 0 };
+  gboolean has_prev = FALSE;
+  gint turn = 0;
+  gint x_dir = 0, y_dir = 0;
+  gint x_flips = 0, y_flips = 0;
+  guint n = path->nodes_size;
+  guint i;
+
+  if (n < 3)
+    return FALSE;
+
+  /* the first edge is visited twice, to check the corner where
+   * the path is closed
+   */
+  for (i = 0; i <= n; i++)
+    {
+      _cogl_path_get_node (path, i % n, &a);
+      _cogl_path_get_node (path, (i + 1) % n, &b);
+
+      d.x = b.x - a.x;
+      d.y = b.y - a.y;
+
+      if (d.x == 0 && d.y == 0)
+        continue;
+
+      if (has_prev)
+        {
+          gint64 cross = (gint64) prev.x * d.y - (gint64) prev.y * d.x;
+
+          if (cross != 0)
+            {
+              gint this_turn = cross > 0 ? 1 : -1;
+
+              if (turn == 0)
+                turn = this_turn;
+              else if (this_turn != turn)
+                return FALSE;
+            }
+          else if ((gint64) prev.x * d.x + (gint64) prev.y * d.y < 0)
+            {
+              /* the outline goes back on itself */
+              return FALSE;
+            }
+        }
+
+      /* a convex outline changes its horizontal and vertical
+       * direction at most twice each
+       */
+      if (d.x != 0)
+        {
+          gint dir = d.x > 0 ? 1 : -1;
+
+          if (x_dir != 0 && dir != x_dir)
+            x_flips++;
+          x_dir = dir;
+        }
+
+      if (d.y != 0)
+        {
+          gint dir = d.y > 0 ? 1 : -1;
+
+          if (y_dir != 0 && dir != y_dir)
+            y_flips++;
+          y_dir = dir;
+        }
+
+      if (x_flips > 2 || y_flips > 2)
+        return FALSE;
+
+      prev = d;
+      has_prev = TRUE;
+    }
+
+  return turn != 0;
+}
+
+static void
+_cogl_path_fill (CoglPath *path)
+{
+  if (path->nodes_size == 0)
+    return;
+
+  if (!path->convex_valid)
+    {
+      path->is_convex = _cogl_path_check_convex (path);
+      path->convex_valid = TRUE;
+    }
+
+  _cogl_path_fill_nodes (path);
+}
+
+static void
+_cogl_path_free (CoglPath *path)
+{
+  g_free (path->nodes);
+  g_free (path);
+}
+
 void
 cogl_path_fill (void)
 {
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
   
-  if (ctx->path_nodes_size == 0)
-    return;
-  
-  _cogl_path_fill_nodes();
+  _cogl_path_fill (&ctx->path);
 }
 
 void
@@ -85,10 +212,58 @@ cogl_path_stroke (void)
 {
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
   
-  if (ctx->path_nodes_size == 0)
+  if (ctx->path.nodes_size == 0)
     return;
   
-  _cogl_path_stroke_nodes();
+  _cogl_path_stroke_nodes (&ctx->path);
+}
+
+CoglHandle
+cogl_path_copy (void)
+{
+  CoglPath *path;
+
+  _COGL_GET_CONTEXT (ctx, COGL_INVALID_HANDLE);
+
+  path = g_new0 (CoglPath, 1);
+  path->ref_count = 1;
+  COGL_HANDLE_DEBUG_NEW (path, path);
+
+  path->nodes_size = ctx->path.nodes_size;
+  path->nodes_cap = ctx->path.nodes_size;
+  path->nodes = g_memdup (ctx->path.nodes,
+                          ctx->path.nodes_size * sizeof (CoglPathNode));
+  path->nodes_min = ctx->path.nodes_min;
+  path->nodes_max = ctx->path.nodes_max;
+  path->convex_valid = ctx->path.convex_valid;
+  path->is_convex = ctx->path.is_convex;
+
+  return _cogl_path_handle_new (path);
+}
+
+void
+cogl_path_fill_retained (CoglHandle handle)
+{
+  if (!cogl_is_path (handle))
+    return;
+
+  _cogl_path_fill (_cogl_path_pointer_from_handle (handle));
+}
+
+void
+cogl_path_stroke_retained (CoglHandle handle)
+{
+  CoglPath *path;
+
+  if (!cogl_is_path (handle))
+    return;
+
+  path = _cogl_path_pointer_from_handle (handle);
+
+  if (path->nodes_size == 0)
+    return;
+
+  _cogl_path_stroke_nodes (path);
 }
 
 void
@@ -102,8 +277,8 @@ cogl_path_move_to (ClutterFixed x,
  /* at the moment, a move_to is an implicit instruction to create
   * a new path.
   */ 
-  _cogl_path_clear_nodes ();
-  _cogl_path_add_node (x, y);
+  ctx->path.nodes_size = 0;
+  _cogl_path_add_node (&ctx->path, x, y);
   
   ctx->path_start.x = x;
   ctx->path_start.y = y;
@@ -127,7 +302,7 @@ cogl_path_line_to (ClutterFixed x,
 {
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
   
-  _cogl_path_add_node (x, y);
+  _cogl_path_add_node (&ctx->path, x, y);
   
   ctx->path_pen.x = x;
   ctx->path_pen.y = y;
@@ -148,7 +323,7 @@ cogl_path_close (void)
 {
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
   
-  _cogl_path_add_node (ctx->path_start.x, ctx->path_start.y);
+  _cogl_path_add_node (&ctx->path, ctx->path_start.x, ctx->path_start.y);
   ctx->path_pen = ctx->path_start;
 }
 
@@ -382,6 +557,8 @@ _cogl_path_bezier3_sub (CoglBezCubic *cubic)
   CoglFixedVec2  c4;
   CoglFixedVec2  c5;
   gint           cindex;
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
   
   /* Put first curve on stack */
   cubics[0] = *cubic;
@@ -420,7 +597,7 @@ _cogl_path_bezier3_sub (CoglBezCubic *cubic)
 	{
 	  /* Add subdivision point (skip last) */
 	  if (cindex == 0) return;
-	  _cogl_path_add_node (c->p4.x, c->p4.y);
+	  _cogl_path_add_node (&ctx->path, c->p4.x, c->p4.y);
 	  --cindex; continue;
 	}
       
@@ -482,7 +659,7 @@ cogl_path_curve_to (ClutterFixed x1,
   _cogl_path_bezier3_sub (&cubic);
 
   /* Add last point */
-  _cogl_path_add_node (cubic.p4.x, cubic.p4.y);
+  _cogl_path_add_node (&ctx->path, cubic.p4.x, cubic.p4.y);
   ctx->path_pen = cubic.p4;
 }
 
@@ -523,6 +700,8 @@ _cogl_path_bezier2_sub (CoglBezQuad *quad)
   CoglFixedVec2   c2;
   CoglFixedVec2   c3;
   gint            qindex;
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
   
   /* Put first curve on stack */
   quads[0] = *quad;
@@ -549,7 +728,7 @@ _cogl_path_bezier2_sub (CoglBezQuad *quad)
 	{
 	  /* Add subdivision point (skip last) */
 	  if (qindex == 0) return;
-	  _cogl_path_add_node (q->p3.x, q->p3.y);
+	  _cogl_path_add_node (&ctx->path, q->p3.x, q->p3.y);
 	  --qindex; continue;
 	}
       
@@ -597,7 +776,7 @@ cogl_path_curve2_to (ClutterFixed x1,
   _cogl_path_bezier2_sub (&quad);
   
   /* Add last point */
-  _cogl_path_add_node (quad.p3.x, quad.p3.y);
+  _cogl_path_add_node (&ctx->path, quad.p3.x, quad.p3.y);
   ctx->path_pen = quad.p3;
 }
 
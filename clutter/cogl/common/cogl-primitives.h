@@ -60,4 +60,41 @@ struct _CoglBezCubic
   CoglFixedVec2 p4;
 };
 
+/* the nodes of a path are stored in the format used to draw them */
+#ifdef CLUTTER_COGL_HAS_GL
+typedef CoglFloatVec2 CoglPathNode;
+#else
+typedef CoglFixedVec2 CoglPathNode;
+#endif
+
+typedef struct _CoglPath         CoglPath;
+
+struct _CoglPath
+{
+  guint          ref_count;
+
+  /* the flattened geometry of the path */
+  CoglPathNode  *nodes;
+  guint          nodes_cap;
+  guint          nodes_size;
+  CoglFixedVec2  nodes_min;
+  CoglFixedVec2  nodes_max;
+
+  /* whether the path is a convex polygon, which can be filled
+   * without using the stencil buffer; computed on the first fill
+   */
+  guint          convex_valid : 1;
+  guint          is_convex    : 1;
+};
+
+CoglPath *_cogl_path_pointer_from_handle (CoglHandle handle);
+
+/* these are defined in the particular backend (float in GL vs fixed
+   in GL ES) */
+void _cogl_path_add_node     (CoglPath     *path,
+                              ClutterFixed  x,
+                              ClutterFixed  y);
+void _cogl_path_fill_nodes   (CoglPath     *path);
+void _cogl_path_stroke_nodes (CoglPath     *path);
+
 #endif /* __COGL_PRIMITIVES_H */
@@ -32,6 +32,12 @@
 #include "cogl-util.h"
 #include <string.h>
 
+#if defined (__SSE__)
+#include <xmmintrin.h>
+#elif defined (__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 /**
  * cogl_util_next_p2:
  * @a: Value to get the next power
@@ -216,6 +222,172 @@ ClutterVertex cogl_util_unproject_f(   float mtx[16],
   return res_vtx;
 }
 
+/**
+ * cogl_util_project_boxes:
+ * @mtx: modelview matrix
+ * @mtx_p: projection matrix
+ * @viewport: the viewport, as x, y, width and height
+ * @boxes: @n_boxes boxes, each given as x1, y1, x2 and y2 in the plane z = 0
+ * @n_boxes: number of boxes
+ * @out: return location for 12 floats per box
+ *
+ * Projects the corners of many boxes at once. For each box @out receives
+ * the window x of its corners (x1, y1), (x2, y1), (x1, y2) and (x2, y2),
+ * followed by their window y and then their window z. Like
+ * cogl_util_unproject(), the window y grows upwards as in GL.
+ *
+ * The two matrices are only multiplied once, and the four corners of a
+ * box are transformed in parallel where SSE or NEON is available.
+ */
+void
+cogl_util_project_boxes (const float  mtx[16],
+                         const float  mtx_p[16],
+                         const float  viewport[4],
+                         const float *boxes,
+                         guint        n_boxes,
+                         float       *out)
+{
+  float m[16];
+  float hx, hy, ox, oy;
+  guint i;
+  gint row, col;
+
+#define M(m,row,col)  (m)[(col) * 4 + (row)]
+
+  for (row = 0; row < 4; row++)
+    for (col = 0; col < 4; col++)
+      M (m, row, col) = M (mtx_p, row, 0) * M (mtx, 0, col)
+                      + M (mtx_p, row, 1) * M (mtx, 1, col)
+                      + M (mtx_p, row, 2) * M (mtx, 2, col)
+                      + M (mtx_p, row, 3) * M (mtx, 3, col);
+
+  /* the MTX_GL_SCALE_*_F macros folded into a multiply and an add;
+   * z is scaled like x, as cogl_util_unproject() does
+   */
+  hx = viewport[2] / 2;
+  hy = viewport[3] / 2;
+  ox = viewport[0] + hx;
+  oy = viewport[1] + hy;
+
+#if defined (__SSE__)
+  {
+    const __m128 m00 = _mm_set1_ps (M (m, 0, 0));
+    const __m128 m01 = _mm_set1_ps (M (m, 0, 1));
+    const __m128 m03 = _mm_set1_ps (M (m, 0, 3));
+    const __m128 m10 = _mm_set1_ps (M (m, 1, 0));
+    const __m128 m11 = _mm_set1_ps (M (m, 1, 1));
+    const __m128 m13 = _mm_set1_ps (M (m, 1, 3));
+    const __m128 m20 = _mm_set1_ps (M (m, 2, 0));
+    const __m128 m21 = _mm_set1_ps (M (m, 2, 1));
+    const __m128 m23 = _mm_set1_ps (M (m, 2, 3));
+    const __m128 m30 = _mm_set1_ps (M (m, 3, 0));
+    const __m128 m31 = _mm_set1_ps (M (m, 3, 1));
+    const __m128 m33 = _mm_set1_ps (M (m, 3, 3));
+    const __m128 vhx = _mm_set1_ps (hx);
+    const __m128 vhy = _mm_set1_ps (hy);
+    const __m128 vox = _mm_set1_ps (ox);
+    const __m128 voy = _mm_set1_ps (oy);
+    const __m128 zero = _mm_setzero_ps ();
+    const __m128 tiny = _mm_set1_ps (FLT_MIN);
+    const __m128 one = _mm_set1_ps (1.0f);
+
+    for (i = 0; i < n_boxes; i++, boxes += 4, out += 12)
+      {
+        /* _mm_set_ps takes the lanes in reverse order */
+        __m128 x = _mm_set_ps (boxes[2], boxes[0], boxes[2], boxes[0]);
+        __m128 y = _mm_set_ps (boxes[3], boxes[3], boxes[1], boxes[1]);
+        __m128 cx, cy, cz, cw, is_zero, inv;
+
+        cx = _mm_add_ps (_mm_add_ps (_mm_mul_ps (m00, x),
+                                     _mm_mul_ps (m01, y)), m03);
+        cy = _mm_add_ps (_mm_add_ps (_mm_mul_ps (m10, x),
+                                     _mm_mul_ps (m11, y)), m13);
+        cz = _mm_add_ps (_mm_add_ps (_mm_mul_ps (m20, x),
+                                     _mm_mul_ps (m21, y)), m23);
+        cw = _mm_add_ps (_mm_add_ps (_mm_mul_ps (m30, x),
+                                     _mm_mul_ps (m31, y)), m33);
+
+        is_zero = _mm_cmpeq_ps (cw, zero);
+        cw = _mm_or_ps (_mm_andnot_ps (is_zero, cw),
+                        _mm_and_ps (is_zero, tiny));
+        inv = _mm_div_ps (one, cw);
+
+        _mm_storeu_ps (out + 0,
+                       _mm_add_ps (_mm_mul_ps (_mm_mul_ps (cx, inv), vhx),
+                                   vox));
+        _mm_storeu_ps (out + 4,
+                       _mm_add_ps (_mm_mul_ps (_mm_mul_ps (cy, inv), vhy),
+                                   voy));
+        _mm_storeu_ps (out + 8,
+                       _mm_add_ps (_mm_mul_ps (_mm_mul_ps (cz, inv), vhx),
+                                   vox));
+      }
+  }
+#elif defined (__ARM_NEON__)
+  {
+    const float32x4_t m03 = vdupq_n_f32 (M (m, 0, 3));
+    const float32x4_t m13 = vdupq_n_f32 (M (m, 1, 3));
+    const float32x4_t m23 = vdupq_n_f32 (M (m, 2, 3));
+    const float32x4_t m33 = vdupq_n_f32 (M (m, 3, 3));
+    const float32x4_t vox = vdupq_n_f32 (ox);
+    const float32x4_t voy = vdupq_n_f32 (oy);
+    const float32x4_t zero = vdupq_n_f32 (0.0f);
+    const float32x4_t tiny = vdupq_n_f32 (FLT_MIN);
+
+    for (i = 0; i < n_boxes; i++, boxes += 4, out += 12)
+      {
+        const float xs[4] = { boxes[0], boxes[2], boxes[0], boxes[2] };
+        const float ys[4] = { boxes[1], boxes[1], boxes[3], boxes[3] };
+        float32x4_t x = vld1q_f32 (xs);
+        float32x4_t y = vld1q_f32 (ys);
+        float32x4_t cx, cy, cz, cw, inv;
+
+        cx = vmlaq_n_f32 (vmlaq_n_f32 (m03, x, M (m, 0, 0)), y, M (m, 0, 1));
+        cy = vmlaq_n_f32 (vmlaq_n_f32 (m13, x, M (m, 1, 0)), y, M (m, 1, 1));
+        cz = vmlaq_n_f32 (vmlaq_n_f32 (m23, x, M (m, 2, 0)), y, M (m, 2, 1));
+        cw = vmlaq_n_f32 (vmlaq_n_f32 (m33, x, M (m, 3, 0)), y, M (m, 3, 1));
+
+        cw = vbslq_f32 (vceqq_f32 (cw, zero), tiny, cw);
+
+        /* the estimate is only good to 8 bits, so refine it twice */
+        inv = vrecpeq_f32 (cw);
+        inv = vmulq_f32 (vrecpsq_f32 (cw, inv), inv);
+        inv = vmulq_f32 (vrecpsq_f32 (cw, inv), inv);
+
+        vst1q_f32 (out + 0, vmlaq_n_f32 (vox, vmulq_f32 (cx, inv), hx));
+        vst1q_f32 (out + 4, vmlaq_n_f32 (voy, vmulq_f32 (cy, inv), hy));
+        vst1q_f32 (out + 8, vmlaq_n_f32 (vox, vmulq_f32 (cz, inv), hx));
+      }
+  }
+#else
+  for (i = 0; i < n_boxes; i++, boxes += 4, out += 12)
+    {
+      gint corner;
+
+      for (corner = 0; corner < 4; corner++)
+        {
+          float x = boxes[(corner & 1) ? 2 : 0];
+          float y = boxes[(corner & 2) ? 3 : 1];
+          float w, inv;
+
+          w = M (m, 3, 0) * x + M (m, 3, 1) * y + M (m, 3, 3);
+          if (w == 0)
+            w = FLT_MIN;
+          inv = 1.0f / w;
+
+          out[corner + 0] =
+            (M (m, 0, 0) * x + M (m, 0, 1) * y + M (m, 0, 3)) * inv * hx + ox;
+          out[corner + 4] =
+            (M (m, 1, 0) * x + M (m, 1, 1) * y + M (m, 1, 3)) * inv * hy + oy;
+          out[corner + 8] =
+            (M (m, 2, 0) * x + M (m, 2, 1) * y + M (m, 2, 3)) * inv * hx + ox;
+        }
+    }
+#endif
+
+#undef M
+}
+
 gboolean
 cogl_check_extension (const gchar *name, const gchar *ext)
 {
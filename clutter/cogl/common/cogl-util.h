@@ -35,6 +35,7 @@
 #define MTX_GL_SCALE_Z(z,w,v1,v2) (MTX_GL_SCALE_X ((z), (w), (v1), (v2)))
 
 #define MTX_GL_SCALE_X_F(x,w,v1,v2) ((((((x)/(w)) + 1) / 2) * (v1)) + (v2))
+#define MTX_GL_SCALE_Y_F(y,w,v1,v2) ((v1) - (((((y)/(w)) + 1) / 2) * (v1)) + (v2))
 #define MTX_GL_SCALE_Y2_F(y,w,v1,v2) ((((((y)/(w)) + 1) / 2) * (v1)) + (v2))
 #define MTX_GL_SCALE_Z_F(z,w,v1,v2) (MTX_GL_SCALE_X_F ((z), (w), (v1), (v2)))
 
@@ -66,6 +67,14 @@ ClutterVertex cogl_util_unproject_f( float mtx[16],
                                      ClutterFixed viewport[4],
                                      ClutterVertex obj_coord);
 
+void
+cogl_util_project_boxes (const float  mtx[16],
+                         const float  mtx_p[16],
+                         const float  viewport[4],
+                         const float *boxes,
+                         guint        n_boxes,
+                         float       *out);
+
 gboolean
 cogl_check_extension (const gchar *name, const gchar *ext);
 
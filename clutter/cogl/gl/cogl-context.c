@@ -52,11 +52,12 @@ cogl_create_context ()
   _context->enable_flags = 0;
   _context->color_alpha = 255;
   
-  _context->path_nodes = NULL;
-  _context->path_nodes_cap = 0;
-  _context->path_nodes_size = 0;
+  memset (&_context->path, 0, sizeof (CoglPath));
+  _context->path_handles = NULL;
+  _context->rect_vertices = NULL;
   
   _context->texture_handles = NULL;
+  _context->texture_rect_vertices = NULL;
   
   _context->fbo_handles = NULL;
   _context->draw_buffer = COGL_WINDOW_BUFFER;
@@ -92,6 +93,17 @@ cogl_create_context ()
   _context->pf_glGetInfoLogARB = NULL;
   _context->pf_glGetObjectParameterivARB = NULL;
   _context->pf_glUniform1fARB = NULL;
+  _context->pf_glUniform1fvARB = NULL;
+  _context->pf_glUniform2fvARB = NULL;
+  _context->pf_glUniform3fvARB = NULL;
+  _context->pf_glUniform4fvARB = NULL;
+  _context->pf_glUniform1ivARB = NULL;
+  _context->pf_glUniform2ivARB = NULL;
+  _context->pf_glUniform3ivARB = NULL;
+  _context->pf_glUniform4ivARB = NULL;
+  _context->pf_glUniformMatrix2fvARB = NULL;
+  _context->pf_glUniformMatrix3fvARB = NULL;
+  _context->pf_glUniformMatrix4fvARB = NULL;
   
   /* Init OpenGL state */
   GE( glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE) );
@@ -108,8 +120,16 @@ cogl_destroy_context ()
   if (_context == NULL)
     return;
 
+  g_free (_context->path.nodes);
+  if (_context->path_handles)
+    g_array_free (_context->path_handles, TRUE);
+  if (_context->rect_vertices)
+    g_array_free (_context->rect_vertices, TRUE);
+
   if (_context->texture_handles)
     g_array_free (_context->texture_handles, TRUE);
+  if (_context->texture_rect_vertices)
+    g_array_free (_context->texture_rect_vertices, TRUE);
   if (_context->fbo_handles)
     g_array_free (_context->fbo_handles, TRUE);
   if (_context->shader_handles)
@@ -44,17 +44,16 @@ typedef struct
   /* Primitives */
   CoglFixedVec2     path_start;
   CoglFixedVec2     path_pen;
-  CoglFloatVec2    *path_nodes;
-  guint             path_nodes_cap;
-  guint             path_nodes_size;
-  CoglFixedVec2     path_nodes_min;
-  CoglFixedVec2     path_nodes_max;
+  CoglPath          path;
+  GArray           *path_handles;
+  GArray           *rect_vertices;
 
   /* Cache of inverse projection matrix */
   GLfloat           inverse_projection[16];
   
   /* Textures */
   GArray           *texture_handles;
+  GArray           *texture_rect_vertices;
   
   /* Framebuffer objects */
   GArray           *fbo_handles;
@@ -92,6 +91,17 @@ typedef struct
   COGL_PFNGLGETINFOLOGARBPROC                      pf_glGetInfoLogARB;
   COGL_PFNGLGETOBJECTPARAMETERIVARBPROC            pf_glGetObjectParameterivARB;
   COGL_PFNGLUNIFORM1FARBPROC                       pf_glUniform1fARB;
+  COGL_PFNGLUNIFORM1FVARBPROC                      pf_glUniform1fvARB;
+  COGL_PFNGLUNIFORM2FVARBPROC                      pf_glUniform2fvARB;
+  COGL_PFNGLUNIFORM3FVARBPROC                      pf_glUniform3fvARB;
+  COGL_PFNGLUNIFORM4FVARBPROC                      pf_glUniform4fvARB;
+  COGL_PFNGLUNIFORM1IVARBPROC                      pf_glUniform1ivARB;
+  COGL_PFNGLUNIFORM2IVARBPROC                      pf_glUniform2ivARB;
+  COGL_PFNGLUNIFORM3IVARBPROC                      pf_glUniform3ivARB;
+  COGL_PFNGLUNIFORM4IVARBPROC                      pf_glUniform4ivARB;
+  COGL_PFNGLUNIFORMMATRIX2FVARBPROC                pf_glUniformMatrix2fvARB;
+  COGL_PFNGLUNIFORMMATRIX3FVARBPROC                pf_glUniformMatrix3fvARB;
+  COGL_PFNGLUNIFORMMATRIX4FVARBPROC                pf_glUniformMatrix4fvARB;
   
 } CoglContext;
 
@@ -69,59 +69,104 @@ _cogl_rectanglex (ClutterFixed x,
 	       CLUTTER_FIXED_TO_FLOAT (y + height)) );
 }
 
+typedef struct _CoglColoredVertex
+{
+  GLfloat v[2];
+  GLubyte c[4];
+} CoglColoredVertex;
+
 void
-_cogl_path_clear_nodes ()
+_cogl_rectangles_with_color (const CoglColoredRectangle *rects,
+                             guint                       n_rects)
 {
+  CoglColoredVertex *p;
+  gulong enable_flags = COGL_ENABLE_VERTEX_ARRAY | COGL_ENABLE_COLOR_ARRAY;
+  guint i;
+
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
-  
-  if (ctx->path_nodes)
-    g_free(ctx->path_nodes);
-  
-  ctx->path_nodes = (CoglFloatVec2*) g_malloc (2 * sizeof(CoglFloatVec2));
-  ctx->path_nodes_size = 0;
-  ctx->path_nodes_cap = 2;
+
+  if (ctx->rect_vertices == NULL)
+    ctx->rect_vertices = g_array_new (FALSE, FALSE,
+                                      sizeof (CoglColoredVertex));
+
+  /* two triangles per rectangle, so that they can all go in one draw */
+  g_array_set_size (ctx->rect_vertices, n_rects * 6);
+  p = (CoglColoredVertex *) ctx->rect_vertices->data;
+
+  for (i = 0; i < n_rects; i++)
+    {
+      const CoglColoredRectangle *rect = &rects[i];
+      GLfloat x1 = CLUTTER_FIXED_TO_FLOAT (rect->x);
+      GLfloat y1 = CLUTTER_FIXED_TO_FLOAT (rect->y);
+      GLfloat x2 = CLUTTER_FIXED_TO_FLOAT (rect->x + rect->width);
+      GLfloat y2 = CLUTTER_FIXED_TO_FLOAT (rect->y + rect->height);
+      GLfloat corners[6][2] = {
+        { x1, y1 }, { x2, y1 }, { x1, y2 },
+        { x1, y2 }, { x2, y1 }, { x2, y2 }
+      };
+      gint j;
+
+      if (rect->color.alpha < 255)
+        enable_flags |= COGL_ENABLE_BLEND;
+
+      for (j = 0; j < 6; j++, p++)
+        {
+          p->v[0] = corners[j][0];
+          p->v[1] = corners[j][1];
+          p->c[0] = rect->color.red;
+          p->c[1] = rect->color.green;
+          p->c[2] = rect->color.blue;
+          p->c[3] = rect->color.alpha;
+        }
+    }
+
+  p = (CoglColoredVertex *) ctx->rect_vertices->data;
+
+  cogl_enable (enable_flags);
+
+  GE( glVertexPointer (2, GL_FLOAT, sizeof (CoglColoredVertex), p->v) );
+  GE( glColorPointer (4, GL_UNSIGNED_BYTE, sizeof (CoglColoredVertex), p->c) );
+  GE( glDrawArrays (GL_TRIANGLES, 0, n_rects * 6) );
+
+  /* The current color is undefined after drawing with a color array;
+     set the last one so that the cache of the alpha value will work
+     properly */
+  cogl_color (&rects[n_rects - 1].color);
 }
 
 void
-_cogl_path_add_node (ClutterFixed x,
-		     ClutterFixed y)
+_cogl_path_add_node (CoglPath     *path,
+                     ClutterFixed  x,
+		     ClutterFixed  y)
 {
-  CoglFloatVec2   *new_nodes = NULL;
-  
-  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
-  
-  if (ctx->path_nodes_size == ctx->path_nodes_cap)
+  if (path->nodes_size == path->nodes_cap)
     {
-      new_nodes = g_realloc (ctx->path_nodes,
-			     2 * ctx->path_nodes_cap
-			     * sizeof (CoglFloatVec2));
-      
-      if (new_nodes == NULL) return;
-
-      ctx->path_nodes = new_nodes;
-      ctx->path_nodes_cap *= 2;
+      path->nodes_cap = MAX (2 * path->nodes_cap, 32);
+      path->nodes = g_renew (CoglFloatVec2, path->nodes, path->nodes_cap);
     }
   
-  ctx->path_nodes [ctx->path_nodes_size] .x = CLUTTER_FIXED_TO_FLOAT (x);
-  ctx->path_nodes [ctx->path_nodes_size] .y = CLUTTER_FIXED_TO_FLOAT (y);
-  ctx->path_nodes_size++;
+  path->nodes [path->nodes_size] .x = CLUTTER_FIXED_TO_FLOAT (x);
+  path->nodes [path->nodes_size] .y = CLUTTER_FIXED_TO_FLOAT (y);
+  path->nodes_size++;
     
-  if (ctx->path_nodes_size == 1)
+  if (path->nodes_size == 1)
     {
-      ctx->path_nodes_min.x = ctx->path_nodes_max.x = x;
-      ctx->path_nodes_min.y = ctx->path_nodes_max.y = y;
+      path->nodes_min.x = path->nodes_max.x = x;
+      path->nodes_min.y = path->nodes_max.y = y;
     }
   else
     {
-      if (x < ctx->path_nodes_min.x) ctx->path_nodes_min.x = x;
-      if (x > ctx->path_nodes_max.x) ctx->path_nodes_max.x = x;
-      if (y < ctx->path_nodes_min.y) ctx->path_nodes_min.y = y;
-      if (y > ctx->path_nodes_max.y) ctx->path_nodes_max.y = y;
+      if (x < path->nodes_min.x) path->nodes_min.x = x;
+      if (x > path->nodes_max.x) path->nodes_max.x = x;
+      if (y < path->nodes_min.y) path->nodes_min.y = y;
+      if (y > path->nodes_max.y) path->nodes_max.y = y;
     }
+
+  path->convex_valid = FALSE;
 }
 
 void
-_cogl_path_stroke_nodes ()
+_cogl_path_stroke_nodes (CoglPath *path)
 {
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
   
@@ -129,12 +174,12 @@ _cogl_path_stroke_nodes ()
 	       | (ctx->color_alpha < 255
 		  ? COGL_ENABLE_BLEND : 0));
   
-  GE( glVertexPointer (2, GL_FLOAT, 0, ctx->path_nodes) );
-  GE( glDrawArrays (GL_LINE_STRIP, 0, ctx->path_nodes_size) );
+  GE( glVertexPointer (2, GL_FLOAT, 0, path->nodes) );
+  GE( glDrawArrays (GL_LINE_STRIP, 0, path->nodes_size) );
 }
 
 void
-_cogl_path_fill_nodes ()
+_cogl_path_fill_nodes (CoglPath *path)
 {
   guint bounds_x;
   guint bounds_y;
@@ -143,19 +188,40 @@ _cogl_path_fill_nodes ()
   
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
   
-  GE( glClear (GL_STENCIL_BUFFER_BIT) );
+  cogl_enable (COGL_ENABLE_VERTEX_ARRAY
+	       | (ctx->color_alpha < 255 ? COGL_ENABLE_BLEND : 0));
+  
+  GE( glVertexPointer (2, GL_FLOAT, 0, path->nodes) );
 
+  /* The triangle fan of a convex polygon covers every pixel exactly
+     once, so it can be drawn directly */
+  if (path->is_convex)
+    {
+      GE( glDrawArrays (GL_TRIANGLE_FAN, 0, path->nodes_size) );
+      return;
+    }
+
+  bounds_x = CLUTTER_FIXED_FLOOR (path->nodes_min.x);
+  bounds_y = CLUTTER_FIXED_FLOOR (path->nodes_min.y);
+  bounds_w = CLUTTER_FIXED_CEIL (path->nodes_max.x) - bounds_x;
+  bounds_h = CLUTTER_FIXED_CEIL (path->nodes_max.y) - bounds_y;
+  
   GE( glEnable (GL_STENCIL_TEST) );
+  GE( glStencilMask (1) );
+
+  /* Only clear the stencil buffer under the bounding box of the
+     path; the rest of it is never looked at */
   GE( glStencilFunc (GL_NEVER, 0x0, 0x1) );
+  GE( glStencilOp (GL_ZERO, GL_ZERO, GL_ZERO) );
+
+  cogl_rectangle (bounds_x, bounds_y, bounds_w, bounds_h);
+
   GE( glStencilOp (GL_INVERT, GL_INVERT, GL_INVERT) );
 
-  GE( glStencilMask (1) );
-  
   cogl_enable (COGL_ENABLE_VERTEX_ARRAY
 	       | (ctx->color_alpha < 255 ? COGL_ENABLE_BLEND : 0));
   
-  GE( glVertexPointer (2, GL_FLOAT, 0, ctx->path_nodes) );
-  GE( glDrawArrays (GL_TRIANGLE_FAN, 0, ctx->path_nodes_size) );
+  GE( glDrawArrays (GL_TRIANGLE_FAN, 0, path->nodes_size) );
   
   GE( glStencilMask (~(GLuint) 0) );
   
@@ -165,11 +231,6 @@ _cogl_path_fill_nodes ()
   GE( glStencilFunc (GL_EQUAL, 0x1, 0x1) );
   GE( glStencilOp (GL_KEEP, GL_KEEP, GL_KEEP) );
 
-  bounds_x = CLUTTER_FIXED_FLOOR (ctx->path_nodes_min.x);
-  bounds_y = CLUTTER_FIXED_FLOOR (ctx->path_nodes_min.y);
-  bounds_w = CLUTTER_FIXED_CEIL (ctx->path_nodes_max.x - ctx->path_nodes_min.x);
-  bounds_h = CLUTTER_FIXED_CEIL (ctx->path_nodes_max.y - ctx->path_nodes_min.y);
-  
   cogl_rectangle (bounds_x, bounds_y, bounds_w, bounds_h);
   
   /* Rebuild the stencil clip */
@@ -55,6 +55,11 @@ static void _cogl_texture_free (CoglTexture *tex);
 
 COGL_HANDLE_DEFINE (Texture, texture, texture_handles);
 
+/* Slicing a texture costs a bind and a separate draw per slice every
+ * time it is painted, so a texture may always waste up to this fraction
+ * of its size in each axis before it is split into several slices */
+#define COGL_TEXTURE_WASTE_RATIO 3
+
 struct _CoglSpanIter
 {
   gint              index;
@@ -501,6 +506,10 @@ _cogl_pot_slices_for_size (gint     size_to_fill,
   /* Fix invalid max_waste */
   if (max_waste < 0) max_waste = 0;
 
+  /* Scale the allowed waste with the texture so that common NPOT sizes
+     such as 800x480 fit in one slice instead of several */
+  max_waste = MAX (max_waste, size_to_fill / COGL_TEXTURE_WASTE_RATIO);
+
   while (TRUE)
     {
       /* Is the whole area covered? */
@@ -1449,6 +1458,57 @@ cogl_texture_get_max_waste (CoglHandle handle)
   return tex->max_waste;
 }
 
+guint
+cogl_texture_get_n_slices (CoglHandle handle)
+{
+  CoglTexture *tex;
+
+  if (!cogl_is_texture (handle))
+    return 0;
+
+  tex = _cogl_texture_pointer_from_handle (handle);
+
+  if (tex->slice_gl_handles == NULL)
+    return 0;
+
+  return tex->slice_gl_handles->len;
+}
+
+gsize
+cogl_texture_get_wasted_bytes (CoglHandle handle)
+{
+  CoglTexture      *tex;
+  CoglTexSliceSpan *span;
+  gsize             allocated_width = 0;
+  gsize             allocated_height = 0;
+  gint              i;
+
+  if (!cogl_is_texture (handle))
+    return 0;
+
+  tex = _cogl_texture_pointer_from_handle (handle);
+
+  if (tex->slice_x_spans == NULL || tex->slice_y_spans == NULL)
+    return 0;
+
+  /* The spans cover the bitmap plus the padding of each slice */
+  for (i = 0; i < tex->slice_x_spans->len; ++i)
+    {
+      span = &g_array_index (tex->slice_x_spans, CoglTexSliceSpan, i);
+      allocated_width += span->size;
+    }
+
+  for (i = 0; i < tex->slice_y_spans->len; ++i)
+    {
+      span = &g_array_index (tex->slice_y_spans, CoglTexSliceSpan, i);
+      allocated_height += span->size;
+    }
+
+  return (allocated_width * allocated_height
+	  - (gsize) tex->bitmap.width * tex->bitmap.height)
+    * _cogl_get_format_bpp (tex->bitmap.format);
+}
+
 gboolean
 cogl_texture_is_sliced (CoglHandle handle)
 {
@@ -1553,6 +1613,40 @@ cogl_texture_set_filters (CoglHandle handle,
     }
 }
 
+gboolean
+cogl_texture_set_auto_mipmap (CoglHandle handle,
+			      gboolean   auto_mipmap)
+{
+  CoglTexture *tex;
+  GLuint       gl_handle;
+  int          i;
+
+  if (!cogl_is_texture (handle))
+    return FALSE;
+
+  tex = _cogl_texture_pointer_from_handle (handle);
+
+  if (tex->auto_mipmap == auto_mipmap)
+    return TRUE;
+
+  tex->auto_mipmap = auto_mipmap;
+
+  /* Make sure slices were created */
+  if (tex->slice_gl_handles == NULL)
+    return TRUE;
+
+  /* The levels get built the next time level 0 changes */
+  for (i=0; i<tex->slice_gl_handles->len; ++i)
+    {
+      gl_handle = g_array_index (tex->slice_gl_handles, GLuint, i);
+      GE( glBindTexture (tex->gl_target, gl_handle) );
+      GE( glTexParameteri (tex->gl_target, GL_GENERATE_MIPMAP,
+			   auto_mipmap ? GL_TRUE : GL_FALSE) );
+    }
+
+  return TRUE;
+}
+
 gboolean
 cogl_texture_set_region (CoglHandle       handle,
 			 gint             src_x,
@@ -1892,6 +1986,47 @@ _cogl_texture_quad_sw (CoglTexture *tex,
     }
 }
 
+/* A texture can be repeated by the hardware when it is a single GL
+ * texture without any waste, i.e. it is POT or NPOT textures are
+ * supported; GL_REPEAT wraps around the whole GL texture */
+static gboolean
+_cogl_texture_can_hardware_repeat (CoglTexture *tex)
+{
+  CoglTexSliceSpan *x_span;
+  CoglTexSliceSpan *y_span;
+
+  if (tex->slice_gl_handles->len != 1 || tex->gl_target != GL_TEXTURE_2D)
+    return FALSE;
+
+  x_span = &g_array_index (tex->slice_x_spans, CoglTexSliceSpan, 0);
+  y_span = &g_array_index (tex->slice_y_spans, CoglTexSliceSpan, 0);
+
+  return x_span->waste == 0 && y_span->waste == 0;
+}
+
+static inline gboolean
+_cogl_texture_coords_repeat (ClutterFixed tx1,
+                             ClutterFixed ty1,
+                             ClutterFixed tx2,
+                             ClutterFixed ty2)
+{
+  return (MIN (tx1, tx2) < 0 || MAX (tx1, tx2) > CFX_ONE
+          || MIN (ty1, ty2) < 0 || MAX (ty1, ty2) > CFX_ONE);
+}
+
+/* Changes the wrap mode of the bound texture, if needed */
+static void
+_cogl_texture_set_wrap_mode (CoglTexture *tex,
+                             GLint        wrap_mode)
+{
+  if (tex->wrap_mode != wrap_mode)
+    {
+      GE( glTexParameteri (tex->gl_target, GL_TEXTURE_WRAP_S, wrap_mode) );
+      GE( glTexParameteri (tex->gl_target, GL_TEXTURE_WRAP_T, wrap_mode) );
+      tex->wrap_mode = wrap_mode;
+    }
+}
+
 static void
 _cogl_texture_quad_hw (CoglTexture *tex,
 		       ClutterFixed x1,
@@ -1929,6 +2064,14 @@ _cogl_texture_quad_hw (CoglTexture *tex,
   gl_handle = g_array_index (tex->slice_gl_handles, GLuint, 0);
   GE( glBindTexture (tex->gl_target, gl_handle) );
 
+  /* Let the hardware tile the texture, and go back to clamping once
+   * it is no longer repeated so that the edges don't bleed */
+  if (_cogl_texture_coords_repeat (tx1, ty1, tx2, ty2)
+      && _cogl_texture_can_hardware_repeat (tex))
+    _cogl_texture_set_wrap_mode (tex, GL_REPEAT);
+  else
+    _cogl_texture_set_wrap_mode (tex, GL_CLAMP_TO_EDGE);
+
   x_span = &g_array_index (tex->slice_x_spans, CoglTexSliceSpan, 0);
   y_span = &g_array_index (tex->slice_y_spans, CoglTexSliceSpan, 0);
 
@@ -2023,8 +2166,9 @@ cogl_texture_rectangle (CoglHandle   handle,
     }
 
   /* Pick tiling mode according to hw support */
-  if (cogl_features_available (COGL_FEATURE_TEXTURE_NPOT)
-      && tex->slice_gl_handles->len == 1)
+  if ((cogl_features_available (COGL_FEATURE_TEXTURE_NPOT)
+       && tex->slice_gl_handles->len == 1)
+      || _cogl_texture_can_hardware_repeat (tex))
     {
       _cogl_texture_quad_hw (tex, x1,y1, x2,y2, tx1,ty1, tx2,ty2);
     }
@@ -2043,6 +2187,131 @@ cogl_texture_rectangle (CoglHandle   handle,
     }
 }
 
+typedef struct _CoglTexRectVertex
+{
+  GLfloat v[2];
+  GLfloat t[2];
+} CoglTexRectVertex;
+
+void
+cogl_texture_multiple_rectangles (CoglHandle          handle,
+                                  const ClutterFixed *verts,
+                                  guint               n_rects)
+{
+  CoglTexture       *tex;
+  CoglTexSliceSpan  *x_span;
+  CoglTexSliceSpan  *y_span;
+  CoglTexRectVertex *p;
+  GLuint             gl_handle;
+  gboolean           repeat = FALSE;
+  gulong             enable_flags = (COGL_ENABLE_TEXTURE_2D
+                                     | COGL_ENABLE_VERTEX_ARRAY
+                                     | COGL_ENABLE_TEXCOORD_ARRAY);
+  guint              i;
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  /* Check if valid texture */
+  if (!cogl_is_texture (handle))
+    return;
+
+  tex = _cogl_texture_pointer_from_handle (handle);
+
+  /* Make sure we got stuff to draw */
+  if (tex->slice_gl_handles == NULL || tex->slice_gl_handles->len == 0)
+    return;
+
+  for (i = 0; i < n_rects; i++)
+    {
+      const ClutterFixed *v = verts + i * 8;
+
+      if (_cogl_texture_coords_repeat (v[4], v[5], v[6], v[7]))
+        repeat = TRUE;
+    }
+
+  /* A single draw needs a single GL texture, which the hardware can
+   * repeat if needed; otherwise draw the rectangles one by one */
+  if (tex->slice_gl_handles->len != 1
+      || tex->gl_target != GL_TEXTURE_2D
+      || (repeat && !_cogl_texture_can_hardware_repeat (tex)))
+    {
+      for (i = 0; i < n_rects; i++)
+        {
+          const ClutterFixed *v = verts + i * 8;
+
+          cogl_texture_rectangle (handle,
+                                  v[0], v[1], v[2], v[3],
+                                  v[4], v[5], v[6], v[7]);
+        }
+
+      return;
+    }
+
+  if (ctx->texture_rect_vertices == NULL)
+    ctx->texture_rect_vertices = g_array_new (FALSE, FALSE,
+                                              sizeof (CoglTexRectVertex));
+
+  /* two triangles per rectangle */
+  g_array_set_size (ctx->texture_rect_vertices, n_rects * 6);
+  p = (CoglTexRectVertex *) ctx->texture_rect_vertices->data;
+
+  x_span = &g_array_index (tex->slice_x_spans, CoglTexSliceSpan, 0);
+  y_span = &g_array_index (tex->slice_y_spans, CoglTexSliceSpan, 0);
+
+  for (i = 0; i < n_rects; i++)
+    {
+      const ClutterFixed *v = verts + i * 8;
+      ClutterFixed tx1, ty1, tx2, ty2;
+      ClutterFixed corners[6][4];
+      gint j;
+
+      /* Don't include the waste in the texture coordinates */
+      tx1 = v[4] * (x_span->size - x_span->waste) / x_span->size;
+      tx2 = v[6] * (x_span->size - x_span->waste) / x_span->size;
+      ty1 = v[5] * (y_span->size - y_span->waste) / y_span->size;
+      ty2 = v[7] * (y_span->size - y_span->waste) / y_span->size;
+
+#define CORNER(n,x,y,tx,ty) \
+      corners[n][0] = (x); corners[n][1] = (y); \
+      corners[n][2] = (tx); corners[n][3] = (ty)
+
+      CORNER (0, v[0], v[1], tx1, ty1);
+      CORNER (1, v[2], v[1], tx2, ty1);
+      CORNER (2, v[0], v[3], tx1, ty2);
+      CORNER (3, v[0], v[3], tx1, ty2);
+      CORNER (4, v[2], v[1], tx2, ty1);
+      CORNER (5, v[2], v[3], tx2, ty2);
+
+#undef CORNER
+
+      for (j = 0; j < 6; j++, p++)
+        {
+          p->v[0] = CLUTTER_FIXED_TO_FLOAT (corners[j][0]);
+          p->v[1] = CLUTTER_FIXED_TO_FLOAT (corners[j][1]);
+          p->t[0] = CLUTTER_FIXED_TO_FLOAT (corners[j][2]);
+          p->t[1] = CLUTTER_FIXED_TO_FLOAT (corners[j][3]);
+        }
+    }
+
+  p = (CoglTexRectVertex *) ctx->texture_rect_vertices->data;
+
+  /* Prepare GL state */
+  if (ctx->color_alpha < 255
+      || tex->bitmap.format & COGL_A_BIT)
+    enable_flags |= COGL_ENABLE_BLEND;
+
+  cogl_enable (enable_flags);
+
+  gl_handle = g_array_index (tex->slice_gl_handles, GLuint, 0);
+  GE( glBindTexture (tex->gl_target, gl_handle) );
+
+  _cogl_texture_set_wrap_mode (tex, repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE);
+
+  GE( glVertexPointer (2, GL_FLOAT, sizeof (CoglTexRectVertex), p->v) );
+  GE( glTexCoordPointer (2, GL_FLOAT, sizeof (CoglTexRectVertex), p->t) );
+  GE( glDrawArrays (GL_TRIANGLES, 0, n_rects * 6) );
+}
+
 void
 cogl_texture_polygon (CoglHandle         handle,
 		      guint              n_vertices,
@@ -303,6 +303,9 @@ cogl_enable (gulong flags)
 			   COGL_ENABLE_TEXCOORD_ARRAY,
 			   GL_TEXTURE_COORD_ARRAY);
 
+  cogl_toggle_client_flag (ctx, flags,
+			   COGL_ENABLE_COLOR_ARRAY,
+			   GL_COLOR_ARRAY);
 }
 
 gulong
@@ -722,10 +725,7 @@ cogl_perspective (ClutterFixed fovy,
 		  ClutterFixed zNear,
 		  ClutterFixed zFar)
 {
-  ClutterFixed xmax, ymax;
-  ClutterFixed x, y, c, d;
-  ClutterFixed fovy_rad_half = CLUTTER_FIXED_MUL (fovy, CFX_PI) / 360;
-
+  GLfloat x, y, c, d;
   GLfloat m[16];
 
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
@@ -740,24 +740,50 @@ cogl_perspective (ClutterFixed fovy,
    *
    * 1) xmin = -xmax => xmax + xmin == 0 && xmax - xmin == 2 * xmax
    * same true for y, hence: a == 0 && b == 0;
-   *
-   * 2) When working with small numbers, we are loosing significant
-   * precision, hence we use clutter_qmulx() here, not the fast macro.
    */
-  ymax = clutter_qmulx (zNear, CLUTTER_FIXED_DIV (clutter_sinx (fovy_rad_half),
-						  clutter_cosx (fovy_rad_half)));
-  xmax = clutter_qmulx (ymax, aspect);
+#ifdef CLUTTER_FLOAT_MATH
+  {
+    GLfloat near = CLUTTER_FIXED_TO_FLOAT (zNear);
+    GLfloat far  = CLUTTER_FIXED_TO_FLOAT (zFar);
+    GLfloat ymax, xmax;
+
+    ymax = near * tanf (CLUTTER_FIXED_TO_FLOAT (fovy) * G_PI / 360.0f);
+    xmax = ymax * CLUTTER_FIXED_TO_FLOAT (aspect);
 
-  x = CLUTTER_FIXED_DIV (zNear, xmax);
-  y = CLUTTER_FIXED_DIV (zNear, ymax);
-  c = CLUTTER_FIXED_DIV (-(zFar + zNear), ( zFar - zNear));
-  d = CLUTTER_FIXED_DIV (-(clutter_qmulx (2*zFar, zNear)), (zFar - zNear));
+    x = near / xmax;
+    y = near / ymax;
+    c = -(far + near) / (far - near);
+    d = -(2.0f * far * near) / (far - near);
+  }
+#else
+  {
+    ClutterFixed xmax, ymax;
+    ClutterFixed fovy_rad_half = CLUTTER_FIXED_MUL (fovy, CFX_PI) / 360;
+
+    /*
+     * 2) When working with small numbers, we are loosing significant
+     * precision, hence we use clutter_qmulx() here, not the fast macro.
+     */
+    ymax = clutter_qmulx (zNear,
+                          CLUTTER_FIXED_DIV (clutter_sinx (fovy_rad_half),
+                                             clutter_cosx (fovy_rad_half)));
+    xmax = clutter_qmulx (ymax, aspect);
+
+    x = CLUTTER_FIXED_TO_FLOAT (CLUTTER_FIXED_DIV (zNear, xmax));
+    y = CLUTTER_FIXED_TO_FLOAT (CLUTTER_FIXED_DIV (zNear, ymax));
+    c = CLUTTER_FIXED_TO_FLOAT (CLUTTER_FIXED_DIV (-(zFar + zNear),
+                                                   (zFar - zNear)));
+    d = CLUTTER_FIXED_TO_FLOAT (CLUTTER_FIXED_DIV (-(clutter_qmulx (2*zFar,
+                                                                    zNear)),
+                                                   (zFar - zNear)));
+  }
+#endif /* CLUTTER_FLOAT_MATH */
 
 #define M(row,col)  m[col*4+row]
-  M(0,0) = CLUTTER_FIXED_TO_FLOAT (x);
-  M(1,1) = CLUTTER_FIXED_TO_FLOAT (y);
-  M(2,2) = CLUTTER_FIXED_TO_FLOAT (c);
-  M(2,3) = CLUTTER_FIXED_TO_FLOAT (d);
+  M(0,0) = x;
+  M(1,1) = y;
+  M(2,2) = c;
+  M(2,3) = d;
   M(3,2) = -1.0F;
 
   GE( glMultMatrixf (m) );
@@ -768,11 +794,11 @@ cogl_perspective (ClutterFixed fovy,
   memset (ctx->inverse_projection, 0, sizeof (GLfloat) * 16);
 
 #define m ctx->inverse_projection
-  M(0, 0) = 1.0f / CLUTTER_FIXED_TO_FLOAT (x);
-  M(1, 1) = 1.0f / CLUTTER_FIXED_TO_FLOAT (y);
+  M(0, 0) = 1.0f / x;
+  M(1, 1) = 1.0f / y;
   M(2, 3) = -1.0f;
-  M(3, 2) = 1.0f / CLUTTER_FIXED_TO_FLOAT (d);
-  M(3, 3) = CLUTTER_FIXED_TO_FLOAT (c) / CLUTTER_FIXED_TO_FLOAT (d);
+  M(3, 2) = 1.0f / d;
+  M(3, 3) = c / d;
 #undef m
 #undef M
 }
@@ -940,7 +966,7 @@ _cogl_features_init ()
 #ifdef HAVE_CLUTTER_OSX
       if (really_enable_npot ())
 #endif
-        flags |= COGL_FEATURE_TEXTURE_NPOT;
+        flags |= COGL_FEATURE_TEXTURE_NPOT | COGL_FEATURE_TEXTURE_NPOT_BASIC;
     }
 
 #ifdef GL_YCBCR_MESA
@@ -1012,6 +1038,50 @@ _cogl_features_init ()
 	(COGL_PFNGLUNIFORM1FARBPROC)
 	cogl_get_proc_address ("glUniform1fARB");
 
+      ctx->pf_glUniform1fvARB =
+	(COGL_PFNGLUNIFORM1FVARBPROC)
+	cogl_get_proc_address ("glUniform1fvARB");
+
+      ctx->pf_glUniform2fvARB =
+	(COGL_PFNGLUNIFORM2FVARBPROC)
+	cogl_get_proc_address ("glUniform2fvARB");
+
+      ctx->pf_glUniform3fvARB =
+	(COGL_PFNGLUNIFORM3FVARBPROC)
+	cogl_get_proc_address ("glUniform3fvARB");
+
+      ctx->pf_glUniform4fvARB =
+	(COGL_PFNGLUNIFORM4FVARBPROC)
+	cogl_get_proc_address ("glUniform4fvARB");
+
+      ctx->pf_glUniform1ivARB =
+	(COGL_PFNGLUNIFORM1IVARBPROC)
+	cogl_get_proc_address ("glUniform1ivARB");
+
+      ctx->pf_glUniform2ivARB =
+	(COGL_PFNGLUNIFORM2IVARBPROC)
+	cogl_get_proc_address ("glUniform2ivARB");
+
+      ctx->pf_glUniform3ivARB =
+	(COGL_PFNGLUNIFORM3IVARBPROC)
+	cogl_get_proc_address ("glUniform3ivARB");
+
+      ctx->pf_glUniform4ivARB =
+	(COGL_PFNGLUNIFORM4IVARBPROC)
+	cogl_get_proc_address ("glUniform4ivARB");
+
+      ctx->pf_glUniformMatrix2fvARB =
+	(COGL_PFNGLUNIFORMMATRIX2FVARBPROC)
+	cogl_get_proc_address ("glUniformMatrix2fvARB");
+
+      ctx->pf_glUniformMatrix3fvARB =
+	(COGL_PFNGLUNIFORMMATRIX3FVARBPROC)
+	cogl_get_proc_address ("glUniformMatrix3fvARB");
+
+      ctx->pf_glUniformMatrix4fvARB =
+	(COGL_PFNGLUNIFORMMATRIX4FVARBPROC)
+	cogl_get_proc_address ("glUniformMatrix4fvARB");
+
       if (ctx->pf_glCreateProgramObjectARB    &&
 	  ctx->pf_glCreateShaderObjectARB     &&
 	  ctx->pf_glShaderSourceARB           &&
@@ -1023,7 +1093,18 @@ _cogl_features_init ()
 	  ctx->pf_glDeleteObjectARB           &&
 	  ctx->pf_glGetInfoLogARB             &&
 	  ctx->pf_glGetObjectParameterivARB   &&
-	  ctx->pf_glUniform1fARB)
+	  ctx->pf_glUniform1fARB              &&
+	  ctx->pf_glUniform1fvARB             &&
+	  ctx->pf_glUniform2fvARB             &&
+	  ctx->pf_glUniform3fvARB             &&
+	  ctx->pf_glUniform4fvARB             &&
+	  ctx->pf_glUniform1ivARB             &&
+	  ctx->pf_glUniform2ivARB             &&
+	  ctx->pf_glUniform3ivARB             &&
+	  ctx->pf_glUniform4ivARB             &&
+	  ctx->pf_glUniformMatrix2fvARB       &&
+	  ctx->pf_glUniformMatrix3fvARB       &&
+	  ctx->pf_glUniformMatrix4fvARB)
 	flags |= COGL_FEATURE_SHADERS_GLSL;
     }
 
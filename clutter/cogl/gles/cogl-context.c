@@ -51,15 +51,17 @@ cogl_create_context ()
   /* Init default values */
   _context->feature_flags = 0;
   _context->features_cached = FALSE;
+  _context->max_texture_size = 0;
   
   _context->enable_flags = 0;
   _context->color_alpha = 255;
   
-  _context->path_nodes = NULL;
-  _context->path_nodes_cap = 0;
-  _context->path_nodes_size = 0;
+  memset (&_context->path, 0, sizeof (CoglPath));
+  _context->path_handles = NULL;
+  _context->rect_vertices = NULL;
   
   _context->texture_handles = NULL;
+  _context->texture_rect_vertices = NULL;
   _context->texture_vertices_size = 0;
   _context->texture_vertices = NULL;
   
@@ -110,8 +112,16 @@ cogl_destroy_context ()
   if (_context->texture_vertices)
     g_free (_context->texture_vertices);
   
+  g_free (_context->path.nodes);
+  if (_context->path_handles)
+    g_array_free (_context->path_handles, TRUE);
+  if (_context->rect_vertices)
+    g_array_free (_context->rect_vertices, TRUE);
+
   if (_context->texture_handles)
     g_array_free (_context->texture_handles, TRUE);
+  if (_context->texture_rect_vertices)
+    g_array_free (_context->texture_rect_vertices, TRUE);
   if (_context->fbo_handles)
     g_array_free (_context->fbo_handles, TRUE);
   if (_context->shader_handles)
@@ -43,6 +43,7 @@ typedef struct
   CoglFeatureFlags     feature_flags;
   gboolean             features_cached;
   GLint                num_stencil_bits;
+  GLint                max_texture_size;
   
   /* Enable cache */
   gulong               enable_flags;
@@ -53,17 +54,16 @@ typedef struct
   /* Primitives */
   CoglFixedVec2        path_start;
   CoglFixedVec2        path_pen;
-  CoglFixedVec2       *path_nodes;
-  guint                path_nodes_cap;
-  guint                path_nodes_size;
-  CoglFixedVec2        path_nodes_min;
-  CoglFixedVec2        path_nodes_max;
+  CoglPath             path;
+  GArray              *path_handles;
+  GArray              *rect_vertices;
   
   /* Cache of inverse projection matrix */
   ClutterFixed         inverse_projection[16];
 
   /* Textures */
   GArray              *texture_handles;
+  GArray              *texture_rect_vertices;
   CoglTextureGLVertex *texture_vertices;
   gulong               texture_vertices_size;
   
@@ -881,6 +881,72 @@ cogl_wrap_glColorPointer (GLint size, GLenum type, GLsizei stride,
 			 GL_FALSE, stride, pointer);
 }
 
+static void
+cogl_gles2_wrapper_upload_boxed_value (GLint                 location,
+                                       const CoglBoxedValue *value)
+{
+  const GLfloat *float_value;
+  const GLint *int_value;
+
+  switch (value->type)
+    {
+    case COGL_BOXED_NONE:
+      break;
+
+    case COGL_BOXED_INT:
+      if (value->count == 1)
+        int_value = value->v.int_value;
+      else
+        int_value = value->v.int_array;
+
+      switch (value->size)
+        {
+        case 1: glUniform1iv (location, value->count, int_value); break;
+        case 2: glUniform2iv (location, value->count, int_value); break;
+        case 3: glUniform3iv (location, value->count, int_value); break;
+        case 4: glUniform4iv (location, value->count, int_value); break;
+        }
+      break;
+
+    case COGL_BOXED_FLOAT:
+      if (value->count == 1)
+        float_value = value->v.float_value;
+      else
+        float_value = value->v.float_array;
+
+      switch (value->size)
+        {
+        case 1: glUniform1fv (location, value->count, float_value); break;
+        case 2: glUniform2fv (location, value->count, float_value); break;
+        case 3: glUniform3fv (location, value->count, float_value); break;
+        case 4: glUniform4fv (location, value->count, float_value); break;
+        }
+      break;
+
+    case COGL_BOXED_MATRIX:
+      /* GLES 2 does not support transposing matrices when uploading,
+         cogl_program_uniform_matrix() has already done that for us */
+      if (value->count == 1)
+        float_value = value->v.matrix;
+      else
+        float_value = value->v.float_array;
+
+      switch (value->size)
+        {
+        case 2:
+          glUniformMatrix2fv (location, value->count, GL_FALSE, float_value);
+          break;
+        case 3:
+          glUniformMatrix3fv (location, value->count, GL_FALSE, float_value);
+          break;
+        case 4:
+          glUniformMatrix4fv (location, value->count, GL_FALSE, float_value);
+          break;
+        }
+      break;
+    }
+}
+
 void
 cogl_wrap_glDrawArrays (GLenum mode, GLint first, GLsizei count)
 {
@@ -977,8 +1043,9 @@ cogl_wrap_glDrawArrays (GLenum mode, GLint first, GLsizei count)
 		  program->custom_uniforms[i]
 		    = glGetUniformLocation (program->program, uniform_name);
 		if (program->custom_uniforms[i] >= 0)
-		  glUniform1f (program->custom_uniforms[i],
-			       w->custom_uniforms[i]);
+		  cogl_gles2_wrapper_upload_boxed_value
+                    (program->custom_uniforms[i],
+                     &user_program->custom_uniforms[i]);
 	      }
 	}
 
@@ -37,6 +37,7 @@ typedef struct _CoglGles2WrapperUniforms CoglGles2WrapperUniforms;
 typedef struct _CoglGles2WrapperSettings CoglGles2WrapperSettings;
 typedef struct _CoglGles2WrapperProgram  CoglGles2WrapperProgram;
 typedef struct _CoglGles2WrapperShader   CoglGles2WrapperShader;
+typedef struct _CoglBoxedValue           CoglBoxedValue;
 
 #define COGL_GLES2_NUM_CUSTOM_UNIFORMS    16
 #define COGL_GLES2_UNBOUND_CUSTOM_UNIFORM -2
@@ -60,6 +61,34 @@ enum
     COGL_GLES2_DIRTY_ALL              = (1 << 8) - 1
   };
 
+typedef enum
+  {
+    COGL_BOXED_NONE,
+    COGL_BOXED_INT,
+    COGL_BOXED_FLOAT,
+    COGL_BOXED_MATRIX
+  } CoglBoxedType;
+
+/* Value of a custom uniform as set through cogl_program_uniform_*();
+ * single values are stored inline, arrays of values are copied into
+ * a separately allocated block
+ */
+struct _CoglBoxedValue
+{
+  CoglBoxedType type;
+  int size, count;
+  gboolean transpose;
+
+  union {
+    GLfloat float_value[4];
+    GLint int_value[4];
+    GLfloat matrix[16];
+    GLfloat *float_array;
+    GLint *int_array;
+    gpointer array;
+  } v;
+};
+
 struct _CoglGles2WrapperUniforms
 {
   GLint     mvp_matrix_uniform;
@@ -133,7 +162,6 @@ struct _CoglGles2Wrapper
   GLfloat fog_start;
   GLfloat fog_end;
   GLfloat fog_color[4];
-  GLfloat custom_uniforms[COGL_GLES2_NUM_CUSTOM_UNIFORMS];
 };
 
 struct _CoglGles2WrapperProgram
@@ -65,8 +65,13 @@ _cogl_program_free (CoglProgram *program)
     }
 
   for (i = 0; i < COGL_GLES2_NUM_CUSTOM_UNIFORMS; i++)
-    if (program->custom_uniform_names[i])
-      g_free (program->custom_uniform_names[i]);
+    {
+      if (program->custom_uniform_names[i])
+        g_free (program->custom_uniform_names[i]);
+
+      if (program->custom_uniforms[i].count > 1)
+        g_free (program->custom_uniforms[i].v.array);
+    }
 }
 
 CoglHandle
@@ -79,6 +84,8 @@ cogl_create_program (void)
   program->attached_shaders = NULL;
   memset (program->custom_uniform_names, 0,
 	  COGL_GLES2_NUM_CUSTOM_UNIFORMS * sizeof (char *));
+  memset (program->custom_uniforms, 0,
+          COGL_GLES2_NUM_CUSTOM_UNIFORMS * sizeof (CoglBoxedValue));
 
   COGL_HANDLE_DEBUG_NEW (program, program);
 
@@ -159,17 +166,114 @@ cogl_program_get_uniform_location (CoglHandle   handle,
     return -1;
 }
 
+/* Stores @value in the boxed value for @uniform_no of the currently
+ * used program and marks it dirty so that the GLES2 wrapper uploads
+ * it before the next draw. The values live in the user program so
+ * that switching between programs does not lose them.
+ */
+static void
+cogl_program_uniform_x (COGLint       uniform_no,
+                        gint          size,
+                        gint          count,
+                        CoglBoxedType type,
+                        gsize         value_size,
+                        gconstpointer value,
+                        gboolean      transpose)
+{
+  CoglProgram *program;
+  CoglBoxedValue *bv;
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  if (uniform_no < 0 || uniform_no >= COGL_GLES2_NUM_CUSTOM_UNIFORMS
+      || size < 1 || size > 4 || count < 1)
+    return;
+
+  if (ctx->gles2.settings.user_program == COGL_INVALID_HANDLE)
+    return;
+
+  program = _cogl_program_pointer_from_handle (ctx->gles2.settings.user_program);
+  bv = program->custom_uniforms + uniform_no;
+
+  if (bv->count > 1)
+    {
+      g_free (bv->v.array);
+      bv->v.array = NULL;
+    }
+
+  bv->type = type;
+  bv->size = size;
+  bv->count = count;
+  bv->transpose = transpose;
+
+  if (count > 1)
+    bv->v.array = g_memdup (value, count * value_size);
+  else
+    memcpy (bv->v.float_value, value, value_size);
+
+  ctx->gles2.dirty_custom_uniforms |= 1 << uniform_no;
+}
+
 void
 cogl_program_uniform_1f (COGLint uniform_no,
                          gfloat  value)
 {
-  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+  cogl_program_uniform_float (uniform_no, 1, 1, &value);
+}
 
-  if (uniform_no >= 0 && uniform_no < COGL_GLES2_NUM_CUSTOM_UNIFORMS)
+void
+cogl_program_uniform_float (COGLint        uniform_no,
+                            gint           size,
+                            gint           count,
+                            const GLfloat *value)
+{
+  cogl_program_uniform_x (uniform_no, size, count, COGL_BOXED_FLOAT,
+                          sizeof (GLfloat) * size, value, FALSE);
+}
+
+void
+cogl_program_uniform_int (COGLint        uniform_no,
+                          gint           size,
+                          gint           count,
+                          const COGLint *value)
+{
+  cogl_program_uniform_x (uniform_no, size, count, COGL_BOXED_INT,
+                          sizeof (COGLint) * size, value, FALSE);
+}
+
+void
+cogl_program_uniform_matrix (COGLint        uniform_no,
+                             gint           size,
+                             gint           count,
+                             gboolean       transpose,
+                             const GLfloat *value)
+{
+  GLfloat *transposed = NULL;
+
+  if (size < 2 || size > 4 || count < 1)
+    return;
+
+  /* GLES 2 requires the transpose flag to be GL_FALSE when uploading
+     so we flip the matrices ourselves */
+  if (transpose)
     {
-      ctx->gles2.custom_uniforms[uniform_no] = value;
-      ctx->gles2.dirty_custom_uniforms |= 1 << uniform_no;
+      gint i, x, y;
+
+      transposed = g_new (GLfloat, size * size * count);
+
+      for (i = 0; i < count; i++)
+        for (y = 0; y < size; y++)
+          for (x = 0; x < size; x++)
+            transposed[i * size * size + x * size + y]
+              = value[i * size * size + y * size + x];
+
+      value = transposed;
     }
+
+  cogl_program_uniform_x (uniform_no, size, count, COGL_BOXED_MATRIX,
+                          sizeof (GLfloat) * size * size, value, FALSE);
+
+  g_free (transposed);
 }
 
 #else /* HAVE_COGL_GLES2 */
@@ -228,4 +332,29 @@ cogl_program_uniform_1f (COGLint uniform_no,
 {
 }
 
+void
+cogl_program_uniform_float (COGLint        uniform_no,
+                            gint           size,
+                            gint           count,
+                            const GLfloat *value)
+{
+}
+
+void
+cogl_program_uniform_int (COGLint        uniform_no,
+                          gint           size,
+                          gint           count,
+                          const COGLint *value)
+{
+}
+
+void
+cogl_program_uniform_matrix (COGLint        uniform_no,
+                             gint           size,
+                             gint           count,
+                             gboolean       transpose,
+                             const GLfloat *value)
+{
+}
+
 #endif /* HAVE_COGL_GLES2 */
@@ -37,6 +37,7 @@ struct _CoglProgram
   GSList            *attached_shaders;
 
   char              *custom_uniform_names[COGL_GLES2_NUM_CUSTOM_UNIFORMS];
+  CoglBoxedValue     custom_uniforms[COGL_GLES2_NUM_CUSTOM_UNIFORMS];
 };
 
 CoglProgram *_cogl_program_pointer_from_handle (CoglHandle handle);
@@ -72,6 +72,11 @@ static void _cogl_texture_free (CoglTexture *tex);
 
 COGL_HANDLE_DEFINE (Texture, texture, texture_handles);
 
+/* Slicing a texture costs a bind and a separate draw per slice every
+ * time it is painted, so a texture may always waste up to this fraction
+ * of its size in each axis before it is split into several slices */
+#define COGL_TEXTURE_WASTE_RATIO 3
+
 CoglHandle
 _cogl_texture_handle_from_pointer (CoglTexture *tex)
 {
@@ -627,6 +632,41 @@ _cogl_texture_upload_subregion_to_gl (CoglTexture *tex,
   return TRUE;
 }
 
+static gint
+_cogl_rect_slices_for_size (gint     size_to_fill,
+			    gint     max_span_size,
+			    gint     max_waste,
+			    GArray  *out_spans)
+{
+  gint             n_spans = 0;
+  CoglTexSliceSpan span;
+
+  /* Init first slice span */
+  span.start = 0;
+  span.size = max_span_size;
+  span.waste = 0;
+
+  /* Repeat until whole area covered */
+  while (size_to_fill >= span.size)
+    {
+      /* Add another slice span of same size */
+      if (out_spans) g_array_append_val (out_spans, span);
+      span.start   += span.size;
+      size_to_fill -= span.size;
+      n_spans++;
+    }
+
+  /* Add one last smaller slice span */
+  if (size_to_fill > 0)
+    {
+      span.size = size_to_fill;
+      if (out_spans) g_array_append_val (out_spans, span);
+      n_spans++;
+    }
+
+  return n_spans;
+}
+
 static gint
 _cogl_pot_slices_for_size (gint     size_to_fill,
 			   gint     max_span_size,
@@ -644,6 +684,10 @@ _cogl_pot_slices_for_size (gint     size_to_fill,
   /* Fix invalid max_waste */
   if (max_waste < 0) max_waste = 0;
 
+  /* Scale the allowed waste with the texture so that common NPOT sizes
+     such as 800x480 fit in one slice instead of several */
+  max_waste = MAX (max_waste, size_to_fill / COGL_TEXTURE_WASTE_RATIO);
+
   while (TRUE)
     {
       /* Is the whole area covered? */
@@ -678,17 +722,42 @@ _cogl_pot_slices_for_size (gint     size_to_fill,
 }
 
 static gboolean
-_cogl_texture_size_supported (GLenum gl_target,
-			      GLenum gl_format,
-			      GLenum gl_type,
-			      int    width,
-			      int    height)
+_cogl_texture_npot_allowed (CoglTexture *tex)
 {
+  /* Full NPOT support lifts every restriction, the basic variant only
+     covers textures that are clamped and not mipmapped. Hardware
+     repeating is separately limited to POT textures */
+  if (cogl_features_available (COGL_FEATURE_TEXTURE_NPOT))
+    return TRUE;
+
+  return (cogl_features_available (COGL_FEATURE_TEXTURE_NPOT_BASIC)
+	  && !tex->auto_mipmap);
+}
+
+static gboolean
+_cogl_texture_size_supported (GLenum   gl_target,
+			      GLenum   gl_format,
+			      GLenum   gl_type,
+			      int      width,
+			      int      height,
+			      gboolean allow_npot)
+{
+  _COGL_GET_CONTEXT (ctx, FALSE);
+
   /* check for non-power-of 2 */
-  if (!cogl_features_available(COGL_FEATURE_TEXTURE_NPOT)) {
+  if (!allow_npot) {
         if (!cogl_util_is_power_2(width) || !cogl_util_is_power_2(height))
                 return FALSE;
   }
+
+  /* The size limit is queried along with the features */
+  if (!ctx->features_cached)
+    cogl_get_features ();
+
+  if (ctx->max_texture_size > 0
+      && (width > ctx->max_texture_size || height > ctx->max_texture_size))
+    return FALSE;
+
   return TRUE;
 }
 
@@ -705,21 +774,34 @@ _cogl_texture_slices_create (CoglTexture *tex)
   CoglTexSliceSpan *x_span;
   CoglTexSliceSpan *y_span;
   gboolean          force_no_slice = FALSE;
+  gboolean          allow_npot;
 
   gint   (*slices_for_size) (gint, gint, gint, GArray*);
 
   /* Initialize size of largest slice according to supported features */
-  max_width = cogl_util_next_p2 (tex->bitmap.width);
-  max_height = cogl_util_next_p2 (tex->bitmap.height);
+  allow_npot = _cogl_texture_npot_allowed (tex);
   tex->gl_target = GL_TEXTURE_2D;
-  slices_for_size = _cogl_pot_slices_for_size;
+
+  if (allow_npot)
+    {
+      max_width = tex->bitmap.width;
+      max_height = tex->bitmap.height;
+      slices_for_size = _cogl_rect_slices_for_size;
+    }
+  else
+    {
+      max_width = cogl_util_next_p2 (tex->bitmap.width);
+      max_height = cogl_util_next_p2 (tex->bitmap.height);
+      slices_for_size = _cogl_pot_slices_for_size;
+    }
 
   /* If we can allocate this texture directly, then just do it!! */
   if (_cogl_texture_size_supported (tex->gl_target,
                                     tex->gl_format,
                                     tex->gl_type,
                                     tex->bitmap.width,
-                                    tex->bitmap.height))
+                                    tex->bitmap.height,
+                                    allow_npot))
     {
       max_width = tex->bitmap.width;
       max_height = tex->bitmap.height;
@@ -736,7 +818,8 @@ _cogl_texture_slices_create (CoglTexture *tex)
 					tex->gl_format,
 					tex->gl_type,
 					max_width,
-					max_height))
+					max_height,
+					allow_npot))
 	{
 	  return FALSE;
 	}
@@ -770,7 +853,8 @@ _cogl_texture_slices_create (CoglTexture *tex)
 					    tex->gl_format,
 					    tex->gl_type,
 					    max_width,
-					    max_height))
+					    max_height,
+					    allow_npot))
 	{
 	  /* Alternate between width and height */
 	  if (max_width > max_height)
@@ -819,6 +903,10 @@ _cogl_texture_slices_create (CoglTexture *tex)
 
   g_array_set_size (tex->slice_gl_handles, n_slices);
 
+  /* Repeating is done in software until a quad needs hardware
+   * wrapping, see _cogl_texture_set_wrap_mode() */
+  tex->wrap_mode = GL_CLAMP_TO_EDGE;
+
   /* Generate a "working set" of GL texture objects
    * (some implementations might supported faster
    *  re-binding between textures inside a set) */
@@ -852,9 +940,9 @@ _cogl_texture_slices_create (CoglTexture *tex)
           GE( cogl_wrap_glTexParameteri (tex->gl_target, GL_TEXTURE_MIN_FILTER,
 					 tex->min_filter) );
           GE( cogl_wrap_glTexParameteri (tex->gl_target, GL_TEXTURE_WRAP_S,
-					 GL_CLAMP_TO_EDGE) );
+					 tex->wrap_mode) );
           GE( cogl_wrap_glTexParameteri (tex->gl_target, GL_TEXTURE_WRAP_T,
-					 GL_CLAMP_TO_EDGE) );
+					 tex->wrap_mode) );
 
           if (tex->auto_mipmap)
             GE( cogl_wrap_glTexParameteri (tex->gl_target, GL_GENERATE_MIPMAP,
@@ -1362,6 +1450,7 @@ cogl_texture_new_from_foreign (GLuint           gl_handle,
   g_array_append_val (tex->slice_gl_handles, gl_handle);
 
   /* Force appropriate wrap parameter */
+  tex->wrap_mode = GL_CLAMP_TO_EDGE;
   GE( cogl_wrap_glTexParameteri (tex->gl_target, GL_TEXTURE_WRAP_S,
 				 GL_CLAMP_TO_EDGE) );
   GE( cogl_wrap_glTexParameteri (tex->gl_target, GL_TEXTURE_WRAP_T,
@@ -1462,6 +1551,57 @@ cogl_texture_get_max_waste (CoglHandle handle)
   return tex->max_waste;
 }
 
+guint
+cogl_texture_get_n_slices (CoglHandle handle)
+{
+  CoglTexture *tex;
+
+  if (!cogl_is_texture (handle))
+    return 0;
+
+  tex = _cogl_texture_pointer_from_handle (handle);
+
+  if (tex->slice_gl_handles == NULL)
+    return 0;
+
+  return tex->slice_gl_handles->len;
+}
+
+gsize
+cogl_texture_get_wasted_bytes (CoglHandle handle)
+{
+  CoglTexture      *tex;
+  CoglTexSliceSpan *span;
+  gsize             allocated_width = 0;
+  gsize             allocated_height = 0;
+  gint              i;
+
+  if (!cogl_is_texture (handle))
+    return 0;
+
+  tex = _cogl_texture_pointer_from_handle (handle);
+
+  if (tex->slice_x_spans == NULL || tex->slice_y_spans == NULL)
+    return 0;
+
+  /* The spans cover the bitmap plus the padding of each slice */
+  for (i = 0; i < tex->slice_x_spans->len; ++i)
+    {
+      span = &g_array_index (tex->slice_x_spans, CoglTexSliceSpan, i);
+      allocated_width += span->size;
+    }
+
+  for (i = 0; i < tex->slice_y_spans->len; ++i)
+    {
+      span = &g_array_index (tex->slice_y_spans, CoglTexSliceSpan, i);
+      allocated_height += span->size;
+    }
+
+  return (allocated_width * allocated_height
+	  - (gsize) tex->bitmap.width * tex->bitmap.height)
+    * _cogl_get_format_bpp (tex->bitmap.format);
+}
+
 gboolean
 cogl_texture_is_sliced (CoglHandle handle)
 {
@@ -1564,6 +1704,55 @@ cogl_texture_set_filters (CoglHandle handle,
     }
 }
 
+gboolean
+cogl_texture_set_auto_mipmap (CoglHandle handle,
+			      gboolean   auto_mipmap)
+{
+  CoglTexture *tex;
+  GLuint       gl_handle;
+  int          i;
+
+  if (!cogl_is_texture (handle))
+    return FALSE;
+
+  tex = _cogl_texture_pointer_from_handle (handle);
+
+  if (tex->auto_mipmap == auto_mipmap)
+    return TRUE;
+
+  /* Without full NPOT support only power of two slices can have
+     mipmaps */
+  if (auto_mipmap && tex->slice_x_spans && tex->slice_y_spans
+      && !cogl_features_available (COGL_FEATURE_TEXTURE_NPOT))
+    {
+      for (i=0; i<tex->slice_x_spans->len; ++i)
+	if (!cogl_util_is_power_2 (g_array_index (tex->slice_x_spans,
+						  CoglTexSliceSpan, i).size))
+	  return FALSE;
+      for (i=0; i<tex->slice_y_spans->len; ++i)
+	if (!cogl_util_is_power_2 (g_array_index (tex->slice_y_spans,
+						  CoglTexSliceSpan, i).size))
+	  return FALSE;
+    }
+
+  tex->auto_mipmap = auto_mipmap;
+
+  /* Make sure slices were created */
+  if (tex->slice_gl_handles == NULL)
+    return TRUE;
+
+  /* The levels get built the next time level 0 changes */
+  for (i=0; i<tex->slice_gl_handles->len; ++i)
+    {
+      gl_handle = g_array_index (tex->slice_gl_handles, GLuint, i);
+      GE( glBindTexture (tex->gl_target, gl_handle) );
+      GE( cogl_wrap_glTexParameteri (tex->gl_target, GL_GENERATE_MIPMAP,
+				     auto_mipmap ? GL_TRUE : GL_FALSE) );
+    }
+
+  return TRUE;
+}
+
 gboolean
 cogl_texture_set_region (CoglHandle       handle,
 			 gint             src_x,
@@ -1901,6 +2090,51 @@ _cogl_texture_quad_sw (CoglTexture *tex,
     }
 }
 
+/* A texture can be repeated by the hardware when it is a single POT
+ * GL texture without any waste; GL_REPEAT wraps around the whole GL
+ * texture, and GLES only supports it for POT textures */
+static gboolean
+_cogl_texture_can_hardware_repeat (CoglTexture *tex)
+{
+  CoglTexSliceSpan *x_span;
+  CoglTexSliceSpan *y_span;
+
+  if (tex->slice_gl_handles->len != 1 || tex->gl_target != GL_TEXTURE_2D)
+    return FALSE;
+
+  x_span = &g_array_index (tex->slice_x_spans, CoglTexSliceSpan, 0);
+  y_span = &g_array_index (tex->slice_y_spans, CoglTexSliceSpan, 0);
+
+  return (x_span->waste == 0 && y_span->waste == 0
+          && cogl_util_is_power_2 (x_span->size)
+          && cogl_util_is_power_2 (y_span->size));
+}
+
+static inline gboolean
+_cogl_texture_coords_repeat (ClutterFixed tx1,
+                             ClutterFixed ty1,
+                             ClutterFixed tx2,
+                             ClutterFixed ty2)
+{
+  return (MIN (tx1, tx2) < 0 || MAX (tx1, tx2) > CFX_ONE
+          || MIN (ty1, ty2) < 0 || MAX (ty1, ty2) > CFX_ONE);
+}
+
+/* Changes the wrap mode of the bound texture, if needed */
+static void
+_cogl_texture_set_wrap_mode (CoglTexture *tex,
+                             GLint        wrap_mode)
+{
+  if (tex->wrap_mode != wrap_mode)
+    {
+      GE( cogl_wrap_glTexParameteri (tex->gl_target, GL_TEXTURE_WRAP_S,
+                                     wrap_mode) );
+      GE( cogl_wrap_glTexParameteri (tex->gl_target, GL_TEXTURE_WRAP_T,
+                                     wrap_mode) );
+      tex->wrap_mode = wrap_mode;
+    }
+}
+
 static void
 _cogl_texture_quad_hw (CoglTexture *tex,
 		       ClutterFixed x1,
@@ -1944,6 +2178,14 @@ _cogl_texture_quad_hw (CoglTexture *tex,
   GE( cogl_gles2_wrapper_bind_texture (tex->gl_target, gl_handle,
 				       tex->gl_intformat) );
 
+  /* Let the hardware tile the texture, and go back to clamping once
+   * it is no longer repeated so that the edges don't bleed */
+  if (_cogl_texture_coords_repeat (tx1, ty1, tx2, ty2)
+      && _cogl_texture_can_hardware_repeat (tex))
+    _cogl_texture_set_wrap_mode (tex, GL_REPEAT);
+  else
+    _cogl_texture_set_wrap_mode (tex, GL_CLAMP_TO_EDGE);
+
   /* Don't include the waste in the texture coordinates */
   x_span = &g_array_index (tex->slice_x_spans, CoglTexSliceSpan, 0);
   y_span = &g_array_index (tex->slice_y_spans, CoglTexSliceSpan, 0);
@@ -2026,9 +2268,10 @@ cogl_texture_rectangle (CoglHandle   handle,
     }
 
   /* Tile textured quads */
-  if (tex->slice_gl_handles->len == 1
-      && tx1 >= -CFX_ONE && tx2 <= CFX_ONE
-      && ty1 >= -CFX_ONE && ty2 <= CFX_ONE)
+  if (_cogl_texture_can_hardware_repeat (tex)
+      || (tex->slice_gl_handles->len == 1
+          && tx1 >= -CFX_ONE && tx2 <= CFX_ONE
+          && ty1 >= -CFX_ONE && ty2 <= CFX_ONE))
     {
       _cogl_texture_quad_hw (tex, x1,y1, x2,y2, tx1,ty1, tx2,ty2);
     }
@@ -2165,6 +2408,134 @@ _cogl_texture_drawarrays (CoglHandle         handle,
     cogl_color (&vertices[n_vertices - 1].color);
 }
 
+typedef struct _CoglTexRectVertex
+{
+  GLfixed v[2];
+  GLfixed t[2];
+} CoglTexRectVertex;
+
+void
+cogl_texture_multiple_rectangles (CoglHandle          handle,
+                                  const ClutterFixed *verts,
+                                  guint               n_rects)
+{
+  CoglTexture       *tex;
+  CoglTexSliceSpan  *x_span;
+  CoglTexSliceSpan  *y_span;
+  CoglTexRectVertex *p;
+  GLuint             gl_handle;
+  gboolean           repeat = FALSE;
+  gulong             enable_flags = (COGL_ENABLE_TEXTURE_2D
+                                     | COGL_ENABLE_VERTEX_ARRAY
+                                     | COGL_ENABLE_TEXCOORD_ARRAY);
+  guint              i;
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  /* Check if valid texture */
+  if (!cogl_is_texture (handle))
+    return;
+
+  tex = _cogl_texture_pointer_from_handle (handle);
+
+  /* Make sure we got stuff to draw */
+  if (tex->slice_gl_handles == NULL || tex->slice_gl_handles->len == 0)
+    return;
+
+  for (i = 0; i < n_rects; i++)
+    {
+      const ClutterFixed *v = verts + i * 8;
+
+      if (_cogl_texture_coords_repeat (v[4], v[5], v[6], v[7]))
+        repeat = TRUE;
+    }
+
+  /* A single draw needs a single GL texture, which the hardware can
+   * repeat if needed; otherwise draw the rectangles one by one */
+  if (tex->slice_gl_handles->len != 1
+      || tex->gl_target != GL_TEXTURE_2D
+      || (repeat && !_cogl_texture_can_hardware_repeat (tex)))
+    {
+      for (i = 0; i < n_rects; i++)
+        {
+          const ClutterFixed *v = verts + i * 8;
+
+          cogl_texture_rectangle (handle,
+                                  v[0], v[1], v[2], v[3],
+                                  v[4], v[5], v[6], v[7]);
+        }
+
+      return;
+    }
+
+  if (ctx->texture_rect_vertices == NULL)
+    ctx->texture_rect_vertices = g_array_new (FALSE, FALSE,
+                                              sizeof (CoglTexRectVertex));
+
+  /* two triangles per rectangle */
+  g_array_set_size (ctx->texture_rect_vertices, n_rects * 6);
+  p = (CoglTexRectVertex *) ctx->texture_rect_vertices->data;
+
+  x_span = &g_array_index (tex->slice_x_spans, CoglTexSliceSpan, 0);
+  y_span = &g_array_index (tex->slice_y_spans, CoglTexSliceSpan, 0);
+
+  for (i = 0; i < n_rects; i++)
+    {
+      const ClutterFixed *v = verts + i * 8;
+      ClutterFixed tx1, ty1, tx2, ty2;
+      ClutterFixed corners[6][4];
+      gint j;
+
+      /* Don't include the waste in the texture coordinates */
+      tx1 = v[4] * (x_span->size - x_span->waste) / x_span->size;
+      tx2 = v[6] * (x_span->size - x_span->waste) / x_span->size;
+      ty1 = v[5] * (y_span->size - y_span->waste) / y_span->size;
+      ty2 = v[7] * (y_span->size - y_span->waste) / y_span->size;
+
+#define CORNER(n,x,y,tx,ty) \
+      corners[n][0] = (x); corners[n][1] = (y); \
+      corners[n][2] = (tx); corners[n][3] = (ty)
+
+      CORNER (0, v[0], v[1], tx1, ty1);
+      CORNER (1, v[2], v[1], tx2, ty1);
+      CORNER (2, v[0], v[3], tx1, ty2);
+      CORNER (3, v[0], v[3], tx1, ty2);
+      CORNER (4, v[2], v[1], tx2, ty1);
+      CORNER (5, v[2], v[3], tx2, ty2);
+
+#undef CORNER
+
+      for (j = 0; j < 6; j++, p++)
+        {
+          p->v[0] = corners[j][0];
+          p->v[1] = corners[j][1];
+          p->t[0] = corners[j][2];
+          p->t[1] = corners[j][3];
+        }
+    }
+
+  p = (CoglTexRectVertex *) ctx->texture_rect_vertices->data;
+
+  /* Prepare GL state */
+  if (ctx->color_alpha < 255
+      || tex->bitmap.format & COGL_A_BIT)
+    enable_flags |= COGL_ENABLE_BLEND;
+
+  cogl_enable (enable_flags);
+
+  gl_handle = g_array_index (tex->slice_gl_handles, GLuint, 0);
+  GE( cogl_gles2_wrapper_bind_texture (tex->gl_target, gl_handle,
+                                       tex->gl_intformat) );
+
+  _cogl_texture_set_wrap_mode (tex, repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE);
+
+  GE( cogl_wrap_glVertexPointer (2, GL_FIXED, sizeof (CoglTexRectVertex),
+                                 p->v) );
+  GE( cogl_wrap_glTexCoordPointer (2, GL_FIXED, sizeof (CoglTexRectVertex),
+                                   p->t) );
+  GE( cogl_wrap_glDrawArrays (GL_TRIANGLES, 0, n_rects * 6) );
+}
+
 void
 cogl_texture_polygon (CoglHandle         handle,
                       guint              n_vertices,
@@ -54,6 +54,7 @@ struct _CoglTexture
   gint               max_waste;
   COGLenum           min_filter;
   COGLenum           mag_filter;
+  GLint              wrap_mode;
   gboolean           is_foreign;
   gboolean           auto_mipmap;
 };
@@ -31,6 +31,7 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <math.h>
 
 #include "cogl-internal.h"
 #include "cogl-util.h"
@@ -659,9 +660,11 @@ cogl_perspective (ClutterFixed fovy,
 		  ClutterFixed zNear,
 		  ClutterFixed zFar)
 {
-  ClutterFixed xmax, ymax;
   ClutterFixed x, y, c, d;
+#ifndef CLUTTER_FLOAT_MATH
+  ClutterFixed xmax, ymax;
   ClutterFixed fovy_rad_half = CFX_MUL (fovy, CFX_PI) / 360;
+#endif
 
   GLfixed m[16];
 
@@ -681,6 +684,22 @@ cogl_perspective (ClutterFixed fovy,
    * 2) When working with small numbers, we can are loosing significant
    * precision, hence we use clutter_qmulx() here, not the fast macro.
    */
+#ifdef CLUTTER_FLOAT_MATH
+  {
+    float near = CLUTTER_FIXED_TO_FLOAT (zNear);
+    float far  = CLUTTER_FIXED_TO_FLOAT (zFar);
+    float ymaxf, xmaxf;
+
+    /* compute the matrix with the FPU and only round the result */
+    ymaxf = near * tanf (CLUTTER_FIXED_TO_FLOAT (fovy) * G_PI / 360.0f);
+    xmaxf = ymaxf * CLUTTER_FIXED_TO_FLOAT (aspect);
+
+    x = CLUTTER_FLOAT_TO_FIXED (near / xmaxf);
+    y = CLUTTER_FLOAT_TO_FIXED (near / ymaxf);
+    c = CLUTTER_FLOAT_TO_FIXED (-(far + near) / (far - near));
+    d = CLUTTER_FLOAT_TO_FIXED (-(2.0f * far * near) / (far - near));
+  }
+#else
   ymax = clutter_qmulx (zNear, CFX_DIV (clutter_sinx (fovy_rad_half),
 					clutter_cosx (fovy_rad_half)));
   xmax = clutter_qmulx (ymax, aspect);
@@ -689,6 +708,7 @@ cogl_perspective (ClutterFixed fovy,
   y = CFX_DIV (zNear, ymax);
   c = CFX_DIV (-(zFar + zNear), ( zFar - zNear));
   d = CFX_DIV (-(clutter_qmulx (2*zFar, zNear)), (zFar - zNear));
+#endif /* CLUTTER_FLOAT_MATH */
 
 #define M(row,col)  m[col*4+row]
   M(0,0) = x;
@@ -845,10 +865,24 @@ _cogl_features_init ()
   if (max_clip_planes >= 4)
     flags |= COGL_FEATURE_FOUR_CLIP_PLANES;
 
+  ctx->max_texture_size = 0;
+  GE( cogl_wrap_glGetIntegerv (GL_MAX_TEXTURE_SIZE, &ctx->max_texture_size) );
+
 #ifdef HAVE_COGL_GLES2
   flags |= COGL_FEATURE_SHADERS_GLSL | COGL_FEATURE_OFFSCREEN | COGL_FEATURE_TEXTURE_NPOT;
 #endif
 
+  /* Core GLES2 and these extensions allow NPOT textures as long as they
+     are clamped and not mipmapped */
+  if ((flags & COGL_FEATURE_TEXTURE_NPOT)
+      || cogl_check_extension ("GL_OES_texture_npot", gl_extensions)
+      || cogl_check_extension ("GL_IMG_texture_npot", gl_extensions)
+      || cogl_check_extension ("GL_APPLE_texture_2D_limited_npot",
+			       gl_extensions))
+    {
+      flags |= COGL_FEATURE_TEXTURE_NPOT_BASIC;
+    }
+
   if (cogl_check_extension ("GL_IMG_texture_compression_pvrtc", gl_extensions))
     {
       flags |= COGL_FEATURE_TEXTURE_PVRTC;
@@ -56,6 +56,10 @@ clutter_backend_egl_ensure_context (ClutterBackend *backend,
 
   if (stage == NULL)
     {
+      /* asking for the current context is a client side call */
+      if (eglGetCurrentContext () == EGL_NO_CONTEXT)
+        return;
+
       CLUTTER_NOTE (BACKEND, "Clearing EGL context");
       eglMakeCurrent (backend_egl->edpy,
                       EGL_NO_SURFACE,
@@ -71,16 +75,26 @@ clutter_backend_egl_ensure_context (ClutterBackend *backend,
       impl = _clutter_stage_get_window (stage);
       g_assert (impl != NULL);
 
-      CLUTTER_NOTE (MULTISTAGE, "Setting context for stage of type %s [%p]",
-                    g_type_name (G_OBJECT_TYPE (impl)),
-                    impl);
-
       stage_egl = CLUTTER_STAGE_EGL (impl);
       stage_x11 = CLUTTER_STAGE_X11 (impl);
 
       if (!backend_egl->egl_context)
         return;
 
+      /* Nothing to do if the stage surface is already current, which
+       * is always the case with a single stage. Only a real switch
+       * pays for trapping the X errors, as that syncs with the server
+       */
+      if (stage_x11->xwin != None &&
+          stage_egl->egl_surface != EGL_NO_SURFACE &&
+          eglGetCurrentContext () == backend_egl->egl_context &&
+          eglGetCurrentSurface (EGL_DRAW) == stage_egl->egl_surface)
+        return;
+
+      CLUTTER_NOTE (MULTISTAGE, "Setting context for stage of type %s [%p]",
+                    g_type_name (G_OBJECT_TYPE (impl)),
+                    impl);
+
       clutter_x11_trap_x_errors ();
 
       /* we might get here inside the final dispose cycle, so we
@@ -723,7 +723,8 @@ clutter_eglx_texture_pixmap_paint_fail (ClutterActor *actor)
   ClutterGeometry          geom;
   ClutterColor             col_black = {0,0,0,255};
   ClutterColor             col_red = {255,0,0,255};
-  guint                    w,h;
+  CoglColoredRectangle     rects[5];
+  gint                     w,h,i;
 
   clutter_actor_get_allocation_geometry (actor, &geom);
   w = geom.width;
@@ -732,13 +733,22 @@ clutter_eglx_texture_pixmap_paint_fail (ClutterActor *actor)
   col_black.alpha = col_red.alpha = clutter_actor_get_paint_opacity (actor);
 
   /* red border on black rectangle */
-  cogl_color (&col_black);
-  cogl_rectangle (10, 10, w-10, h-10);
-  cogl_color (&col_red);
-  cogl_rectangle (0, 0, w, 10);
-  cogl_rectangle (0, h-10, w, 10);
-  cogl_rectangle (0, 10, 10, h-20);
-  cogl_rectangle (w-10, 10, 10, h-20);
+#define SET_RECT(r,rx,ry,rw,rh,col) G_STMT_START { \
+  (r).x = CLUTTER_INT_TO_FIXED (rx); (r).y = CLUTTER_INT_TO_FIXED (ry); \
+  (r).width = CLUTTER_INT_TO_FIXED (rw); \
+  (r).height = CLUTTER_INT_TO_FIXED (rh); \
+  (r).color = (col); } G_STMT_END
+
+  i = 0;
+  SET_RECT (rects[i++], 10, 10, w-10, h-10, col_black);
+  SET_RECT (rects[i++], 0, 0, w, 10, col_red);
+  SET_RECT (rects[i++], 0, h-10, w, 10, col_red);
+  SET_RECT (rects[i++], 0, 10, 10, h-20, col_red);
+  SET_RECT (rects[i++], w-10, 10, 10, h-20, col_red);
+
+#undef SET_RECT
+
+  cogl_rectangles_with_color (rects, i);
 }
 #endif //DEBUG_RED_RECT
 
@@ -358,6 +358,10 @@ clutter_backend_glx_ensure_context (ClutterBackend *backend,
     {
       ClutterBackendX11 *backend_x11;
 
+      /* asking for the current context does not need a round trip */
+      if (glXGetCurrentContext () == NULL)
+        return;
+
       backend_x11 = CLUTTER_BACKEND_X11 (backend);
       CLUTTER_NOTE (MULTISTAGE, "Clearing all context");
 
@@ -372,10 +376,6 @@ clutter_backend_glx_ensure_context (ClutterBackend *backend,
       impl = _clutter_stage_get_window (stage);
       g_assert (impl != NULL);
 
-      CLUTTER_NOTE (MULTISTAGE, "Setting context for stage of type %s [%p]",
-                    g_type_name (G_OBJECT_TYPE (impl)),
-                    impl);
-
       stage_x11 = CLUTTER_STAGE_X11 (impl);
       backend_glx = CLUTTER_BACKEND_GLX (backend);
 
@@ -383,6 +383,19 @@ clutter_backend_glx_ensure_context (ClutterBackend *backend,
       if (backend_glx->gl_context == None)
         return;
 
+      /* Nothing to do if the stage window is already current, which is
+       * always the case with a single stage. Only a real switch pays
+       * for trapping the X errors, as that syncs with the server
+       */
+      if (stage_x11->xwin != None &&
+          glXGetCurrentContext () == backend_glx->gl_context &&
+          glXGetCurrentDrawable () == stage_x11->xwin)
+        return;
+
+      CLUTTER_NOTE (MULTISTAGE, "Setting context for stage of type %s [%p]",
+                    g_type_name (G_OBJECT_TYPE (impl)),
+                    impl);
+
       clutter_x11_trap_x_errors ();
 
       /* we might get here inside the final dispose cycle, so we
@@ -440,7 +453,18 @@ clutter_backend_glx_redraw (ClutterBackend *backend,
   /* Why this paint is done in backend as likely GL windowing system
    * specific calls, like swapping buffers.
   */
-  if (stage_x11->xwin)
+  if (stage_x11->xwin && _clutter_backend_in_redraw_pass (backend))
+    {
+      ClutterBackendGLX *backend_glx = CLUTTER_BACKEND_GLX (backend);
+
+      /* swapped together with the other stages of the pass; the
+       * drawable will no longer be current by then, so flush now
+       */
+      glFlush ();
+      backend_glx->pending_swaps = g_slist_append (backend_glx->pending_swaps,
+                                                   g_object_ref (stage));
+    }
+  else if (stage_x11->xwin)
     {
       clutter_backend_glx_wait_for_vblank (CLUTTER_BACKEND_GLX (backend));
       glXSwapBuffers (stage_x11->xdpy, stage_x11->xwin);
@@ -453,6 +477,41 @@ clutter_backend_glx_redraw (ClutterBackend *backend,
     }
 }
 
+static void
+clutter_backend_glx_end_redraw_pass (ClutterBackend *backend)
+{
+  ClutterBackendGLX *backend_glx = CLUTTER_BACKEND_GLX (backend);
+  GSList *l;
+
+  if (backend_glx->pending_swaps == NULL)
+    return;
+
+  /* One wait for all of the stages instead of one each. This does not
+   * help with CLUTTER_VBLANK_GLX_SWAP, where the driver throttles each
+   * swap itself and GLX_SGI_swap_control cannot set an interval of 0
+   */
+  clutter_backend_glx_wait_for_vblank (backend_glx);
+
+  for (l = backend_glx->pending_swaps; l; l = l->next)
+    {
+      ClutterStage *stage = l->data;
+      ClutterStageWindow *impl;
+
+      /* a paint handler may have destroyed the stage during the pass,
+       * taking its window with it
+       */
+      impl = _clutter_stage_get_window (stage);
+      if (impl != NULL && CLUTTER_STAGE_X11 (impl)->xwin)
+        glXSwapBuffers (CLUTTER_STAGE_X11 (impl)->xdpy,
+                        CLUTTER_STAGE_X11 (impl)->xwin);
+
+      g_object_unref (stage);
+    }
+
+  g_slist_free (backend_glx->pending_swaps);
+  backend_glx->pending_swaps = NULL;
+}
+
 static ClutterActor*
 clutter_backend_glx_create_stage (ClutterBackend  *backend,
                                   ClutterStage    *wrapper,
@@ -500,6 +559,7 @@ clutter_backend_glx_class_init (ClutterBackendGLXClass *klass)
   backend_class->get_features   = clutter_backend_glx_get_features;
   backend_class->redraw         = clutter_backend_glx_redraw;
   backend_class->ensure_context = clutter_backend_glx_ensure_context;
+  backend_class->end_redraw_pass = clutter_backend_glx_end_redraw_pass;
 }
 
 static void
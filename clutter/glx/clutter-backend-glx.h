@@ -74,6 +74,10 @@ struct _ClutterBackendGLX
   gint                   dri_fd;
   ClutterGLXVBlankType   vblank_type;
 
+  /* stages painted during a redraw pass, referenced until they are
+   * swapped when it ends */
+  GSList                *pending_swaps;
+
   /* props */
   Atom atom_WM_STATE;
   Atom atom_WM_STATE_FULLSCREEN;
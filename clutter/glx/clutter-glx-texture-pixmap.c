@@ -55,6 +55,7 @@
 
 #include "../clutter-util.h"
 #include "../clutter-debug.h"
+#include "../clutter-private.h"
 
 #include "cogl/cogl.h"
 
@@ -71,6 +72,18 @@ static ReleaseTexImage   _gl_release_tex_image = NULL;
 static gboolean          _have_tex_from_pixmap_ext = FALSE;
 static gboolean          _ext_check_done = FALSE;
 
+/* the fbconfig search is expensive and its result only depends on the
+ * depth of the pixmap, so it is done once per depth
+ */
+typedef struct _FBConfigCacheEntry
+{
+  gboolean    searched;
+  gboolean    found;
+  GLXFBConfig fbconfig;
+} FBConfigCacheEntry;
+
+static FBConfigCacheEntry _fbconfig_cache[33];
+
 struct _ClutterGLXTexturePixmapPrivate
 {
   COGLenum      target_type;
@@ -81,6 +94,8 @@ struct _ClutterGLXTexturePixmapPrivate
 
   gboolean      bound;
 
+  /* the pixmap was damaged since it was last bound */
+  gboolean      needs_rebind;
 };
 
 static void
@@ -287,10 +302,12 @@ clutter_glx_texture_pixmap_unrealize (ClutterActor *actor)
   CLUTTER_ACTOR_UNSET_FLAGS (actor, CLUTTER_ACTOR_REALIZED);
 }
 
-static GLXFBConfig *
-get_fbconfig_for_depth (guint depth)
+static gboolean
+find_fbconfig_for_depth (guint        depth,
+                         GLXFBConfig *fbconfig)
 {
-  GLXFBConfig *fbconfigs, *ret = NULL;
+  GLXFBConfig *fbconfigs;
+  gboolean     ret = FALSE;
   int          n_elements, i, found;
   Display     *dpy;
   int          db, stencil, alpha, rgba, value;
@@ -383,8 +400,8 @@ get_fbconfig_for_depth (guint depth)
 
   if (found != n_elements)
     {
-      ret = g_malloc (sizeof (GLXFBConfig));
-      *ret = fbconfigs[found];
+      *fbconfig = fbconfigs[found];
+      ret = TRUE;
     }
 
   if (n_elements)
@@ -393,6 +410,28 @@ get_fbconfig_for_depth (guint depth)
   return ret;
 }
 
+static const GLXFBConfig *
+get_fbconfig_for_depth (guint depth)
+{
+  FBConfigCacheEntry *entry;
+
+  if (depth >= G_N_ELEMENTS (_fbconfig_cache))
+    return NULL;
+
+  entry = &_fbconfig_cache[depth];
+
+  if (!entry->searched)
+    {
+      entry->found = find_fbconfig_for_depth (depth, &entry->fbconfig);
+      entry->searched = TRUE;
+
+      CLUTTER_NOTE (TEXTURE, "%s FBConfig for depth %u",
+                    entry->found ? "Found" : "No", depth);
+    }
+
+  return entry->found ? &entry->fbconfig : NULL;
+}
+
 static void
 clutter_glx_texture_pixmap_free_glx_pixmap (ClutterGLXTexturePixmap *texture)
 {
@@ -436,7 +475,7 @@ clutter_glx_texture_pixmap_create_glx_pixmap (ClutterGLXTexturePixmap *texture)
   ClutterGLXTexturePixmapPrivate *priv = texture->priv;
   GLXPixmap                       glx_pixmap = None;
   int                             attribs[7], i = 0, mipmap = 0;
-  GLXFBConfig                    *fbconfig;
+  const GLXFBConfig              *fbconfig;
   Display                        *dpy;
   guint                           depth;
   Pixmap                          pixmap;
@@ -517,8 +556,6 @@ clutter_glx_texture_pixmap_create_glx_pixmap (ClutterGLXTexturePixmap *texture)
       glx_pixmap = None;
     }
 
-  g_free (fbconfig);
-
  cleanup:
 
   if (priv->glx_pixmap)
@@ -546,6 +583,83 @@ clutter_glx_texture_pixmap_create_glx_pixmap (ClutterGLXTexturePixmap *texture)
     }
 }
 
+static void
+clutter_glx_texture_pixmap_bind_pixmap (ClutterGLXTexturePixmap *texture)
+{
+  ClutterGLXTexturePixmapPrivate *priv = texture->priv;
+  Display                        *dpy;
+
+  priv->needs_rebind = FALSE;
+
+  if (priv->use_fallback || priv->glx_pixmap == None)
+    return;
+
+  dpy = clutter_x11_get_default_display();
+
+  if (texture_bind (texture))
+    {
+      CLUTTER_NOTE (TEXTURE, "Really updating via GLX");
+
+      clutter_x11_trap_x_errors ();
+
+      (_gl_bind_tex_image) (dpy,
+                            priv->glx_pixmap,
+                            GLX_FRONT_LEFT_EXT,
+                            NULL);
+
+      XSync (clutter_x11_get_default_display(), FALSE);
+
+      /* Note above fires X error for non name pixmaps - but
+       * things still seem to work - i.e pixmap updated
+       */
+      if (clutter_x11_untrap_x_errors ())
+        CLUTTER_NOTE (TEXTURE, "Update bind_tex_image failed");
+
+      priv->bound = TRUE;
+    }
+  else
+    g_warning ("Failed to bind initial tex");
+}
+
+/* Queues a redraw of the part of @actor showing the damaged area of
+ * the pixmap, which is stretched over its allocation
+ */
+static void
+clutter_glx_texture_pixmap_queue_damage (ClutterActor *actor,
+                                         guint         pixmap_width,
+                                         guint         pixmap_height,
+                                         gint          x,
+                                         gint          y,
+                                         gint          width,
+                                         gint          height)
+{
+  ClutterGeometry area;
+  guint           actor_width, actor_height;
+
+  if (!CLUTTER_ACTOR_IS_VISIBLE (actor))
+    return;
+
+  if (pixmap_width == 0 || pixmap_height == 0)
+    {
+      clutter_actor_queue_redraw (actor);
+      return;
+    }
+
+  clutter_actor_get_size (actor, &actor_width, &actor_height);
+
+  /* round outwards */
+  area.x = x * (gint) actor_width / (gint) pixmap_width;
+  area.y = y * (gint) actor_height / (gint) pixmap_height;
+  area.width = ((x + width) * (gint) actor_width
+                + (gint) pixmap_width - 1) / (gint) pixmap_width
+               - area.x;
+  area.height = ((y + height) * (gint) actor_height
+                 + (gint) pixmap_height - 1) / (gint) pixmap_height
+                - area.y;
+
+  clutter_actor_queue_redraw_area (actor, &area);
+}
+
 static void
 clutter_glx_texture_pixmap_update_area (ClutterX11TexturePixmap *texture,
                                         gint                     x,
@@ -554,13 +668,12 @@ clutter_glx_texture_pixmap_update_area (ClutterX11TexturePixmap *texture,
                                         gint                     height)
 {
   ClutterGLXTexturePixmapPrivate       *priv;
-  Display                              *dpy;
-
+  guint                                 pixmap_width, pixmap_height;
+  const GSList                         *l;
 
   CLUTTER_NOTE (TEXTURE, "Updating texture pixmap");
 
   priv = CLUTTER_GLX_TEXTURE_PIXMAP (texture)->priv;
-  dpy = clutter_x11_get_default_display();
 
   if (!CLUTTER_ACTOR_IS_REALIZED (texture))
     return;
@@ -577,33 +690,73 @@ clutter_glx_texture_pixmap_update_area (ClutterX11TexturePixmap *texture,
   if (priv->glx_pixmap == None)
     return;
 
-  if (texture_bind (CLUTTER_GLX_TEXTURE_PIXMAP(texture)))
-    {
-      CLUTTER_NOTE (TEXTURE, "Really updating via GLX");
+  /* Binding is left to the next paint of the texture or of one of its
+   * clones, so that any number of damage events between two frames
+   * cost a single bind, and none while nothing draws the texture
+   */
+  priv->needs_rebind = TRUE;
 
-      clutter_x11_trap_x_errors ();
+  g_object_get (texture,
+                "pixmap-width",  &pixmap_width,
+                "pixmap-height", &pixmap_height,
+                NULL);
 
-      (_gl_bind_tex_image) (dpy,
-                            priv->glx_pixmap,
-                            GLX_FRONT_LEFT_EXT,
-                            NULL);
+  clutter_glx_texture_pixmap_queue_damage (CLUTTER_ACTOR (texture),
+                                           pixmap_width, pixmap_height,
+                                           x, y, width, height);
 
-      XSync (clutter_x11_get_default_display(), FALSE);
+  for (l = _clutter_texture_get_clones (CLUTTER_TEXTURE (texture));
+       l != NULL;
+       l = l->next)
+    {
+      ClutterActor *clone = l->data;
+      gboolean      repeat_x, repeat_y;
 
-      /* Note above fires X error for non name pixmaps - but
-       * things still seem to work - i.e pixmap updated
-       */
-      if (clutter_x11_untrap_x_errors ())
-        CLUTTER_NOTE (TEXTURE, "Update bind_tex_image failed");
+      g_object_get (clone,
+                    "repeat-x", &repeat_x,
+                    "repeat-y", &repeat_y,
+                    NULL);
 
-      priv->bound = TRUE;
+      /* a repeating clone shows the damaged area more than once */
+      if (repeat_x || repeat_y)
+        {
+          if (CLUTTER_ACTOR_IS_VISIBLE (clone))
+            clutter_actor_queue_redraw (clone);
+        }
+      else
+        clutter_glx_texture_pixmap_queue_damage (clone,
+                                                 pixmap_width, pixmap_height,
+                                                 x, y, width, height);
     }
-  else
-    g_warning ("Failed to bind initial tex");
+}
 
-  if (CLUTTER_ACTOR_IS_VISIBLE (CLUTTER_ACTOR(texture)))
-    clutter_actor_queue_redraw (CLUTTER_ACTOR(texture));
+static void
+clutter_glx_texture_pixmap_paint (ClutterActor *actor)
+{
+  ClutterGLXTexturePixmap *texture = CLUTTER_GLX_TEXTURE_PIXMAP (actor);
 
+  if (texture->priv->needs_rebind)
+    clutter_glx_texture_pixmap_bind_pixmap (texture);
+
+  CLUTTER_ACTOR_CLASS (clutter_glx_texture_pixmap_parent_class)->paint (actor);
+}
+
+static void
+clutter_glx_texture_pixmap_update_contents (ClutterTexture *texture)
+{
+  ClutterGLXTexturePixmap *self = CLUTTER_GLX_TEXTURE_PIXMAP (texture);
+
+  if (self->priv->needs_rebind)
+    clutter_glx_texture_pixmap_bind_pixmap (self);
+}
+
+static gboolean
+clutter_glx_texture_pixmap_get_opaque_area (ClutterActor    *actor,
+                                            ClutterActorBox *box)
+{
+  /* paint() draws what the parent class does, once the pixmap is bound */
+  return CLUTTER_ACTOR_CLASS (clutter_glx_texture_pixmap_parent_class)->
+    get_opaque_area (actor, box);
 }
 
 static void
@@ -611,6 +764,7 @@ clutter_glx_texture_pixmap_class_init (ClutterGLXTexturePixmapClass *klass)
 {
   GObjectClass                 *object_class = G_OBJECT_CLASS (klass);
   ClutterActorClass            *actor_class = CLUTTER_ACTOR_CLASS (klass);
+  ClutterTextureClass          *texture_class = CLUTTER_TEXTURE_CLASS (klass);
   ClutterX11TexturePixmapClass *x11_texture_class =
       CLUTTER_X11_TEXTURE_PIXMAP_CLASS (klass);
 
@@ -619,8 +773,12 @@ clutter_glx_texture_pixmap_class_init (ClutterGLXTexturePixmapClass *klass)
   object_class->dispose = clutter_glx_texture_pixmap_dispose;
   object_class->notify  = clutter_glx_texture_pixmap_notify;
 
-  actor_class->realize   = clutter_glx_texture_pixmap_realize;
-  actor_class->unrealize = clutter_glx_texture_pixmap_unrealize;
+  actor_class->paint           = clutter_glx_texture_pixmap_paint;
+  actor_class->get_opaque_area = clutter_glx_texture_pixmap_get_opaque_area;
+  actor_class->realize         = clutter_glx_texture_pixmap_realize;
+  actor_class->unrealize       = clutter_glx_texture_pixmap_unrealize;
+
+  texture_class->update_contents = clutter_glx_texture_pixmap_update_contents;
 
   x11_texture_class->update_area = clutter_glx_texture_pixmap_update_area;
 
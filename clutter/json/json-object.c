@@ -21,9 +21,11 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include <glib.h>
 
-#include "json-types.h"
+#include "json-types-private.h"
 
 /**
  * SECTION:json-object
@@ -43,13 +45,126 @@
  * json_object_get_size().
  */
 
+/* members are kept in a small array, in insertion order; objects
+ * with many members also get a hash table to speed up the lookups
+ */
+#define JSON_OBJECT_INDEX_THRESHOLD     16
+
+typedef struct
+{
+  gchar *name;
+  JsonNode *node;
+} JsonObjectMember;
+
 struct _JsonObject
 {
-  GHashTable *members;
+  JsonObjectMember *members;
+  guint n_members;
+  guint n_allocated;
+
+  GHashTable *index;
 
   volatile gint ref_count;
 };
 
+/* member names are normalized, so that "foo-bar" and "foo_bar"
+ * refer to the same member; this used to be done by calling
+ * g_strdelimit() on a copy of the name
+ */
+static inline gchar
+normalize_char (gchar c)
+{
+  switch (c)
+    {
+    case '-': case '|': case '>': case ' ': case '<': case '.':
+      return '_';
+    default:
+      return c;
+    }
+}
+
+static inline gboolean
+member_name_equal (const gchar *normalized,
+                   const gchar *name)
+{
+  while (*normalized != '\0' && *normalized == normalize_char (*name))
+    {
+      normalized += 1;
+      name += 1;
+    }
+
+  return *normalized == '\0' && *name == '\0';
+}
+
+static void
+normalize_name (gchar *name)
+{
+  for (; *name != '\0'; name++)
+    *name = normalize_char (*name);
+}
+
+static gint
+json_object_find_member (JsonObject  *object,
+                         const gchar *member_name)
+{
+  guint i;
+
+  if (object->index)
+    {
+      gchar buf[64], *name;
+      gsize len = strlen (member_name);
+      gpointer res;
+
+      if (len < sizeof (buf))
+        name = memcpy (buf, member_name, len + 1);
+      else
+        name = g_strdup (member_name);
+
+      normalize_name (name);
+
+      if (!g_hash_table_lookup_extended (object->index, name, NULL, &res))
+        res = NULL;
+
+      if (name != buf)
+        g_free (name);
+
+      return GPOINTER_TO_INT (res) - 1;
+    }
+
+  for (i = 0; i < object->n_members; i++)
+    if (member_name_equal (object->members[i].name, member_name))
+      return i;
+
+  return -1;
+}
+
+static void
+json_object_rebuild_index (JsonObject *object)
+{
+  guint i;
+
+  if (object->n_members <= JSON_OBJECT_INDEX_THRESHOLD)
+    {
+      if (object->index)
+        {
+          g_hash_table_destroy (object->index);
+          object->index = NULL;
+        }
+
+      return;
+    }
+
+  if (!object->index)
+    object->index = g_hash_table_new (g_str_hash, g_str_equal);
+  else
+    g_hash_table_remove_all (object->index);
+
+  for (i = 0; i < object->n_members; i++)
+    g_hash_table_insert (object->index,
+                         object->members[i].name,
+                         GINT_TO_POINTER (i + 1));
+}
+
 GType
 json_object_get_type (void)
 {
@@ -75,12 +190,9 @@ json_object_new (void)
 {
   JsonObject *object;
 
-  object = g_slice_new (JsonObject);
-  
+  object = g_slice_new0 (JsonObject);
+
   object->ref_count = 1;
-  object->members = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                           g_free,
-                                           (GDestroyNotify) json_node_free);
 
   return object;
 }
@@ -126,9 +238,20 @@ json_object_unref (JsonObject *object)
     g_atomic_int_compare_and_exchange (&object->ref_count, old_ref, old_ref - 1);
   else
     {
-      g_hash_table_destroy (object->members);
+      guint i;
+
+      for (i = 0; i < object->n_members; i++)
+        {
+          g_free (object->members[i].name);
+          json_node_free (object->members[i].node);
+        }
+
+      g_free (object->members);
       object->members = NULL;
 
+      if (object->index)
+        g_hash_table_destroy (object->index);
+
       g_slice_free (JsonObject, object);
     }
 }
@@ -147,48 +270,64 @@ json_object_add_member (JsonObject  *object,
                         const gchar *member_name,
                         JsonNode    *node)
 {
-  gchar *name;
-
   g_return_if_fail (object != NULL);
   g_return_if_fail (member_name != NULL);
   g_return_if_fail (node != NULL);
 
-  if (json_object_has_member (object, member_name))
+  _json_object_take_member (object, g_strdup (member_name), node);
+}
+
+/*
+ * _json_object_take_member:
+ * @object: a #JsonObject
+ * @member_name: the name of the member; the object takes ownership
+ * @node: the value of the member
+ *
+ * Like json_object_add_member(), but without copying @member_name.
+ * Used by the parser.
+ *
+ * Return value: the normalized name of the new member, owned by
+ *   @object, or %NULL if @object already had a member with that name
+ */
+const gchar *
+_json_object_take_member (JsonObject *object,
+                          gchar      *member_name,
+                          JsonNode   *node)
+{
+  JsonObjectMember *member;
+
+  if (json_object_find_member (object, member_name) >= 0)
     {
       g_warning ("JsonObject already has a `%s' member of type `%s'",
                  member_name,
                  json_node_type_name (node));
-      return;
+      g_free (member_name);
+      return NULL;
     }
 
-  name = g_strdelimit (g_strdup (member_name), G_STR_DELIMITERS, '_');
-  g_hash_table_replace (object->members, name, node);
-}
-
-/* FIXME: yuck. we really need to depend on GLib 2.14 */
-#if GLIB_MAJOR_VERSION == 2 && GLIB_MINOR_VERSION < 14
-static void
-get_keys (gpointer key,
-          gpointer value,
-          gpointer user_data)
-{
-  GList **keys = user_data;
-
-  *keys = g_list_prepend (*keys, key);
-}
+  if (object->n_members == object->n_allocated)
+    {
+      object->n_allocated = MAX (4, object->n_allocated * 2);
+      object->members = g_renew (JsonObjectMember,
+                                 object->members,
+                                 object->n_allocated);
+    }
 
-static GList *
-g_hash_table_get_keys (GHashTable *hash_table)
-{
-  GList *retval = NULL;
+  normalize_name (member_name);
 
-  g_return_val_if_fail (hash_table != NULL, NULL);
+  member = &object->members[object->n_members++];
+  member->name = member_name;
+  member->node = node;
 
-  g_hash_table_foreach (hash_table, get_keys, &retval);
+  if (object->index)
+    g_hash_table_insert (object->index,
+                         member->name,
+                         GINT_TO_POINTER (object->n_members));
+  else if (object->n_members > JSON_OBJECT_INDEX_THRESHOLD)
+    json_object_rebuild_index (object);
 
-  return retval;
+  return member_name;
 }
-#endif /* GLIB_MAJOR_VERSION == 2 && GLIB_MINOR_VERSION < 14 */
 
 /**
  * json_object_get_members:
@@ -205,9 +344,15 @@ g_hash_table_get_keys (GHashTable *hash_table)
 GList *
 json_object_get_members (JsonObject *object)
 {
+  GList *retval = NULL;
+  guint i;
+
   g_return_val_if_fail (object != NULL, NULL);
 
-  return g_hash_table_get_keys (object->members);
+  for (i = object->n_members; i > 0; i--)
+    retval = g_list_prepend (retval, object->members[i - 1].name);
+
+  return retval;
 }
 
 /**
@@ -225,17 +370,16 @@ JsonNode *
 json_object_get_member (JsonObject *object,
                         const gchar *member_name)
 {
-  gchar *name;
-  JsonNode *retval;
+  gint pos;
 
   g_return_val_if_fail (object != NULL, NULL);
   g_return_val_if_fail (member_name != NULL, NULL);
 
-  name = g_strdelimit (g_strdup (member_name), G_STR_DELIMITERS, '_');
-  retval = g_hash_table_lookup (object->members, name);
-  g_free (name);
+  pos = json_object_find_member (object, member_name);
+  if (pos < 0)
+    return NULL;
 
-  return retval;
+  return object->members[pos].node;
 }
 
 /**
@@ -251,17 +395,10 @@ gboolean
 json_object_has_member (JsonObject *object,
                         const gchar *member_name)
 {
-  gchar *name;
-  gboolean retval;
-
   g_return_val_if_fail (object != NULL, FALSE);
   g_return_val_if_fail (member_name != NULL, FALSE);
 
-  name = g_strdelimit (g_strdup (member_name), G_STR_DELIMITERS, '_');
-  retval = (g_hash_table_lookup (object->members, name) != NULL);
-  g_free (name);
-
-  return retval;
+  return json_object_find_member (object, member_name) >= 0;
 }
 
 /**
@@ -277,7 +414,7 @@ json_object_get_size (JsonObject *object)
 {
   g_return_val_if_fail (object != NULL, 0);
 
-  return g_hash_table_size (object->members);
+  return object->n_members;
 }
 
 /**
@@ -291,12 +428,26 @@ void
 json_object_remove_member (JsonObject  *object,
                            const gchar *member_name)
 {
-  gchar *name;
+  JsonObjectMember member;
+  gint pos;
 
   g_return_if_fail (object != NULL);
   g_return_if_fail (member_name != NULL);
 
-  name = g_strdelimit (g_strdup (member_name), G_STR_DELIMITERS, '_');
-  g_hash_table_remove (object->members, name);
-  g_free (name);
+  pos = json_object_find_member (object, member_name);
+  if (pos < 0)
+    return;
+
+  member = object->members[pos];
+
+  object->n_members -= 1;
+  memmove (object->members + pos,
+           object->members + pos + 1,
+           (object->n_members - pos) * sizeof (JsonObjectMember));
+
+  if (object->index)
+    json_object_rebuild_index (object);
+
+  g_free (member.name);
+  json_node_free (member.node);
 }
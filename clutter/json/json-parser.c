@@ -29,10 +29,12 @@
 #include "config.h"
 #endif
 
+#include <stdarg.h>
 #include <string.h>
 
 #include "json-marshal.h"
 #include "json-parser.h"
+#include "json-types-private.h"
 
 GQuark
 json_parser_error_quark (void)
@@ -43,72 +45,81 @@ json_parser_error_quark (void)
 #define JSON_PARSER_GET_PRIVATE(obj) \
         (json_parser_get_instance_private (JSON_PARSER (obj)))
 
+/* nesting deeper than this is reported as an error instead
+ * of overflowing the stack
+ */
+#define JSON_MAX_DEPTH          512
+
+typedef enum {
+  JSON_TOK_EOF,
+  JSON_TOK_ERROR,
+  JSON_TOK_LEFT_CURLY,
+  JSON_TOK_RIGHT_CURLY,
+  JSON_TOK_LEFT_BRACE,
+  JSON_TOK_RIGHT_BRACE,
+  JSON_TOK_COLON,
+  JSON_TOK_COMMA,
+  JSON_TOK_STRING,
+  JSON_TOK_INT,
+  JSON_TOK_FLOAT,
+  JSON_TOK_TRUE,
+  JSON_TOK_FALSE,
+  JSON_TOK_NULL
+} JsonTok;
+
+/* the tokenizer works directly on the input buffer: the text of
+ * a string token is a slice of the buffer, and it is only copied
+ * (and unescaped) when it is needed
+ */
+typedef struct
+{
+  const gchar *cur;
+  const gchar *end;
+
+  guint line;
+  const gchar *line_start;
+
+  JsonTok token;
+  const gchar *text;
+  gsize text_len;
+  guint has_escapes : 1;
+
+  gint64 v_int;
+  gdouble v_float;
+
+  /* used to unescape strings */
+  GString *scratch;
+
+  gchar *error_msg;
+} JsonTokenizer;
+
+typedef struct
+{
+  JsonNode *node;
+  gchar *member_name;
+} JsonParseFrame;
+
 struct _JsonParserPrivate
 {
   JsonNode *root;
   JsonNode *current_node;
 
-  GScanner *scanner;
-
-  GError *last_error;
-};
+  /* values of duplicate members, dropped from the tree but kept as
+   * long as it, since signal handlers may have kept pointers into them
+   */
+  GSList *dropped_nodes;
 
-static const GScannerConfig json_scanner_config =
-{
-  ( " \t\r\n" )		/* cset_skip_characters */,
-  (
-   "_"
-   G_CSET_a_2_z
-   G_CSET_A_2_Z
-  )			/* cset_identifier_first */,
-  (
-   G_CSET_DIGITS
-   "-_"
-   G_CSET_a_2_z
-   G_CSET_A_2_Z
-  )			/* cset_identifier_nth */,
-  ( "#\n" )		/* cpair_comment_single */,
-  TRUE			/* case_sensitive */,
-  TRUE			/* skip_comment_multi */,
-  TRUE			/* skip_comment_single */,
-  FALSE			/* scan_comment_multi */,
-  TRUE			/* scan_identifier */,
-  TRUE			/* scan_identifier_1char */,
-  FALSE			/* scan_identifier_NULL */,
-  TRUE			/* scan_symbols */,
-  TRUE			/* scan_binary */,
-  TRUE			/* scan_octal */,
-  TRUE			/* scan_float */,
-  TRUE			/* scan_hex */,
-  TRUE			/* scan_hex_dollar */,
-  TRUE			/* scan_string_sq */,
-  TRUE			/* scan_string_dq */,
-  TRUE			/* numbers_2_int */,
-  FALSE			/* int_2_float */,
-  FALSE			/* identifier_2_string */,
-  TRUE			/* char_2_token */,
-  TRUE			/* symbol_2_token */,
-  FALSE			/* scope_0_fallback */,
-};
+  JsonTokenizer *tokenizer;
 
+  /* containers being built */
+  GArray *stack;
 
-static const gchar symbol_names[] =
-  "true\0"
-  "false\0"
-  "null\0";
+  /* signals with handlers for the current parse */
+  guint emit_mask;
 
-static const struct
-{
-  guint name_offset;
-  guint token;
-} symbols[] = {
-  {  0, JSON_TOKEN_TRUE },
-  {  5, JSON_TOKEN_FALSE },
-  { 11, JSON_TOKEN_NULL }
+  GError *last_error;
 };
 
-static const guint n_symbols = G_N_ELEMENTS (symbols);
-
 enum
 {
   PARSE_START,
@@ -131,17 +142,10 @@ G_DEFINE_TYPE_WITH_CODE (JsonParser,
                          G_TYPE_OBJECT,
                          G_ADD_PRIVATE (JsonParser));
 
-static guint json_parse_array  (JsonParser *parser,
-                                GScanner   *scanner,
-                                gboolean    nested);
-static guint json_parse_object (JsonParser *parser,
-                                GScanner   *scanner,
-                                gboolean    nested);
-
 static void
-json_parser_dispose (GObject *gobject)
+json_parser_clear_root (JsonParser *parser)
 {
-  JsonParserPrivate *priv = JSON_PARSER_GET_PRIVATE (gobject);
+  JsonParserPrivate *priv = parser->priv;
 
   if (priv->root)
     {
@@ -149,6 +153,18 @@ json_parser_dispose (GObject *gobject)
       priv->root = NULL;
     }
 
+  g_slist_foreach (priv->dropped_nodes, (GFunc) json_node_free, NULL);
+  g_slist_free (priv->dropped_nodes);
+  priv->dropped_nodes = NULL;
+}
+
+static void
+json_parser_dispose (GObject *gobject)
+{
+  JsonParserPrivate *priv = JSON_PARSER_GET_PRIVATE (gobject);
+
+  json_parser_clear_root (JSON_PARSER (gobject));
+
   if (priv->last_error)
     {
       g_error_free (priv->last_error);
@@ -158,12 +174,23 @@ json_parser_dispose (GObject *gobject)
   G_OBJECT_CLASS (json_parser_parent_class)->dispose (gobject);
 }
 
+static void
+json_parser_finalize (GObject *gobject)
+{
+  JsonParserPrivate *priv = JSON_PARSER_GET_PRIVATE (gobject);
+
+  g_array_free (priv->stack, TRUE);
+
+  G_OBJECT_CLASS (json_parser_parent_class)->finalize (gobject);
+}
+
 static void
 json_parser_class_init (JsonParserClass *klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 
   gobject_class->dispose = json_parser_dispose;
+  gobject_class->finalize = json_parser_finalize;
 
   /**
    * JsonParser::parse-start:
@@ -327,494 +354,1049 @@ json_parser_init (JsonParser *parser)
 
   priv->root = NULL;
   priv->current_node = NULL;
+  priv->stack = g_array_new (FALSE, FALSE, sizeof (JsonParseFrame));
 }
 
-static guint
-json_parse_array (JsonParser *parser,
-                  GScanner   *scanner,
-                  gboolean    nested)
+/*
+ * tokenizer
+ */
+
+static void
+json_tokenizer_init (JsonTokenizer *tokenizer,
+                     const gchar   *data,
+                     gsize          length)
 {
-  JsonParserPrivate *priv = parser->priv;
-  JsonArray *array;
-  guint token;
+  memset (tokenizer, 0, sizeof (JsonTokenizer));
 
-  if (!nested)
-    {
-      /* the caller already swallowed the opening '[' */
-      token = g_scanner_get_next_token (scanner);
-      if (token != G_TOKEN_LEFT_BRACE)
-        return G_TOKEN_LEFT_BRACE;
-    }
+  tokenizer->cur = data;
+  tokenizer->end = data + length;
+  tokenizer->line = 1;
+  tokenizer->line_start = data;
+}
 
-  g_signal_emit (parser, parser_signals[ARRAY_START], 0);
+static void
+json_tokenizer_destroy (JsonTokenizer *tokenizer)
+{
+  if (tokenizer->scratch)
+    g_string_free (tokenizer->scratch, TRUE);
 
-  array = json_array_new ();
+  g_free (tokenizer->error_msg);
+}
 
-  token = g_scanner_get_next_token (scanner);
-  while (token != G_TOKEN_RIGHT_BRACE)
-    {
-      JsonNode *node = NULL;
-      gboolean negative = FALSE;
+static JsonTok
+json_tokenizer_error (JsonTokenizer *tokenizer,
+                      const gchar   *format,
+                      ...)
+{
+  va_list args;
 
-      if (token == G_TOKEN_COMMA)
-        {
-          /* swallow the comma */
-          token = g_scanner_get_next_token (scanner);
-          continue;
-        }
+  g_free (tokenizer->error_msg);
 
-      /* nested object */
-      if (token == G_TOKEN_LEFT_CURLY)
-        {
-          JsonNode *old_node = priv->current_node;
+  va_start (args, format);
+  tokenizer->error_msg = g_strdup_vprintf (format, args);
+  va_end (args);
 
-          priv->current_node = json_node_new (JSON_NODE_OBJECT);
+  return tokenizer->token = JSON_TOK_ERROR;
+}
+
+static inline void
+json_tokenizer_newline (JsonTokenizer *tokenizer,
+                        const gchar   *p)
+{
+  tokenizer->line += 1;
+  tokenizer->line_start = p + 1;
+}
 
-          token = json_parse_object (parser, scanner, TRUE);
+/* skips white space, "# ..." and C-style comments */
+static gboolean
+json_tokenizer_skip (JsonTokenizer *tokenizer)
+{
+  const gchar *p = tokenizer->cur;
+  const gchar *end = tokenizer->end;
+
+  while (p < end)
+    {
+      switch (*p)
+        {
+        case '\n':
+          json_tokenizer_newline (tokenizer, p);
+          /* fall through */
+        case ' ':
+        case '\t':
+        case '\r':
+          p += 1;
+          break;
 
-          node = priv->current_node;
-          priv->current_node = old_node;
+        case '#':
+          while (p < end && *p != '\n')
+            p += 1;
+          break;
 
-          if (token != G_TOKEN_NONE)
+        case '/':
+          if (p + 1 < end && p[1] == '*')
             {
-              json_node_free (node);
-              json_array_unref (array);
-              return token;
-            }
+              p += 2;
 
-          json_array_add_element (array, node);
-          node->parent = priv->current_node;
+              while (p + 1 < end && !(p[0] == '*' && p[1] == '/'))
+                {
+                  if (*p == '\n')
+                    json_tokenizer_newline (tokenizer, p);
 
-          g_signal_emit (parser, parser_signals[ARRAY_ELEMENT], 0,
-                         array,
-                         json_array_get_length (array));
+                  p += 1;
+                }
 
-          token = g_scanner_get_next_token (scanner);
-          if (token == G_TOKEN_RIGHT_BRACE)
-            break;
+              if (p + 1 >= end)
+                {
+                  tokenizer->cur = end;
+                  json_tokenizer_error (tokenizer, "unterminated comment");
+                  return FALSE;
+                }
 
-          continue;
+              p += 2;
+              break;
+            }
+          /* fall through */
+
+        default:
+          tokenizer->cur = p;
+          return TRUE;
         }
+    }
 
-      /* nested array */
-      if (token == G_TOKEN_LEFT_BRACE)
+  tokenizer->cur = p;
+
+  return TRUE;
+}
+
+static JsonTok
+json_tokenizer_lex_string (JsonTokenizer *tokenizer)
+{
+  const gchar *p = tokenizer->cur;
+  const gchar *end = tokenizer->end;
+  gchar quote = *p++;
+
+  tokenizer->text = p;
+  tokenizer->has_escapes = FALSE;
+
+  while (p < end && *p != quote)
+    {
+      /* single quoted strings are taken verbatim */
+      if (*p == '\\' && quote == '"')
         {
-          JsonNode *old_node = priv->current_node;
+          tokenizer->has_escapes = TRUE;
+          p += 1;
 
-          priv->current_node = json_node_new (JSON_NODE_ARRAY);
+          if (p == end)
+            break;
+        }
 
-          token = json_parse_array (parser, scanner, TRUE);
+      if (*p == '\n')
+        json_tokenizer_newline (tokenizer, p);
 
-          node = priv->current_node;
-          priv->current_node = old_node;
+      p += 1;
+    }
 
-          if (token != G_TOKEN_NONE)
-            {
-              json_node_free (node);
-              json_array_unref (array);
-              return token;
-            }
+  if (p >= end)
+    {
+      tokenizer->cur = end;
+      return json_tokenizer_error (tokenizer, "unterminated string");
+    }
 
-          json_array_add_element (array, node);
-          node->parent = priv->current_node;
+  tokenizer->text_len = p - tokenizer->text;
+  tokenizer->cur = p + 1;
 
-          g_signal_emit (parser, parser_signals[ARRAY_ELEMENT], 0,
-                         array,
-                         json_array_get_length (array));
+  return tokenizer->token = JSON_TOK_STRING;
+}
 
-          token = g_scanner_get_next_token (scanner);
-          if (token == G_TOKEN_RIGHT_BRACE)
-            break;
+static JsonTok
+json_tokenizer_lex_number (JsonTokenizer *tokenizer)
+{
+  const gchar *p = tokenizer->cur;
+  const gchar *end = tokenizer->end;
+  const gchar *start;
+  gboolean negative = FALSE;
+  gboolean is_float = FALSE;
+  gchar stack_buf[64], *buf;
+  gsize len;
+
+  if (*p == '-')
+    {
+      negative = TRUE;
+      p += 1;
 
-          continue;
-        }
+      while (p < end && (*p == ' ' || *p == '\t'))
+        p += 1;
+    }
 
-      if (token == '-')
+  start = p;
+
+  if (p + 1 < end && p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+    {
+      p += 2;
+      while (p < end && g_ascii_isxdigit (*p))
+        p += 1;
+    }
+  else
+    {
+      while (p < end && g_ascii_isdigit (*p))
+        p += 1;
+
+      if (p < end && *p == '.')
         {
-          guint next_token = g_scanner_peek_next_token (scanner);
+          is_float = TRUE;
+          p += 1;
 
-          if (next_token == G_TOKEN_INT ||
-              next_token == G_TOKEN_FLOAT)
-            {
-              negative = TRUE;
-              token = g_scanner_get_next_token (scanner);
-            }
-          else
-            {
-              return G_TOKEN_INT;
-            }
+          while (p < end && g_ascii_isdigit (*p))
+            p += 1;
         }
 
-      switch (token)
+      if (p < end && (*p == 'e' || *p == 'E'))
         {
-        case G_TOKEN_INT:
-          node = json_node_new (JSON_NODE_VALUE);
-          json_node_set_int (node, negative ? scanner->value.v_int * -1
-                                            : scanner->value.v_int);
-          break;
+          is_float = TRUE;
+          p += 1;
 
-        case G_TOKEN_FLOAT:
-          node = json_node_new (JSON_NODE_VALUE);
-          json_node_set_double (node, negative ? scanner->value.v_float * -1.0
-                                               : scanner->value.v_float);
-          break;
+          if (p < end && (*p == '+' || *p == '-'))
+            p += 1;
 
-        case G_TOKEN_STRING:
-          node = json_node_new (JSON_NODE_VALUE);
-          json_node_set_string (node, scanner->value.v_string);
-          break;
+          while (p < end && g_ascii_isdigit (*p))
+            p += 1;
+        }
+    }
 
-        case JSON_TOKEN_TRUE:
-        case JSON_TOKEN_FALSE:
-          node = json_node_new (JSON_NODE_VALUE);
-          json_node_set_boolean (node, token == JSON_TOKEN_TRUE ? TRUE
-                                                                : FALSE);
-          break;
+  tokenizer->cur = p;
+  len = p - start;
 
-        case JSON_TOKEN_NULL:
-          node = json_node_new (JSON_NODE_NULL);
-          break;
+  if (len == 0 || (p < end && (g_ascii_isalnum (*p) || *p == '_')))
+    return json_tokenizer_error (tokenizer, "invalid number");
 
-        default:
-          return G_TOKEN_RIGHT_BRACE;
-        }
+  /* the input is not NUL-terminated, so we need a copy of
+   * the digits for the conversion functions
+   */
+  if (len < sizeof (stack_buf))
+    {
+      buf = stack_buf;
+      memcpy (buf, start, len);
+      buf[len] = '\0';
+    }
+  else
+    buf = g_strndup (start, len);
 
-      if (node)
-        {
-          json_array_add_element (array, node);
-          node->parent = priv->current_node;
+  if (is_float)
+    {
+      tokenizer->v_float = g_ascii_strtod (buf, NULL);
+      if (negative)
+        tokenizer->v_float *= -1.0;
 
-          g_signal_emit (parser, parser_signals[ARRAY_ELEMENT], 0,
-                         array,
-                         json_array_get_length (array));
-        }
+      tokenizer->token = JSON_TOK_FLOAT;
+    }
+  else
+    {
+      if (buf[0] == '0' && (buf[1] == 'x' || buf[1] == 'X'))
+        tokenizer->v_int = g_ascii_strtoull (buf + 2, NULL, 16);
+      else
+        tokenizer->v_int = g_ascii_strtoull (buf, NULL, 10);
+
+      if (negative)
+        tokenizer->v_int *= -1;
 
-      token = g_scanner_get_next_token (scanner);
+      tokenizer->token = JSON_TOK_INT;
     }
 
-  json_node_take_array (priv->current_node, array);
+  if (buf != stack_buf)
+    g_free (buf);
+
+  return tokenizer->token;
+}
+
+static JsonTok
+json_tokenizer_lex_keyword (JsonTokenizer *tokenizer)
+{
+  const gchar *p = tokenizer->cur;
+  const gchar *start = p;
+  gsize len;
+
+  while (p < tokenizer->end &&
+         (g_ascii_isalnum (*p) || *p == '_' || *p == '-'))
+    p += 1;
+
+  tokenizer->cur = p;
+  len = p - start;
+
+  if (len == 4 && memcmp (start, "true", 4) == 0)
+    return tokenizer->token = JSON_TOK_TRUE;
 
-  g_signal_emit (parser, parser_signals[ARRAY_END], 0, array);
+  if (len == 5 && memcmp (start, "false", 5) == 0)
+    return tokenizer->token = JSON_TOK_FALSE;
 
-  return G_TOKEN_NONE;
+  if (len == 4 && memcmp (start, "null", 4) == 0)
+    return tokenizer->token = JSON_TOK_NULL;
+
+  return json_tokenizer_error (tokenizer, "unexpected identifier `%.*s'",
+                               (gint) len, start);
 }
 
-static guint
-json_parse_object (JsonParser *parser,
-                   GScanner   *scanner,
-                   gboolean    nested)
+static JsonTok
+json_tokenizer_next (JsonTokenizer *tokenizer)
 {
-  JsonParserPrivate *priv = parser->priv;
-  JsonObject *object;
-  guint token;
+  gchar c;
 
-  if (!nested)
+  if (!json_tokenizer_skip (tokenizer))
+    return JSON_TOK_ERROR;
+
+  if (tokenizer->cur >= tokenizer->end)
+    return tokenizer->token = JSON_TOK_EOF;
+
+  c = *tokenizer->cur;
+
+  switch (c)
     {
-      /* the caller already swallowed the opening '{' */
-      token = g_scanner_get_next_token (scanner);
-      if (token != G_TOKEN_LEFT_CURLY)
-        return G_TOKEN_LEFT_CURLY;
+    case '{':
+      tokenizer->cur += 1;
+      return tokenizer->token = JSON_TOK_LEFT_CURLY;
+
+    case '}':
+      tokenizer->cur += 1;
+      return tokenizer->token = JSON_TOK_RIGHT_CURLY;
+
+    case '[':
+      tokenizer->cur += 1;
+      return tokenizer->token = JSON_TOK_LEFT_BRACE;
+
+    case ']':
+      tokenizer->cur += 1;
+      return tokenizer->token = JSON_TOK_RIGHT_BRACE;
+
+    case ':':
+      tokenizer->cur += 1;
+      return tokenizer->token = JSON_TOK_COLON;
+
+    case ',':
+      tokenizer->cur += 1;
+      return tokenizer->token = JSON_TOK_COMMA;
+
+    case '"':
+    case '\'':
+      return json_tokenizer_lex_string (tokenizer);
+
+    case '-':
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+      return json_tokenizer_lex_number (tokenizer);
+
+    default:
+      if (g_ascii_isalpha (c) || c == '_')
+        return json_tokenizer_lex_keyword (tokenizer);
+
+      tokenizer->cur += 1;
+
+      if (g_ascii_isprint (c))
+        return json_tokenizer_error (tokenizer,
+                                     "unexpected character `%c'", c);
+      else
+        return json_tokenizer_error (tokenizer,
+                                     "unexpected character 0x%02x",
+                                     (guchar) c);
     }
+}
+
+static gint
+hex_value (gchar c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
 
-  g_signal_emit (parser, parser_signals[OBJECT_START], 0);
+  return -1;
+}
+
+static gboolean
+read_unichar (const gchar  *p,
+              const gchar  *end,
+              gunichar     *ch)
+{
+  gint i;
 
-  object = json_object_new ();
+  *ch = 0;
 
-  token = g_scanner_get_next_token (scanner);
-  while (token != G_TOKEN_RIGHT_CURLY)
+  if (end - p < 4)
+    return FALSE;
+
+  for (i = 0; i < 4; i++)
     {
-      JsonNode *node = NULL;
-      gchar *name = NULL;
-      gboolean negative = FALSE;
+      gint v = hex_value (p[i]);
 
-      if (token == G_TOKEN_COMMA)
-        {
-          /* swallow the comma */
-          token = g_scanner_get_next_token (scanner);
-          continue;
-        }
+      if (v < 0)
+        return FALSE;
 
-      if (token == G_TOKEN_STRING)
-        {
-          name = g_strdup (scanner->value.v_string);
+      *ch = (*ch << 4) | v;
+    }
+
+  return TRUE;
+}
+
+/* returns the text of the current string token; if the string does not
+ * contain escape sequences this is a pointer inside the input buffer,
+ * which is not NUL-terminated. otherwise, the string is unescaped
+ * into a buffer that is only valid until the next string token
+ */
+static const gchar *
+json_tokenizer_get_string (JsonTokenizer *tokenizer,
+                           gsize         *length)
+{
+  const gchar *p, *end;
+  GString *buf;
+
+  if (!tokenizer->has_escapes)
+    {
+      *length = tokenizer->text_len;
+      return tokenizer->text;
+    }
+
+  if (tokenizer->scratch == NULL)
+    tokenizer->scratch = g_string_sized_new (64);
+
+  buf = tokenizer->scratch;
+  g_string_truncate (buf, 0);
+
+  p = tokenizer->text;
+  end = p + tokenizer->text_len;
 
-          token = g_scanner_get_next_token (scanner);
-          if (token != ':')
+  while (p < end)
+    {
+      const gchar *next = p;
+      gunichar ch;
+
+      while (next < end && *next != '\\')
+        next += 1;
+
+      g_string_append_len (buf, p, next - p);
+
+      if (next == end)
+        break;
+
+      /* skip the backslash; the tokenizer guarantees that the
+       * escape sequence has at least one more character
+       */
+      p = next + 1;
+
+      switch (*p)
+        {
+        case 'b': g_string_append_c (buf, '\b'); p += 1; break;
+        case 'f': g_string_append_c (buf, '\f'); p += 1; break;
+        case 'n': g_string_append_c (buf, '\n'); p += 1; break;
+        case 'r': g_string_append_c (buf, '\r'); p += 1; break;
+        case 't': g_string_append_c (buf, '\t'); p += 1; break;
+
+        case 'u':
+          if (read_unichar (p + 1, end, &ch))
             {
-              g_free (name);
-              json_object_unref (object);
-              return ':';
+              p += 5;
+
+              /* surrogate pairs */
+              if (ch >= 0xd800 && ch < 0xdc00 &&
+                  end - p >= 6 && p[0] == '\\' && p[1] == 'u')
+                {
+                  gunichar low;
+
+                  if (read_unichar (p + 2, end, &low) &&
+                      low >= 0xdc00 && low < 0xe000)
+                    {
+                      ch = 0x10000 + ((ch - 0xd800) << 10) + (low - 0xdc00);
+                      p += 6;
+                    }
+                }
+
+              g_string_append_unichar (buf, ch);
             }
           else
             {
-              /* swallow the colon */
-              token = g_scanner_get_next_token (scanner);
+              g_string_append_c (buf, 'u');
+              p += 1;
             }
-        }
+          break;
 
-      if (!name)
-        {
-          json_object_unref (object);
-          return G_TOKEN_STRING;
+        case '0': case '1': case '2': case '3':
+        case '4': case '5': case '6': case '7':
+          {
+            gint i;
+
+            /* octal escapes, as accepted by GScanner */
+            for (i = 0, ch = 0; i < 3 && p < end && *p >= '0' && *p <= '7'; i++)
+              ch = (ch * 8) + (*p++ - '0');
+
+            g_string_append_c (buf, (gchar) ch);
+          }
+          break;
+
+        default:
+          /* \" \\ \/ and unknown escapes */
+          g_string_append_c (buf, *p);
+          p += 1;
+          break;
         }
+    }
 
-      if (token == G_TOKEN_LEFT_CURLY)
-        {
-          JsonNode *old_node = priv->current_node;
+  *length = buf->len;
 
-          priv->current_node = json_node_new (JSON_NODE_OBJECT);
+  return buf->str;
+}
 
-          token = json_parse_object (parser, scanner, TRUE);
+/*
+ * parser
+ */
 
-          node = priv->current_node;
-          priv->current_node = old_node;
+typedef struct
+{
+  JsonParser *parser;
+  JsonTokenizer *tokenizer;
+
+  const JsonParserCallbacks *callbacks;
+  gpointer user_data;
+
+  guint depth;
+  gboolean aborted;
+} JsonParseContext;
+
+#define CALLBACK(ctx,func,...)                                         \
+  G_STMT_START {                                                        \
+    if ((ctx)->callbacks->func != NULL &&                               \
+        !(ctx)->callbacks->func (__VA_ARGS__, (ctx)->user_data))        \
+      {                                                                 \
+        (ctx)->aborted = TRUE;                                          \
+        return FALSE;                                                   \
+      }                                                                 \
+  } G_STMT_END
+
+static gboolean json_parse_value (JsonParseContext *ctx);
+
+static gboolean
+json_parse_unexpected (JsonParseContext *ctx,
+                       const gchar      *expected)
+{
+  JsonTokenizer *tokenizer = ctx->tokenizer;
 
-          if (token != G_TOKEN_NONE)
-            {
-              g_free (name);
+  if (tokenizer->token == JSON_TOK_ERROR)
+    return FALSE;
 
-              if (node)
-                json_node_free (node);
+  if (tokenizer->token == JSON_TOK_EOF)
+    json_tokenizer_error (tokenizer, "unexpected end of data, expected %s",
+                          expected);
+  else
+    json_tokenizer_error (tokenizer, "unexpected token, expected %s",
+                          expected);
 
-              json_object_unref (object);
-              return token;
-            }
+  return FALSE;
+}
 
-          json_object_add_member (object, name, node);
-          node->parent = priv->current_node;
+static gboolean
+json_parse_object (JsonParseContext *ctx)
+{
+  JsonTokenizer *tokenizer = ctx->tokenizer;
 
-          g_signal_emit (parser, parser_signals[OBJECT_MEMBER], 0,
-                         object,
-                         name);
+  CALLBACK (ctx, object_start, ctx->parser);
 
-          g_free (name);
+  json_tokenizer_next (tokenizer);
 
-          token = g_scanner_get_next_token (scanner);
-          if (token == G_TOKEN_RIGHT_CURLY)
-            break;
+  while (tokenizer->token != JSON_TOK_RIGHT_CURLY)
+    {
+      const gchar *name;
+      gsize name_len;
 
+      /* like the old GScanner based parser, we are lenient
+       * about missing and trailing commas
+       */
+      if (tokenizer->token == JSON_TOK_COMMA)
+        {
+          json_tokenizer_next (tokenizer);
           continue;
         }
 
-      if (token == G_TOKEN_LEFT_BRACE)
-        {
-          JsonNode *old_node = priv->current_node;
+      if (tokenizer->token == JSON_TOK_EOF)
+        return json_parse_unexpected (ctx, "`}'");
 
-          priv->current_node = json_node_new (JSON_NODE_ARRAY);
+      if (tokenizer->token != JSON_TOK_STRING)
+        return json_parse_unexpected (ctx, "a member name");
 
-          token = json_parse_array (parser, scanner, TRUE);
+      name = json_tokenizer_get_string (tokenizer, &name_len);
+      CALLBACK (ctx, object_member, ctx->parser, name, name_len);
 
-          node = priv->current_node;
-          priv->current_node = old_node;
+      if (json_tokenizer_next (tokenizer) != JSON_TOK_COLON)
+        return json_parse_unexpected (ctx, "`:'");
 
-          if (token != G_TOKEN_NONE)
-            {
-              g_free (name);
-              json_node_free (node);
-              json_object_unref (object);
-              return token;
-            }
+      json_tokenizer_next (tokenizer);
+      if (!json_parse_value (ctx))
+        return FALSE;
 
-          json_object_add_member (object, name, node);
-          node->parent = priv->current_node;
+      json_tokenizer_next (tokenizer);
+    }
 
-          g_signal_emit (parser, parser_signals[OBJECT_MEMBER], 0,
-                         object,
-                         name);
+  CALLBACK (ctx, object_end, ctx->parser);
 
-          g_free (name);
+  return TRUE;
+}
 
-          token = g_scanner_get_next_token (scanner);
-          if (token == G_TOKEN_RIGHT_BRACE)
-            break;
+static gboolean
+json_parse_array (JsonParseContext *ctx)
+{
+  JsonTokenizer *tokenizer = ctx->tokenizer;
 
+  CALLBACK (ctx, array_start, ctx->parser);
+
+  json_tokenizer_next (tokenizer);
+
+  while (tokenizer->token != JSON_TOK_RIGHT_BRACE)
+    {
+      if (tokenizer->token == JSON_TOK_COMMA)
+        {
+          json_tokenizer_next (tokenizer);
           continue;
         }
 
-      if (token == '-')
-        {
-          guint next_token = g_scanner_peek_next_token (scanner);
+      if (tokenizer->token == JSON_TOK_EOF)
+        return json_parse_unexpected (ctx, "`]'");
 
-          if (next_token == G_TOKEN_INT || next_token == G_TOKEN_FLOAT)
-            {
-              negative = TRUE;
-              token = g_scanner_get_next_token (scanner);
-            }
-          else
-            {
-              g_free (name);
-              json_object_unref (object);
-              return G_TOKEN_INT;
-            }
-        }
+      if (!json_parse_value (ctx))
+        return FALSE;
+
+      json_tokenizer_next (tokenizer);
+    }
+
+  CALLBACK (ctx, array_end, ctx->parser);
+
+  return TRUE;
+}
+
+/* parses the value starting at the current token */
+static gboolean
+json_parse_value (JsonParseContext *ctx)
+{
+  JsonTokenizer *tokenizer = ctx->tokenizer;
+  const gchar *str;
+  gboolean retval;
+  gsize len;
 
-      switch (token)
+  switch (tokenizer->token)
+    {
+    case JSON_TOK_LEFT_CURLY:
+    case JSON_TOK_LEFT_BRACE:
+      if (ctx->depth == JSON_MAX_DEPTH)
         {
-        case G_TOKEN_INT:
-          node = json_node_new (JSON_NODE_VALUE);
-          json_node_set_int (node, negative ? scanner->value.v_int * -1
-                                            : scanner->value.v_int);
-          break;
+          json_tokenizer_error (tokenizer, "nesting too deep");
+          return FALSE;
+        }
 
-        case G_TOKEN_FLOAT:
-          node = json_node_new (JSON_NODE_VALUE);
-          json_node_set_double (node, negative ? scanner->value.v_float * -1.0
-                                               : scanner->value.v_float);
-          break;
+      ctx->depth += 1;
 
-        case G_TOKEN_STRING:
-          node = json_node_new (JSON_NODE_VALUE);
-          json_node_set_string (node, scanner->value.v_string);
-          break;
+      if (tokenizer->token == JSON_TOK_LEFT_CURLY)
+        retval = json_parse_object (ctx);
+      else
+        retval = json_parse_array (ctx);
 
-        case JSON_TOKEN_TRUE:
-        case JSON_TOKEN_FALSE:
-          node = json_node_new (JSON_NODE_VALUE);
-          json_node_set_boolean (node, token == JSON_TOKEN_TRUE ? TRUE
-                                                                : FALSE);
-          break;
+      ctx->depth -= 1;
 
-        case JSON_TOKEN_NULL:
-          node = json_node_new (JSON_NODE_NULL);
-          break;
+      return retval;
 
-        default:
-          g_free (name);
-          json_object_unref (object);
-          return G_TOKEN_SYMBOL;
-        }
+    case JSON_TOK_STRING:
+      str = json_tokenizer_get_string (tokenizer, &len);
+      CALLBACK (ctx, string_value, ctx->parser, str, len);
+      return TRUE;
 
-      if (node)
-        {
-          json_object_add_member (object, name, node);
-          node->parent = priv->current_node;
+    case JSON_TOK_INT:
+      CALLBACK (ctx, int_value, ctx->parser, tokenizer->v_int);
+      return TRUE;
 
-          g_signal_emit (parser, parser_signals[OBJECT_MEMBER], 0,
-                         object,
-                         name);
-        }
+    case JSON_TOK_FLOAT:
+      CALLBACK (ctx, double_value, ctx->parser, tokenizer->v_float);
+      return TRUE;
+
+    case JSON_TOK_TRUE:
+    case JSON_TOK_FALSE:
+      CALLBACK (ctx, boolean_value, ctx->parser,
+                tokenizer->token == JSON_TOK_TRUE);
+      return TRUE;
 
-      g_free (name);
+    case JSON_TOK_NULL:
+      CALLBACK (ctx, null_value, ctx->parser);
+      return TRUE;
 
-      token = g_scanner_get_next_token (scanner);
+    default:
+      return json_parse_unexpected (ctx, "a value");
     }
+}
 
-  json_node_take_object (priv->current_node, object);
+#undef CALLBACK
 
-  g_signal_emit (parser, parser_signals[OBJECT_END], 0, object);
+/*
+ * tree builder: the callbacks used by json_parser_load_from_data()
+ */
 
-  return G_TOKEN_NONE;
-}
+#define SHOULD_EMIT(priv,signal)        (((priv)->emit_mask & (1 << (signal))) != 0)
 
-static guint
-json_parse_statement (JsonParser *parser,
-                      GScanner   *scanner)
+static void
+json_parser_push_node (JsonParser *parser,
+                       JsonNode   *node)
 {
   JsonParserPrivate *priv = parser->priv;
-  guint token;
+  JsonParseFrame *frame;
 
-  token = g_scanner_peek_next_token (scanner);
-  switch (token)
+  if (priv->stack->len == 0)
     {
-    case G_TOKEN_LEFT_CURLY:
-      priv->root = priv->current_node = json_node_new (JSON_NODE_OBJECT);
-      return json_parse_object (parser, scanner, FALSE);
+      /* top-level value; a stream holds only one */
+      priv->root = node;
+
+      return;
+    }
 
-    case G_TOKEN_LEFT_BRACE:
-      priv->root = priv->current_node = json_node_new (JSON_NODE_ARRAY);
-      return json_parse_array (parser, scanner, FALSE);
+  frame = &g_array_index (priv->stack, JsonParseFrame, priv->stack->len - 1);
+  node->parent = frame->node;
 
-    case JSON_TOKEN_NULL:
-      priv->root = priv->current_node = json_node_new (JSON_NODE_NULL);
-      return G_TOKEN_NONE;
+  if (JSON_NODE_TYPE (frame->node) == JSON_NODE_OBJECT)
+    {
+      JsonObject *object = json_node_get_object (frame->node);
+      const gchar *name;
 
-    case JSON_TOKEN_TRUE:
-    case JSON_TOKEN_FALSE:
-      priv->root = priv->current_node = json_node_new (JSON_NODE_VALUE);
-      json_node_set_boolean (priv->current_node,
-                             token == JSON_TOKEN_TRUE ? TRUE : FALSE);
-      return G_TOKEN_NONE;
+      name = _json_object_take_member (object, frame->member_name, node);
+      frame->member_name = NULL;
 
-    case '-':
-      {
-        guint next_token = g_scanner_peek_next_token (scanner);
+      if (name == NULL)
+        {
+          priv->dropped_nodes = g_slist_prepend (priv->dropped_nodes, node);
+          return;
+        }
 
-        if (next_token == G_TOKEN_INT || next_token == G_TOKEN_FLOAT)
-          {
-            priv->root = priv->current_node = json_node_new (JSON_NODE_VALUE);
-
-            token = g_scanner_get_next_token (scanner);
-            switch (token)
-              {
-              case G_TOKEN_INT:
-                json_node_set_int (priv->current_node, scanner->value.v_int);
-                break;
-              case G_TOKEN_FLOAT:
-                json_node_set_double (priv->current_node, scanner->value.v_float);
-                break;
-              default:
-                break;
-              }
-
-            return G_TOKEN_NONE;
-          }
-        else
-          return G_TOKEN_INT;
-      }
-      break;
-
-    case G_TOKEN_INT:
-    case G_TOKEN_FLOAT:
-    case G_TOKEN_STRING:
-      priv->root = priv->current_node = json_node_new (JSON_NODE_VALUE);
-      if (token == G_TOKEN_INT)
-        json_node_set_int (priv->current_node, scanner->value.v_int);
-      else if (token == G_TOKEN_FLOAT)
-        json_node_set_double (priv->current_node, scanner->value.v_float);
-      else
-        json_node_set_string (priv->current_node, scanner->value.v_string);
-      return G_TOKEN_NONE;
+      if (SHOULD_EMIT (priv, OBJECT_MEMBER))
+        g_signal_emit (parser, parser_signals[OBJECT_MEMBER], 0,
+                       object,
+                       name);
+    }
+  else
+    {
+      JsonArray *array = json_node_get_array (frame->node);
 
-    default:
-      g_scanner_get_next_token (scanner);
-      return G_TOKEN_SYMBOL;
+      json_array_add_element (array, node);
+
+      if (SHOULD_EMIT (priv, ARRAY_ELEMENT))
+        g_signal_emit (parser, parser_signals[ARRAY_ELEMENT], 0,
+                       array,
+                       json_array_get_length (array) - 1);
     }
 }
 
 static void
-json_scanner_msg_handler (GScanner *scanner,
-                          gchar    *message,
-                          gboolean  is_error)
+json_parser_push_container (JsonParser *parser,
+                            JsonNode   *node)
+{
+  JsonParserPrivate *priv = parser->priv;
+  JsonParseFrame frame = { node, NULL };
+
+  /* the root node is available as soon as we start parsing it */
+  if (priv->stack->len == 0)
+    json_parser_push_node (parser, node);
+
+  g_array_append_val (priv->stack, frame);
+
+  priv->current_node = node;
+}
+
+static JsonNode *
+json_parser_pop_container (JsonParser *parser)
+{
+  JsonParserPrivate *priv = parser->priv;
+  JsonNode *node;
+
+  node = g_array_index (priv->stack, JsonParseFrame, priv->stack->len - 1).node;
+  g_array_set_size (priv->stack, priv->stack->len - 1);
+
+  if (priv->stack->len > 0)
+    priv->current_node =
+      g_array_index (priv->stack, JsonParseFrame, priv->stack->len - 1).node;
+  else
+    priv->current_node = NULL;
+
+  return node;
+}
+
+static gboolean
+json_tree_object_start (JsonParser *parser,
+                        gpointer    user_data)
+{
+  JsonNode *node;
+
+  if (SHOULD_EMIT (parser->priv, OBJECT_START))
+    g_signal_emit (parser, parser_signals[OBJECT_START], 0);
+
+  node = json_node_new (JSON_NODE_OBJECT);
+  json_node_take_object (node, json_object_new ());
+
+  json_parser_push_container (parser, node);
+
+  return TRUE;
+}
+
+static gboolean
+json_tree_object_member (JsonParser  *parser,
+                         const gchar *name,
+                         gsize        length,
+                         gpointer     user_data)
+{
+  JsonParserPrivate *priv = parser->priv;
+  JsonParseFrame *frame;
+
+  frame = &g_array_index (priv->stack, JsonParseFrame, priv->stack->len - 1);
+
+  g_free (frame->member_name);
+  frame->member_name = g_strndup (name, length);
+
+  return TRUE;
+}
+
+static gboolean
+json_tree_object_end (JsonParser *parser,
+                      gpointer    user_data)
 {
-  JsonParser *parser = scanner->user_data;
+  JsonNode *node = json_parser_pop_container (parser);
 
-  if (is_error)
+  if (SHOULD_EMIT (parser->priv, OBJECT_END))
+    g_signal_emit (parser, parser_signals[OBJECT_END], 0,
+                   json_node_get_object (node));
+
+  json_parser_push_node (parser, node);
+
+  return TRUE;
+}
+
+static gboolean
+json_tree_array_start (JsonParser *parser,
+                       gpointer    user_data)
+{
+  JsonNode *node;
+
+  if (SHOULD_EMIT (parser->priv, ARRAY_START))
+    g_signal_emit (parser, parser_signals[ARRAY_START], 0);
+
+  node = json_node_new (JSON_NODE_ARRAY);
+  json_node_take_array (node, json_array_new ());
+
+  json_parser_push_container (parser, node);
+
+  return TRUE;
+}
+
+static gboolean
+json_tree_array_end (JsonParser *parser,
+                     gpointer    user_data)
+{
+  JsonNode *node = json_parser_pop_container (parser);
+
+  if (SHOULD_EMIT (parser->priv, ARRAY_END))
+    g_signal_emit (parser, parser_signals[ARRAY_END], 0,
+                   json_node_get_array (node));
+
+  json_parser_push_node (parser, node);
+
+  return TRUE;
+}
+
+static gboolean
+json_tree_null_value (JsonParser *parser,
+                      gpointer    user_data)
+{
+  json_parser_push_node (parser, json_node_new (JSON_NODE_NULL));
+
+  return TRUE;
+}
+
+static gboolean
+json_tree_boolean_value (JsonParser *parser,
+                         gboolean    value,
+                         gpointer    user_data)
+{
+  JsonNode *node = json_node_new (JSON_NODE_VALUE);
+
+  g_value_init (&node->data.value, G_TYPE_BOOLEAN);
+  g_value_set_boolean (&node->data.value, value);
+
+  json_parser_push_node (parser, node);
+
+  return TRUE;
+}
+
+static gboolean
+json_tree_int_value (JsonParser *parser,
+                     gint64      value,
+                     gpointer    user_data)
+{
+  JsonNode *node = json_node_new (JSON_NODE_VALUE);
+
+  g_value_init (&node->data.value, G_TYPE_INT);
+  g_value_set_int (&node->data.value, (gint) value);
+
+  json_parser_push_node (parser, node);
+
+  return TRUE;
+}
+
+static gboolean
+json_tree_double_value (JsonParser *parser,
+                        gdouble     value,
+                        gpointer    user_data)
+{
+  JsonNode *node = json_node_new (JSON_NODE_VALUE);
+
+  g_value_init (&node->data.value, G_TYPE_DOUBLE);
+  g_value_set_double (&node->data.value, value);
+
+  json_parser_push_node (parser, node);
+
+  return TRUE;
+}
+
+static gboolean
+json_tree_string_value (JsonParser  *parser,
+                        const gchar *value,
+                        gsize        length,
+                        gpointer     user_data)
+{
+  JsonNode *node = json_node_new (JSON_NODE_VALUE);
+
+  /* this is the only copy of the string */
+  g_value_init (&node->data.value, G_TYPE_STRING);
+  g_value_take_string (&node->data.value, g_strndup (value, length));
+
+  json_parser_push_node (parser, node);
+
+  return TRUE;
+}
+
+static const JsonParserCallbacks json_tree_callbacks = {
+  json_tree_object_start,
+  json_tree_object_member,
+  json_tree_object_end,
+  json_tree_array_start,
+  json_tree_array_end,
+  json_tree_null_value,
+  json_tree_boolean_value,
+  json_tree_int_value,
+  json_tree_double_value,
+  json_tree_string_value
+};
+
+static void
+json_parser_clear_stack (JsonParser *parser)
+{
+  JsonParserPrivate *priv = parser->priv;
+  guint i;
+
+  for (i = 0; i < priv->stack->len; i++)
     {
-      GError *error = NULL;
+      JsonParseFrame *frame = &g_array_index (priv->stack, JsonParseFrame, i);
 
-      g_set_error (&error, JSON_PARSER_ERROR,
-                   JSON_PARSER_ERROR_PARSE,
-                   "Parse error on line %d: %s",
-                   scanner->line,
-                   message);
+      /* the bottom frame is the root node */
+      if (i > 0)
+        json_node_free (frame->node);
 
-      parser->priv->last_error = error;
-      g_signal_emit (parser, parser_signals[ERROR], 0, error);
+      g_free (frame->member_name);
     }
-  else
-    g_warning ("Line %d: %s", scanner->line, message);
+
+  g_array_set_size (priv->stack, 0);
+  priv->current_node = NULL;
 }
 
-static GScanner *
-json_scanner_new (JsonParser *parser)
+static guint
+json_parser_get_emit_mask (JsonParser *parser)
+{
+  JsonParserClass *klass = JSON_PARSER_GET_CLASS (parser);
+  guint mask = 0;
+  gint i;
+
+  /* emitting a signal for every member and element is expensive,
+   * so we only do it if somebody is listening
+   */
+  for (i = 0; i < LAST_SIGNAL; i++)
+    if (g_signal_has_handler_pending (parser, parser_signals[i], 0, FALSE))
+      mask |= 1 << i;
+
+  if (klass->object_start)
+    mask |= 1 << OBJECT_START;
+  if (klass->object_member)
+    mask |= 1 << OBJECT_MEMBER;
+  if (klass->object_end)
+    mask |= 1 << OBJECT_END;
+  if (klass->array_start)
+    mask |= 1 << ARRAY_START;
+  if (klass->array_element)
+    mask |= 1 << ARRAY_ELEMENT;
+  if (klass->array_end)
+    mask |= 1 << ARRAY_END;
+
+  return mask;
+}
+
+static gboolean
+json_parser_parse (JsonParser                 *parser,
+                   const gchar                *data,
+                   gsize                       length,
+                   const JsonParserCallbacks  *callbacks,
+                   gpointer                    user_data,
+                   GError                    **error)
 {
-  GScanner *scanner;
+  JsonParserPrivate *priv = parser->priv;
+  JsonTokenizer tokenizer;
+  JsonParseContext ctx;
+  gboolean retval = TRUE;
+
+  json_tokenizer_init (&tokenizer, data, length);
+
+  ctx.parser = parser;
+  ctx.tokenizer = &tokenizer;
+  ctx.callbacks = callbacks;
+  ctx.user_data = user_data;
+  ctx.depth = 0;
+  ctx.aborted = FALSE;
+
+  priv->tokenizer = &tokenizer;
+
+  /* an empty stream is fine, but anything after the value is not */
+  if (json_tokenizer_next (&tokenizer) != JSON_TOK_EOF)
+    {
+      if (!json_parse_value (&ctx))
+        retval = FALSE;
+      else if (json_tokenizer_next (&tokenizer) != JSON_TOK_EOF)
+        retval = json_parse_unexpected (&ctx, "the end of the data");
+    }
+
+  if (ctx.aborted)
+    {
+      g_set_error (error, JSON_PARSER_ERROR,
+                   JSON_PARSER_ERROR_UNKNOWN,
+                   "Parsing aborted on line %d",
+                   tokenizer.line);
+    }
+  else if (!retval)
+    {
+      GError *internal_error = NULL;
+
+      g_set_error (&internal_error, JSON_PARSER_ERROR,
+                   JSON_PARSER_ERROR_PARSE,
+                   "Parse error on line %d: %s",
+                   tokenizer.line,
+                   tokenizer.error_msg ? tokenizer.error_msg : "unknown");
+
+      if (callbacks == &json_tree_callbacks)
+        g_signal_emit (parser, parser_signals[ERROR], 0, internal_error);
 
-  scanner = g_scanner_new (&json_scanner_config);
-  scanner->msg_handler = json_scanner_msg_handler;
-  scanner->user_data = parser;
+      g_propagate_error (error, internal_error);
+    }
 
-  return scanner;
+  priv->tokenizer = NULL;
+  json_tokenizer_destroy (&tokenizer);
+
+  return retval;
 }
 
 /**
@@ -850,28 +1432,30 @@ json_parser_load_from_file (JsonParser   *parser,
                             const gchar  *filename,
                             GError      **error)
 {
+  GMappedFile *mapped;
   GError *internal_error;
-  gchar *data;
-  gsize length;
-  gboolean retval = TRUE;
+  gboolean retval;
 
   g_return_val_if_fail (JSON_IS_PARSER (parser), FALSE);
   g_return_val_if_fail (filename != NULL, FALSE);
 
+  /* the tokenizer does not need a NUL-terminated copy */
   internal_error = NULL;
-  if (!g_file_get_contents (filename, &data, &length, &internal_error))
+  mapped = g_mapped_file_new (filename, FALSE, &internal_error);
+  if (internal_error)
     {
       g_propagate_error (error, internal_error);
       return FALSE;
     }
 
-  if (!json_parser_load_from_data (parser, data, length, &internal_error))
-    {
-      g_propagate_error (error, internal_error);
-      retval = FALSE;
-    }
+  retval = json_parser_load_from_data (parser,
+                                       g_mapped_file_get_length (mapped) > 0
+                                         ? g_mapped_file_get_contents (mapped)
+                                         : "",
+                                       g_mapped_file_get_length (mapped),
+                                       error);
 
-  g_free (data);
+  g_mapped_file_unref (mapped);
 
   return retval;
 }
@@ -896,116 +1480,75 @@ json_parser_load_from_data (JsonParser   *parser,
                             gssize        length,
                             GError      **error)
 {
-  GScanner *scanner;
-  gboolean done;
-  gboolean retval = TRUE;
-  gint i;
+  JsonParserPrivate *priv;
+  gboolean retval;
 
   g_return_val_if_fail (JSON_IS_PARSER (parser), FALSE);
   g_return_val_if_fail (data != NULL, FALSE);
 
+  priv = parser->priv;
+
   if (length < 0)
     length = strlen (data);
 
-  if (parser->priv->root)
-    {
-      json_node_free (parser->priv->root);
-      parser->priv->root = NULL;
-    }
+  json_parser_clear_root (parser);
 
-  scanner = json_scanner_new (parser);
-  g_scanner_input_text (scanner, data, length);
-
-  for (i = 0; i < n_symbols; i++)
-    {
-      g_scanner_scope_add_symbol (scanner, 0,
-                                  symbol_names + symbols[i].name_offset,
-                                  GINT_TO_POINTER (symbols[i].token));
-    }
-
-  parser->priv->scanner = scanner;
+  priv->emit_mask = json_parser_get_emit_mask (parser);
 
   g_signal_emit (parser, parser_signals[PARSE_START], 0);
 
-  done = FALSE;
-  while (!done)
-    {
-      if (g_scanner_peek_next_token (scanner) == G_TOKEN_EOF)
-        done = TRUE;
-      else
-        {
-          guint expected_token;
-
-          expected_token = json_parse_statement (parser, scanner);
-          if (expected_token != G_TOKEN_NONE)
-            {
-              const gchar *symbol_name;
-              gchar *msg;
-
-              msg = NULL;
-              symbol_name = NULL;
-              if (scanner->scope_id == 0)
-                {
-                  if (expected_token > JSON_TOKEN_INVALID &&
-                      expected_token < JSON_TOKEN_LAST)
-                    {
-                      for (i = 0; i < n_symbols; i++)
-                        if (symbols[i].token == expected_token)
-                          symbol_name = symbol_names + symbols[i].name_offset;
-
-                      if (!msg)
-                        msg = g_strconcat ("e.g. `", symbol_name, "'", NULL);
-                    }
-
-                  if ((JsonTokenType) scanner->token > JSON_TOKEN_INVALID &&
-                      (JsonTokenType) scanner->token < JSON_TOKEN_LAST)
-                    {
-                      symbol_name = "???";
-
-                      for (i = 0; i < n_symbols; i++)
-                        if (symbols[i].token == scanner->token)
-                          symbol_name = symbol_names + symbols[i].name_offset;
-                    }
-                }
+  retval = json_parser_parse (parser, data, length,
+                              &json_tree_callbacks, NULL,
+                              error);
 
-              /* this will emit the ::error signal via the custom
-               * message handler we install
-               */
-              g_scanner_unexp_token (scanner, expected_token,
-                                     NULL, "keyword",
-                                     symbol_name, msg,
-                                     TRUE);
+  json_parser_clear_stack (parser);
 
-              if (parser->priv->last_error)
-                {
-                  g_propagate_error (error, parser->priv->last_error);
-                  parser->priv->last_error = NULL;
-                }
-#if 0
-              /* we set a generic error here; the message from
-               * GScanner is relayed in the ::error signal
-               */
-              g_set_error (error, JSON_PARSER_ERROR,
-                           JSON_PARSER_ERROR_PARSE,
-                           "Invalid token `%s' found: expecting %s",
-                           symbol_name ? symbol_name : "???",
-                           msg ? msg : "unknown");
-#endif
-              retval = FALSE;
+  g_signal_emit (parser, parser_signals[PARSE_END], 0);
 
-              g_free (msg);
-              done = TRUE;
-            }
-        }
-    }
+  return retval;
+}
 
-  g_scanner_destroy (scanner);
-  parser->priv->scanner = NULL;
-  parser->priv->current_node = NULL;
+/**
+ * json_parser_load_with_callbacks:
+ * @parser: a #JsonParser
+ * @data: the buffer to parse
+ * @length: the length of the buffer, or -1
+ * @callbacks: a #JsonParserCallbacks structure
+ * @user_data: data to pass to the callbacks
+ * @error: return location for a #GError, or %NULL
+ *
+ * Parses a JSON stream from a buffer, calling the functions inside
+ * @callbacks for each token instead of building a tree of #JsonNode<!--
+ * -->s. No signal is emitted and the root node of @parser is not
+ * changed; json_parser_get_current_line() can be used from inside
+ * the callbacks.
+ *
+ * The strings passed to the callbacks are not NUL-terminated, and they
+ * are only valid for the duration of the callback. If one of the
+ * callbacks returns %FALSE, the parsing is stopped and @error is
+ * set to %JSON_PARSER_ERROR_UNKNOWN.
+ *
+ * Return value: %TRUE if the buffer was successfully parsed
+ */
+gboolean
+json_parser_load_with_callbacks (JsonParser                 *parser,
+                                 const gchar                *data,
+                                 gssize                      length,
+                                 const JsonParserCallbacks  *callbacks,
+                                 gpointer                    user_data,
+                                 GError                    **error)
+{
+  g_return_val_if_fail (JSON_IS_PARSER (parser), FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+  g_return_val_if_fail (callbacks != NULL, FALSE);
+  g_return_val_if_fail (parser->priv->tokenizer == NULL, FALSE);
 
-  g_signal_emit (parser, parser_signals[PARSE_END], 0);
+  if (length < 0)
+    length = strlen (data);
 
-  return retval;
+  return json_parser_parse (parser, data, length,
+                            callbacks, user_data,
+                            error);
 }
 
 /**
@@ -1038,8 +1581,8 @@ json_parser_get_current_line (JsonParser *parser)
 {
   g_return_val_if_fail (JSON_IS_PARSER (parser), 0);
 
-  if (parser->priv->scanner)
-    return g_scanner_cur_line (parser->priv->scanner);
+  if (parser->priv->tokenizer)
+    return parser->priv->tokenizer->line;
 
   return 0;
 }
@@ -1056,10 +1599,13 @@ json_parser_get_current_line (JsonParser *parser)
 guint
 json_parser_get_current_pos (JsonParser *parser)
 {
+  JsonTokenizer *tokenizer;
+
   g_return_val_if_fail (JSON_IS_PARSER (parser), 0);
 
-  if (parser->priv->scanner)
-    return g_scanner_cur_line (parser->priv->scanner);
+  tokenizer = parser->priv->tokenizer;
+  if (tokenizer)
+    return tokenizer->cur - tokenizer->line_start;
 
   return 0;
 }
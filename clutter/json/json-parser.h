@@ -126,6 +126,60 @@ struct _JsonParserClass
   void (* _json_reserved8) (void);
 };
 
+/**
+ * JsonParserCallbacks:
+ * @object_start: called at the beginning of an object
+ * @object_member: called with the name of each member of an object,
+ *   before its value
+ * @object_end: called at the end of an object
+ * @array_start: called at the beginning of an array
+ * @array_end: called at the end of an array
+ * @null_value: called for each %null value
+ * @boolean_value: called for each boolean value
+ * @int_value: called for each integer value
+ * @double_value: called for each floating point value
+ * @string_value: called for each string value
+ *
+ * Functions called by json_parser_load_with_callbacks() while parsing
+ * a JSON stream. Any of the functions can be %NULL. The strings are
+ * not NUL-terminated, and are only valid during the call. Returning
+ * %FALSE from a function stops the parsing.
+ */
+typedef struct _JsonParserCallbacks     JsonParserCallbacks;
+
+struct _JsonParserCallbacks
+{
+  gboolean (* object_start)  (JsonParser  *parser,
+                              gpointer     user_data);
+  gboolean (* object_member) (JsonParser  *parser,
+                              const gchar *name,
+                              gsize        length,
+                              gpointer     user_data);
+  gboolean (* object_end)    (JsonParser  *parser,
+                              gpointer     user_data);
+
+  gboolean (* array_start)   (JsonParser  *parser,
+                              gpointer     user_data);
+  gboolean (* array_end)     (JsonParser  *parser,
+                              gpointer     user_data);
+
+  gboolean (* null_value)    (JsonParser  *parser,
+                              gpointer     user_data);
+  gboolean (* boolean_value) (JsonParser  *parser,
+                              gboolean     value,
+                              gpointer     user_data);
+  gboolean (* int_value)     (JsonParser  *parser,
+                              gint64       value,
+                              gpointer     user_data);
+  gboolean (* double_value)  (JsonParser  *parser,
+                              gdouble      value,
+                              gpointer     user_data);
+  gboolean (* string_value)  (JsonParser  *parser,
+                              const gchar *value,
+                              gsize        length,
+                              gpointer     user_data);
+};
+
 GQuark      json_parser_error_quark    (void);
 GType       json_parser_get_type       (void) G_GNUC_CONST;
 
@@ -137,6 +191,12 @@ gboolean    json_parser_load_from_data   (JsonParser   *parser,
                                           const gchar  *data,
                                           gssize        length,
                                           GError      **error);
+gboolean    json_parser_load_with_callbacks (JsonParser                 *parser,
+                                             const gchar                *data,
+                                             gssize                      length,
+                                             const JsonParserCallbacks  *callbacks,
+                                             gpointer                    user_data,
+                                             GError                    **error);
 JsonNode *  json_parser_get_root         (JsonParser   *parser);
 
 guint       json_parser_get_current_line (JsonParser   *parser);
@@ -28,6 +28,7 @@
 #endif
 
 #include <glib.h>
+#include <string.h>
 
 #include "pangoclutter-glyph-cache.h"
 #include "cogl/cogl.h"
@@ -54,9 +55,9 @@ struct _PangoClutterGlyphCache
   /* List of horizontal bands of glyphs */
   PangoClutterGlyphCacheBand    *bands;
 
-  /* If TRUE all of the textures will be created with automatic mipmap
-     generation enabled */
-  gboolean                       use_mipmapping;
+  /* Bands with glyphs waiting to be uploaded by
+     pango_clutter_glyph_cache_flush() */
+  GSList                        *pending_bands;
 };
 
 struct _PangoClutterGlyphCacheKey
@@ -81,6 +82,11 @@ struct _PangoClutterGlyphCacheTexture
   /* The actual texture */
   CoglHandle texture;
 
+  /* Whether the texture has been given mipmaps, which only happens
+     once it is drawn scaled down, and whether its filters use them */
+  gboolean   has_mipmaps;
+  gboolean   mipmap_filters;
+
   PangoClutterGlyphCacheTexture *next;
 };
 
@@ -104,6 +110,12 @@ struct _PangoClutterGlyphCacheBand
   /* The texture containing this band */
   CoglHandle texture;
 
+  /* A copy of the band, texture_size wide, holding the glyphs added
+     since the last flush or NULL if there are none. They lie between
+     space_remaining and pending_end */
+  guchar    *pending;
+  int        pending_end;
+
   PangoClutterGlyphCacheBand *next;
 };
 
@@ -173,13 +185,14 @@ pango_clutter_glyph_cache_free_bands (PangoClutterGlyphCacheBand *node)
     {
       next = node->next;
       cogl_texture_unref (node->texture);
+      g_free (node->pending);
       g_slice_free (PangoClutterGlyphCacheBand, node);
       node = next;
     }
 }
 
 PangoClutterGlyphCache *
-pango_clutter_glyph_cache_new (gboolean use_mipmapping)
+pango_clutter_glyph_cache_new (void)
 {
   PangoClutterGlyphCache *cache;
 
@@ -193,7 +206,7 @@ pango_clutter_glyph_cache_new (gboolean use_mipmapping)
 
   cache->textures = NULL;
   cache->bands = NULL;
-  cache->use_mipmapping = use_mipmapping;
+  cache->pending_bands = NULL;
 
   return cache;
 }
@@ -205,6 +218,8 @@ pango_clutter_glyph_cache_clear (PangoClutterGlyphCache *cache)
   cache->textures = NULL;
   pango_clutter_glyph_cache_free_bands (cache->bands);
   cache->bands = NULL;
+  g_slist_free (cache->pending_bands);
+  cache->pending_bands = NULL;
 
   g_hash_table_remove_all (cache->hash_table);
 }
@@ -248,6 +263,7 @@ pango_clutter_glyph_cache_set (PangoClutterGlyphCache *cache,
   PangoClutterGlyphCacheBand  *band;
   PangoClutterGlyphCacheKey   *key;
   PangoClutterGlyphCacheValue *value;
+  int                          y;
 
   /* Reserve an extra pixel gap around the glyph so that it can pull
      in blank pixels when linear filtering is enabled */
@@ -290,26 +306,25 @@ pango_clutter_glyph_cache_set (PangoClutterGlyphCache *cache,
 	  clear_data = g_malloc0 (texture->texture_size
 				  * texture->texture_size);
 
+	  /* Mipmaps are only added once the texture is drawn scaled
+	     down, see pango_clutter_glyph_cache_update_filters() */
 	  texture->texture = cogl_texture_new_from_data
 	    (texture->texture_size, texture->texture_size,
-	     32, cache->use_mipmapping,
+	     32, FALSE,
 	     COGL_PIXEL_FORMAT_A_8, COGL_PIXEL_FORMAT_A_8,
 	     texture->texture_size, clear_data);
 
 	  g_free (clear_data);
 
 	  texture->space_remaining = texture->texture_size;
+	  texture->has_mipmaps = FALSE;
+	  texture->mipmap_filters = FALSE;
 	  texture->next = cache->textures;
 	  cache->textures = texture;
 
-	  if (cache->use_mipmapping)
-	    cogl_texture_set_filters (texture->texture,
-				      CGL_LINEAR_MIPMAP_LINEAR,
-				      CGL_LINEAR);
-	  else
-	    cogl_texture_set_filters (texture->texture,
-				      CGL_LINEAR,
-				      CGL_LINEAR);
+	  cogl_texture_set_filters (texture->texture,
+				    CGL_LINEAR,
+				    CGL_LINEAR);
 	}
 
       band = g_slice_new (PangoClutterGlyphCacheBand);
@@ -318,25 +333,33 @@ pango_clutter_glyph_cache_set (PangoClutterGlyphCache *cache,
       band->space_remaining = texture->texture_size;
       band->texture = cogl_texture_ref (texture->texture);
       band->texture_size = texture->texture_size;
+      band->pending = NULL;
+      band->pending_end = 0;
       band->next = cache->bands;
       cache->bands = band;
       texture->space_remaining -= band_height;
     }
 
+  /* Keep the glyph in a copy of the band instead of uploading it
+     straight away so that a whole batch of glyphs only costs one
+     upload per band. The copy starts out clear so the gap around
+     each glyph stays blank */
+  if (band->pending == NULL)
+    {
+      band->pending = g_malloc0 (band->texture_size * band->height);
+      band->pending_end = band->space_remaining;
+      cache->pending_bands = g_slist_prepend (cache->pending_bands, band);
+    }
+
   band->space_remaining -= width;
 
   width--;
   height--;
 
-  cogl_texture_set_region (band->texture,
-			   0, 0,
-			   band->space_remaining,
-			   band->top,
-			   width, height,
-			   width, height,
-			   COGL_PIXEL_FORMAT_A_8,
-			   stride,
-			   pixels);
+  for (y = 0; y < height; y++)
+    memcpy (band->pending + y * band->texture_size + band->space_remaining,
+	    (const guchar *) pixels + y * stride,
+	    width);
 
   key = g_slice_new (PangoClutterGlyphCacheKey);
   key->font = g_object_ref (font);
@@ -360,3 +383,78 @@ pango_clutter_glyph_cache_set (PangoClutterGlyphCache *cache,
 
   return value;
 }
+
+void
+pango_clutter_glyph_cache_flush (PangoClutterGlyphCache *cache)
+{
+  GSList *l;
+
+  for (l = cache->pending_bands; l; l = l->next)
+    {
+      PangoClutterGlyphCacheBand *band = l->data;
+
+      cogl_texture_set_region (band->texture,
+			       band->space_remaining, 0,
+			       band->space_remaining,
+			       band->top,
+			       band->pending_end - band->space_remaining,
+			       band->height,
+			       band->texture_size, band->height,
+			       COGL_PIXEL_FORMAT_A_8,
+			       band->texture_size,
+			       band->pending);
+
+      g_free (band->pending);
+      band->pending = NULL;
+    }
+
+  g_slist_free (cache->pending_bands);
+  cache->pending_bands = NULL;
+}
+
+void
+pango_clutter_glyph_cache_update_filters (PangoClutterGlyphCache *cache,
+					  CoglHandle              texture,
+					  gboolean                use_mipmapping,
+					  gboolean                scaled_down)
+{
+  PangoClutterGlyphCacheTexture *node;
+  gboolean mipmap_filters;
+
+  for (node = cache->textures;
+       node && node->texture != texture;
+       node = node->next);
+  if (node == NULL)
+    return;
+
+  if (use_mipmapping && scaled_down && !node->has_mipmaps
+      && cogl_texture_set_auto_mipmap (node->texture, TRUE))
+    {
+      static const guchar blank = 0;
+
+      /* The levels are built by the next change to the texture, so
+	 rewrite the bottom right texel, which is always in the gap
+	 left around the glyphs of a band or below the last band */
+      cogl_texture_set_region (node->texture,
+			       0, 0,
+			       node->texture_size - 1,
+			       node->texture_size - 1,
+			       1, 1,
+			       1, 1,
+			       COGL_PIXEL_FORMAT_A_8,
+			       1,
+			       &blank);
+      node->has_mipmaps = TRUE;
+    }
+
+  mipmap_filters = use_mipmapping && node->has_mipmaps;
+
+  if (node->mipmap_filters != mipmap_filters)
+    {
+      cogl_texture_set_filters (node->texture,
+				mipmap_filters
+				? CGL_LINEAR_MIPMAP_LINEAR : CGL_LINEAR,
+				CGL_LINEAR);
+      node->mipmap_filters = mipmap_filters;
+    }
+}
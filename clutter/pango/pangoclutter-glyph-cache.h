@@ -42,7 +42,7 @@ struct _PangoClutterGlyphCacheValue
   int          draw_x, draw_y, draw_width, draw_height;
 };
 
-PangoClutterGlyphCache *pango_clutter_glyph_cache_new (gboolean use_mipmapping);
+PangoClutterGlyphCache *pango_clutter_glyph_cache_new (void);
 
 void pango_clutter_glyph_cache_free (PangoClutterGlyphCache *cache);
 
@@ -51,6 +51,9 @@ pango_clutter_glyph_cache_lookup (PangoClutterGlyphCache *cache,
 				  PangoFont              *font,
 				  PangoGlyph              glyph);
 
+/* The glyph is only uploaded to its texture by
+   pango_clutter_glyph_cache_flush(), which must be called before the
+   returned value is drawn */
 PangoClutterGlyphCacheValue *
 pango_clutter_glyph_cache_set (PangoClutterGlyphCache *cache,
 			       PangoFont              *font,
@@ -62,6 +65,16 @@ pango_clutter_glyph_cache_set (PangoClutterGlyphCache *cache,
 			       int                     draw_x,
 			       int                     draw_y);
 
+void pango_clutter_glyph_cache_flush (PangoClutterGlyphCache *cache);
+
+/* Sets up the filters to draw from one of the textures of the cache,
+   giving it mipmaps the first time it is drawn scaled down with
+   mipmapping enabled */
+void pango_clutter_glyph_cache_update_filters (PangoClutterGlyphCache *cache,
+					       CoglHandle              texture,
+					       gboolean                use_mipmapping,
+					       gboolean                scaled_down);
+
 void pango_clutter_glyph_cache_clear (PangoClutterGlyphCache *cache);
 
 G_END_DECLS
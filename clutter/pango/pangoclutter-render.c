@@ -35,12 +35,14 @@
 #include <pango/pangocairo.h>
 #include <pango/pango-renderer.h>
 #include <cairo/cairo.h>
+#include <math.h>
 
 #include "pangoclutter.h"
 #include "pangoclutter-private.h"
 #include "pangoclutter-glyph-cache.h"
 #include "../clutter-debug.h"
 #include "cogl/cogl.h"
+#include "cogl/common/cogl-util.h"
 
 struct _PangoClutterRenderer
 {
@@ -49,17 +51,41 @@ struct _PangoClutterRenderer
   /* The color to draw the glyphs with */
   ClutterColor color;
 
-  /* Two caches of glyphs as textures, one with mipmapped textures and
-     one without */
+  /* The cache of glyphs as textures. It is shared by mipmapped and
+     plain text, its textures get mipmaps when they are first drawn
+     scaled down with use_mipmapping set */
   PangoClutterGlyphCache *glyph_cache;
-  PangoClutterGlyphCache *mipmapped_glyph_cache;
 
   gboolean use_mipmapping;
+
+  /* Whether the layout being drawn is scaled down on screen, only
+     worked out when use_mipmapping is set */
+  gboolean scaled_down;
   
   /* An array of vertices that will be passed to COGL to be drawn.
    * we don't want to reallocate these each time so we cache them here. */
   CoglTextureVertex *glyph_vertices;
   int glyph_vertices_size;
+
+  /* The cache entries of the glyphs being drawn, looked up before
+   * drawing so that all of the misses can be uploaded at once */
+  PangoClutterGlyphCacheValue **glyph_values;
+  int glyph_values_size;
+
+  /* Glyphs are rasterised into this surface, which is kept around and
+   * only grows, instead of one new surface per glyph */
+  cairo_t *scratch_cr;
+
+  /* Glyphs are rasterised ahead of painting by a pool of threads.
+   * glyph_jobs holds the jobs not yet added to a cache, which the
+   * threads push to glyph_jobs_done when they are finished. The
+   * generation is increased when the caches are cleared so that late
+   * results are thrown away. The pool is NULL if threads are not
+   * available */
+  GThreadPool *glyph_pool;
+  GAsyncQueue *glyph_jobs_done;
+  GHashTable  *glyph_jobs;
+  guint        glyph_generation;
 };
 
 struct _PangoClutterRendererClass
@@ -67,6 +93,26 @@ struct _PangoClutterRendererClass
   PangoRendererClass class_instance;
 };
 
+/* Number of threads rasterising glyphs ahead of painting */
+#define PANGO_CLUTTER_GLYPH_THREADS 2
+
+typedef struct _PangoClutterGlyphJob PangoClutterGlyphJob;
+
+/* A glyph handed to the rasterising threads. Only the result fields
+ * are written by the thread */
+struct _PangoClutterGlyphJob
+{
+  PangoClutterGlyphCache *cache;
+  guint                   generation;
+  PangoFont              *font;
+  PangoGlyph              glyph;
+  cairo_scaled_font_t    *scaled_font;
+
+  /* result */
+  cairo_surface_t        *surface;
+  int                     x, y;
+};
+
 #define CLUTTER_PANGO_UNIT_TO_FIXED(x) ((x) << (CFX_Q - 10))
 
 static void pango_clutter_renderer_finalize (GObject *object);
@@ -92,18 +138,100 @@ static void pango_clutter_renderer_draw_trapezoid (PangoRenderer    *renderer,
 
 static GObjectClass *parent_class = NULL;
 
+static void
+pango_clutter_glyph_job_free (PangoClutterGlyphJob *job)
+{
+  g_object_unref (job->font);
+  cairo_scaled_font_destroy (job->scaled_font);
+  if (job->surface)
+    cairo_surface_destroy (job->surface);
+  g_slice_free (PangoClutterGlyphJob, job);
+}
+
+static guint
+pango_clutter_glyph_job_hash (gconstpointer key)
+{
+  const PangoClutterGlyphJob *job = key;
+
+  return GPOINTER_TO_UINT (job->font) ^ GPOINTER_TO_UINT (job->cache)
+    ^ job->glyph;
+}
+
+static gboolean
+pango_clutter_glyph_job_equal (gconstpointer a,
+			       gconstpointer b)
+{
+  const PangoClutterGlyphJob *job_a = a;
+  const PangoClutterGlyphJob *job_b = b;
+
+  return job_a->font == job_b->font
+    && job_a->glyph == job_b->glyph
+    && job_a->cache == job_b->cache;
+}
+
+/* Runs in one of the rasterising threads. This only touches cairo,
+ * which is thread safe, and the job itself. The extents are taken
+ * from cairo as PangoCairo does for its glyph extents */
+static void
+pango_clutter_glyph_job_run (gpointer data,
+			     gpointer user_data)
+{
+  PangoClutterGlyphJob *job = data;
+  PangoClutterRenderer *priv = user_data;
+  cairo_text_extents_t extents;
+  cairo_glyph_t cairo_glyph;
+  cairo_t *cr;
+  int width, height;
+
+  cairo_glyph.index = job->glyph;
+  cairo_glyph.x = 0;
+  cairo_glyph.y = 0;
+  cairo_scaled_font_glyph_extents (job->scaled_font, &cairo_glyph, 1,
+				   &extents);
+
+  job->x = floor (extents.x_bearing);
+  job->y = floor (extents.y_bearing);
+  width = (int) ceil (extents.x_bearing + extents.width) - job->x;
+  height = (int) ceil (extents.y_bearing + extents.height) - job->y;
+
+  job->surface = cairo_image_surface_create (CAIRO_FORMAT_A8,
+					     MAX (width, 0),
+					     MAX (height, 0));
+  cr = cairo_create (job->surface);
+  cairo_set_scaled_font (cr, job->scaled_font);
+
+  cairo_glyph.x = -job->x;
+  cairo_glyph.y = -job->y;
+  cairo_show_glyphs (cr, &cairo_glyph, 1);
+
+  cairo_destroy (cr);
+  cairo_surface_flush (job->surface);
+
+  g_async_queue_push (priv->glyph_jobs_done, job);
+}
+
 G_DEFINE_TYPE (PangoClutterRenderer, pango_clutter_renderer,
 	       PANGO_TYPE_RENDERER);
 
 static void
 pango_clutter_renderer_init (PangoClutterRenderer *priv)
 {
-  priv->glyph_cache = pango_clutter_glyph_cache_new (FALSE);
-  priv->mipmapped_glyph_cache = pango_clutter_glyph_cache_new (TRUE);
+  priv->glyph_cache = pango_clutter_glyph_cache_new ();
   priv->use_mipmapping = FALSE;
+  priv->scaled_down = FALSE;
   
   priv->glyph_vertices_size = 0;
   priv->glyph_vertices = 0;  
+
+  priv->glyph_values_size = 0;
+  priv->glyph_values = NULL;
+
+  priv->scratch_cr = NULL;
+
+  priv->glyph_pool = NULL;
+  priv->glyph_jobs_done = NULL;
+  priv->glyph_jobs = NULL;
+  priv->glyph_generation = 0;
 }
 
 static void
@@ -126,15 +254,65 @@ pango_clutter_renderer_finalize (GObject *object)
 {
   PangoClutterRenderer *priv = PANGO_CLUTTER_RENDERER (object);
 
-  pango_clutter_glyph_cache_free (priv->mipmapped_glyph_cache);
+  if (priv->glyph_pool)
+    {
+      PangoClutterGlyphJob *job;
+
+      /* Let the threads finish the queued glyphs and throw them away */
+      g_thread_pool_free (priv->glyph_pool, FALSE, TRUE);
+
+      while ((job = g_async_queue_try_pop (priv->glyph_jobs_done)))
+	pango_clutter_glyph_job_free (job);
+
+      g_async_queue_unref (priv->glyph_jobs_done);
+      g_hash_table_destroy (priv->glyph_jobs);
+    }
+
   pango_clutter_glyph_cache_free (priv->glyph_cache);
   
   if (priv->glyph_vertices)
     g_free(priv->glyph_vertices);
 
+  g_free (priv->glyph_values);
+
+  if (priv->scratch_cr)
+    cairo_destroy (priv->scratch_cr);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+/* Whether the current transformation draws text smaller than its
+ * size, by projecting a square and comparing its edges */
+static gboolean
+pango_clutter_renderer_is_scaled_down (void)
+{
+  static const float square[4] = { 0, 0, 64, 64 };
+  float mtx[16], mtx_p[16], viewport[4], corners[12];
+  float dx, dy, top, left;
+  ClutterFixed v[4];
+  int i;
+
+  cogl_get_modelview_matrix_f (mtx);
+  cogl_get_projection_matrix_f (mtx_p);
+  cogl_get_viewport (v);
+
+  for (i = 0; i < 4; i++)
+    viewport[i] = CLUTTER_FIXED_TO_FLOAT (v[i]);
+
+  cogl_util_project_boxes (mtx, mtx_p, viewport, square, 1, corners);
+
+  /* corners 0 and 1 make the top edge, 0 and 2 the left one */
+  dx = corners[1] - corners[0];
+  dy = corners[5] - corners[4];
+  top = dx * dx + dy * dy;
+  dx = corners[2] - corners[0];
+  dy = corners[6] - corners[4];
+  left = dx * dx + dy * dy;
+
+  /* allow for some rounding */
+  return top < 63 * 63 || left < 63 * 63;
+}
+
 void
 pango_clutter_render_layout_subpixel (PangoLayout  *layout,
 				      int           x,
@@ -155,6 +333,8 @@ pango_clutter_render_layout_subpixel (PangoLayout  *layout,
   priv = PANGO_CLUTTER_RENDERER (renderer);
 
   priv->color = *color;
+  priv->scaled_down = priv->use_mipmapping
+    && pango_clutter_renderer_is_scaled_down ();
 
   pango_renderer_draw_layout (renderer, layout, x, y);
 }
@@ -192,6 +372,8 @@ pango_clutter_render_layout_line (PangoLayoutLine  *line,
   priv = PANGO_CLUTTER_RENDERER (renderer);
 
   priv->color = *color;
+  priv->scaled_down = priv->use_mipmapping
+    && pango_clutter_renderer_is_scaled_down ();
 
   pango_renderer_draw_layout_line (renderer, line, x, y);
 }
@@ -199,8 +381,10 @@ pango_clutter_render_layout_line (PangoLayoutLine  *line,
 void
 _pango_clutter_renderer_clear_glyph_cache (PangoClutterRenderer *renderer)
 {
+  /* glyphs still being rasterised are thrown away when they are done */
+  renderer->glyph_generation++;
+
   pango_clutter_glyph_cache_clear (renderer->glyph_cache);
-  pango_clutter_glyph_cache_clear (renderer->mipmapped_glyph_cache);
 }
 
 void
@@ -216,6 +400,182 @@ _pango_clutter_renderer_get_use_mipmapping (PangoClutterRenderer *renderer)
   return renderer->use_mipmapping;
 }
 
+static PangoClutterGlyphCache *
+pango_clutter_renderer_get_glyph_cache (PangoClutterRenderer *priv)
+{
+  return priv->glyph_cache;
+}
+
+/* Returns a cairo context on an A8 surface at least width x height
+ * pixels big */
+static cairo_t *
+pango_clutter_renderer_get_scratch (PangoClutterRenderer *priv,
+				    int                   width,
+				    int                   height)
+{
+  cairo_surface_t *surface;
+  int old_width = 0, old_height = 0;
+
+  if (priv->scratch_cr)
+    {
+      surface = cairo_get_target (priv->scratch_cr);
+      old_width = cairo_image_surface_get_width (surface);
+      old_height = cairo_image_surface_get_height (surface);
+
+      if (width <= old_width && height <= old_height)
+	return priv->scratch_cr;
+
+      cairo_destroy (priv->scratch_cr);
+    }
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_A8,
+					MAX (MAX (width, old_width), 64),
+					MAX (MAX (height, old_height), 64));
+  priv->scratch_cr = cairo_create (surface);
+  cairo_surface_destroy (surface);
+
+  return priv->scratch_cr;
+}
+
+/* Returns the pool of threads rasterising glyphs, creating it the
+ * first time, or NULL if threads are not available */
+static GThreadPool *
+pango_clutter_renderer_get_glyph_pool (PangoClutterRenderer *priv)
+{
+  if (priv->glyph_pool == NULL && g_thread_supported ())
+    {
+      GError *error = NULL;
+
+      priv->glyph_pool = g_thread_pool_new (pango_clutter_glyph_job_run,
+					    priv,
+					    PANGO_CLUTTER_GLYPH_THREADS,
+					    FALSE,
+					    &error);
+      if (priv->glyph_pool == NULL)
+	{
+	  g_warning ("Unable to rasterise glyphs in threads: %s",
+		     error->message);
+	  g_error_free (error);
+	  return NULL;
+	}
+
+      priv->glyph_jobs_done = g_async_queue_new ();
+      priv->glyph_jobs = g_hash_table_new (pango_clutter_glyph_job_hash,
+					   pango_clutter_glyph_job_equal);
+    }
+
+  return priv->glyph_pool;
+}
+
+/* Places a glyph rasterised by a thread in its cache */
+static void
+pango_clutter_renderer_add_job (PangoClutterRenderer *priv,
+				PangoClutterGlyphJob *job)
+{
+  g_hash_table_remove (priv->glyph_jobs, job);
+
+  if (job->generation == priv->glyph_generation
+      && pango_clutter_glyph_cache_lookup (job->cache, job->font,
+					   job->glyph) == NULL)
+    {
+      pango_clutter_glyph_cache_set
+	(job->cache, job->font, job->glyph,
+	 cairo_image_surface_get_data (job->surface),
+	 cairo_image_surface_get_width (job->surface),
+	 cairo_image_surface_get_height (job->surface),
+	 cairo_image_surface_get_stride (job->surface),
+	 job->x, job->y);
+
+      CLUTTER_NOTE (PANGO, "cache add     %i", job->glyph);
+    }
+
+  pango_clutter_glyph_job_free (job);
+}
+
+/* Places all of the glyphs the threads have finished so far. They
+ * still need to be flushed */
+static void
+pango_clutter_renderer_collect_jobs (PangoClutterRenderer *priv)
+{
+  PangoClutterGlyphJob *job;
+
+  if (priv->glyph_pool == NULL)
+    return;
+
+  while ((job = g_async_queue_try_pop (priv->glyph_jobs_done)))
+    pango_clutter_renderer_add_job (priv, job);
+}
+
+/* Waits for a glyph that is being rasterised by a thread, if there is
+ * one, placing every glyph finished in the meantime */
+static void
+pango_clutter_renderer_wait_job (PangoClutterRenderer   *priv,
+				 PangoClutterGlyphCache *cache,
+				 PangoFont              *font,
+				 PangoGlyph              glyph)
+{
+  PangoClutterGlyphJob key, *job, *done;
+
+  if (priv->glyph_pool == NULL)
+    return;
+
+  key.cache = cache;
+  key.font = font;
+  key.glyph = glyph;
+
+  if ((job = g_hash_table_lookup (priv->glyph_jobs, &key)) == NULL)
+    return;
+
+  CLUTTER_NOTE (PANGO, "cache wait    %i", glyph);
+
+  do
+    {
+      done = g_async_queue_pop (priv->glyph_jobs_done);
+      pango_clutter_renderer_add_job (priv, done);
+    }
+  while (done != job);
+}
+
+/* Hands a glyph to the threads unless it is cached or already on its
+ * way */
+static void
+pango_clutter_renderer_queue_glyph (PangoClutterRenderer *priv,
+				    PangoFont            *font,
+				    PangoGlyph            glyph)
+{
+  PangoClutterGlyphCache *glyph_cache;
+  PangoClutterGlyphJob key, *job;
+
+  glyph_cache = pango_clutter_renderer_get_glyph_cache (priv);
+
+  if (pango_clutter_glyph_cache_lookup (glyph_cache, font, glyph))
+    return;
+
+  key.cache = glyph_cache;
+  key.font = font;
+  key.glyph = glyph;
+
+  if (g_hash_table_lookup (priv->glyph_jobs, &key))
+    return;
+
+  job = g_slice_new (PangoClutterGlyphJob);
+  job->cache = glyph_cache;
+  job->generation = priv->glyph_generation;
+  job->font = g_object_ref (font);
+  job->glyph = glyph;
+  job->scaled_font = cairo_scaled_font_reference
+    (pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (font)));
+  job->surface = NULL;
+
+  g_hash_table_insert (priv->glyph_jobs, job, job);
+  g_thread_pool_push (priv->glyph_pool, job, NULL);
+
+  CLUTTER_NOTE (PANGO, "cache queue   %i", glyph);
+}
+
+/* Looks up a glyph, rasterising it into the cache on a miss. The
+ * rasterised glyphs only reach their textures with
+ * pango_clutter_renderer_flush_glyphs() */
 static PangoClutterGlyphCacheValue *
 pango_clutter_renderer_get_cached_glyph (PangoRenderer *renderer,
 					 PangoFont     *font,
@@ -225,12 +585,19 @@ pango_clutter_renderer_get_cached_glyph (PangoRenderer *renderer,
   PangoClutterGlyphCacheValue *value;
   PangoClutterGlyphCache *glyph_cache;
 
-  glyph_cache = priv->use_mipmapping
-    ? priv->mipmapped_glyph_cache : priv->glyph_cache;
+  glyph_cache = pango_clutter_renderer_get_glyph_cache (priv);
 
-  if ((value = pango_clutter_glyph_cache_lookup (glyph_cache,
-						 font,
-						 glyph)) == NULL)
+  value = pango_clutter_glyph_cache_lookup (glyph_cache, font, glyph);
+
+  /* A thread may already be rasterising it, in which case it is
+     cheaper to wait for it than to start over */
+  if (value == NULL)
+    {
+      pango_clutter_renderer_wait_job (priv, glyph_cache, font, glyph);
+      value = pango_clutter_glyph_cache_lookup (glyph_cache, font, glyph);
+    }
+
+  if (value == NULL)
     {
       cairo_surface_t *surface;
       cairo_t *cr;
@@ -241,10 +608,20 @@ pango_clutter_renderer_get_cached_glyph (PangoRenderer *renderer,
       pango_font_get_glyph_extents (font, glyph, &ink_rect, NULL);
       pango_extents_to_pixels (&ink_rect, NULL);
 
-      surface = cairo_image_surface_create (CAIRO_FORMAT_A8,
-					    ink_rect.width,
-					    ink_rect.height);
-      cr = cairo_create (surface);
+      cr = pango_clutter_renderer_get_scratch (priv,
+					       ink_rect.width,
+					       ink_rect.height);
+      surface = cairo_get_target (cr);
+
+      cairo_save (cr);
+
+      /* Only draw to and clear the part of the surface used by this
+	 glyph, so nothing is left over from the previous one */
+      cairo_rectangle (cr, 0, 0, ink_rect.width, ink_rect.height);
+      cairo_clip (cr);
+      cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+      cairo_paint (cr);
+      cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
 
       scaled_font = pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (font));
       cairo_set_scaled_font (cr, scaled_font);
@@ -256,20 +633,18 @@ pango_clutter_renderer_get_cached_glyph (PangoRenderer *renderer,
       cairo_glyph.index = glyph;
       cairo_show_glyphs (cr, &cairo_glyph, 1);
 
-      cairo_destroy (cr);
+      cairo_restore (cr);
       cairo_surface_flush (surface);
 
       /* Copy the glyph to the cache */
       value = pango_clutter_glyph_cache_set
 	(glyph_cache, font, glyph,
 	 cairo_image_surface_get_data (surface),
-	 cairo_image_surface_get_width (surface),
-	 cairo_image_surface_get_height (surface),
+	 ink_rect.width,
+	 ink_rect.height,
 	 cairo_image_surface_get_stride (surface),
 	 ink_rect.x, ink_rect.y);
 
-      cairo_surface_destroy (surface);
-
       CLUTTER_NOTE (PANGO, "cache fail    %i", glyph);
     }
   else
@@ -278,22 +653,39 @@ pango_clutter_renderer_get_cached_glyph (PangoRenderer *renderer,
   return value;
 }
 
-void
-pango_clutter_ensure_glyph_cache_for_layout (PangoLayout *layout)
+/* Uploads the glyphs rasterised since the last flush, one region per
+ * band of the cache */
+static void
+pango_clutter_renderer_flush_glyphs (PangoClutterRenderer *priv)
 {
-  PangoContext    *context;
-  PangoFontMap    *fontmap;
-  PangoRenderer   *renderer;
-  PangoLayoutIter *iter;
- 
-  g_return_if_fail (PANGO_IS_LAYOUT (layout));
- 
+  pango_clutter_glyph_cache_flush
+    (pango_clutter_renderer_get_glyph_cache (priv));
+}
+
+/* Returns the renderer drawing @layout */
+static PangoClutterRenderer *
+pango_clutter_renderer_for_layout (PangoLayout *layout)
+{
+  PangoContext *context;
+  PangoFontMap *fontmap;
+
   context = pango_layout_get_context (layout);
   fontmap = pango_context_get_font_map (context);
-  g_return_if_fail (PANGO_CLUTTER_IS_FONT_MAP (fontmap));
-  renderer = _pango_clutter_font_map_get_renderer
-    (PANGO_CLUTTER_FONT_MAP (fontmap));
- 
+  g_return_val_if_fail (PANGO_CLUTTER_IS_FONT_MAP (fontmap), NULL);
+
+  return PANGO_CLUTTER_RENDERER (_pango_clutter_font_map_get_renderer
+				 (PANGO_CLUTTER_FONT_MAP (fontmap)));
+}
+
+/* Rasterises the missing glyphs of @layout into the cache, or only
+ * hands them to the threads if @use_threads is set */
+static void
+pango_clutter_renderer_cache_layout (PangoClutterRenderer *priv,
+				     PangoLayout          *layout,
+				     gboolean              use_threads)
+{
+  PangoLayoutIter *iter;
+
   if ((iter = pango_layout_get_iter (layout)) == NULL)
     return;
  
@@ -317,9 +709,13 @@ pango_clutter_ensure_glyph_cache_for_layout (PangoLayout *layout)
               if (!run->item->analysis.font)
                 /* Font not found */
                 continue;
-	      pango_clutter_renderer_get_cached_glyph (renderer,
-						       run->item->analysis.font,
-						       gi->glyph);
+
+	      if (!use_threads)
+		pango_clutter_renderer_get_cached_glyph
+		  (PANGO_RENDERER (priv), run->item->analysis.font, gi->glyph);
+	      else if (!(gi->glyph & PANGO_GLYPH_UNKNOWN_FLAG))
+		pango_clutter_renderer_queue_glyph
+		  (priv, run->item->analysis.font, gi->glyph);
             }
         }
     }
@@ -328,6 +724,46 @@ pango_clutter_ensure_glyph_cache_for_layout (PangoLayout *layout)
   pango_layout_iter_free (iter);
 }
 
+/* Gets the glyphs of @layout into the cache. When threads are
+ * available the missing glyphs are only handed to them, so that they
+ * are ready by the time the layout is painted */
+void
+pango_clutter_ensure_glyph_cache_for_layout (PangoLayout *layout)
+{
+  PangoClutterRenderer *priv;
+  gboolean              use_threads;
+ 
+  g_return_if_fail (PANGO_IS_LAYOUT (layout));
+
+  priv = pango_clutter_renderer_for_layout (layout);
+  if (priv == NULL)
+    return;
+
+  use_threads = pango_clutter_renderer_get_glyph_pool (priv) != NULL;
+  pango_clutter_renderer_collect_jobs (priv);
+
+  pango_clutter_renderer_cache_layout (priv, layout, use_threads);
+
+  pango_clutter_renderer_flush_glyphs (priv);
+}
+
+/* Hands the missing glyphs of @layout to the threads, without ever
+ * rasterising or uploading anything itself; does nothing when threads
+ * are not available */
+void
+pango_clutter_queue_glyphs_for_layout (PangoLayout *layout)
+{
+  PangoClutterRenderer *priv;
+
+  g_return_if_fail (PANGO_IS_LAYOUT (layout));
+
+  priv = pango_clutter_renderer_for_layout (layout);
+  if (priv == NULL || pango_clutter_renderer_get_glyph_pool (priv) == NULL)
+    return;
+
+  pango_clutter_renderer_cache_layout (priv, layout, TRUE);
+}
+
 static void
 pango_clutter_renderer_set_color_for_part (PangoRenderer   *renderer,
 					   PangoRenderPart  part)
@@ -454,6 +890,33 @@ pango_clutter_renderer_draw_glyphs (PangoRenderer    *renderer,
           g_malloc(sizeof(CoglTextureVertex)*priv->glyph_vertices_size);  
     }  
 
+  if (priv->glyph_values_size < glyphs->num_glyphs)
+    {
+      priv->glyph_values_size = 2 * glyphs->num_glyphs;
+      g_free (priv->glyph_values);
+      priv->glyph_values = g_new (PangoClutterGlyphCacheValue *,
+				  priv->glyph_values_size);
+    }
+
+  /* Get the textures containing the glyphs first. This creates the
+     cache entries of the missing glyphs, which are then uploaded
+     together with the ones the threads have finished */
+  pango_clutter_renderer_collect_jobs (priv);
+
+  for (i = 0; i < glyphs->num_glyphs; i++)
+    {
+      PangoGlyphInfo *gi = glyphs->glyphs + i;
+
+      if ((gi->glyph & PANGO_GLYPH_UNKNOWN_FLAG))
+	priv->glyph_values[i] = NULL;
+      else
+	priv->glyph_values[i]
+	  = pango_clutter_renderer_get_cached_glyph (renderer, font,
+						     gi->glyph);
+    }
+
+  pango_clutter_renderer_flush_glyphs (priv);
+
   pango_clutter_renderer_set_color_for_part (renderer,
 					     PANGO_RENDER_PART_FOREGROUND);
 
@@ -491,11 +954,7 @@ pango_clutter_renderer_draw_glyphs (PangoRenderer    *renderer,
 	}
       else
 	{
-	  /* Get the texture containing the glyph. This will create
-	     the cache entry if there isn't already one */
-	  cache_value
-	    = pango_clutter_renderer_get_cached_glyph (renderer, font,
-						       gi->glyph);
+	  cache_value = priv->glyph_values[i];
 
 	  if (cache_value == NULL)
 	    pango_clutter_renderer_draw_box (CLUTTER_FIXED_TO_INT (x),
@@ -517,6 +976,10 @@ pango_clutter_renderer_draw_glyphs (PangoRenderer    *renderer,
                                               FALSE );
                   glyph_vert_count = 0;
                   current_texture = cache_value->texture;
+
+                  pango_clutter_glyph_cache_update_filters
+                    (priv->glyph_cache, current_texture,
+                     priv->use_mipmapping, priv->scaled_down);
                 }
               
 	      x += CLUTTER_INT_TO_FIXED (cache_value->draw_x);
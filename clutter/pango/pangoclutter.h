@@ -61,6 +61,7 @@ void     pango_clutter_font_map_set_use_mipmapping (PangoClutterFontMap *fm,
 gboolean pango_clutter_font_map_get_use_mipmapping (PangoClutterFontMap *fm);
 
 void pango_clutter_ensure_glyph_cache_for_layout (PangoLayout *layout);
+void pango_clutter_queue_glyphs_for_layout       (PangoLayout *layout);
 
 #define PANGO_CLUTTER_TYPE_RENDERER (pango_clutter_renderer_get_type ())
 
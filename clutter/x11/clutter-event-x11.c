@@ -942,6 +942,10 @@ clutter_event_dispatch (GSource     *source,
 
   if (event)
     {
+      _clutter_record_wakeup (event->type == CLUTTER_MOTION
+                              ? CLUTTER_WAKEUP_MOTION
+                              : CLUTTER_WAKEUP_EVENT);
+
       /* forward the event into clutter for emission etc. */
       clutter_do_event (event);
       clutter_event_free (event);
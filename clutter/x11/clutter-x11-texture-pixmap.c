@@ -94,6 +94,9 @@ static void
 clutter_x11_texture_pixmap_destroyed (ClutterX11TexturePixmap *texture);
 static void
 clutter_x11_texture_pixmap_paint (ClutterActor *self);
+static gboolean
+clutter_x11_texture_pixmap_get_opaque_area (ClutterActor    *self,
+                                            ClutterActorBox *box);
 
 static guint signals[LAST_SIGNAL] = { 0, };
 
@@ -552,6 +555,7 @@ clutter_x11_texture_pixmap_class_init (ClutterX11TexturePixmapClass *klass)
   klass->update_area         = clutter_x11_texture_pixmap_update_area_real;
 
   actor_class->paint = clutter_x11_texture_pixmap_paint;
+  actor_class->get_opaque_area = clutter_x11_texture_pixmap_get_opaque_area;
 
   pspec = g_param_spec_uint ("pixmap",
                              "Pixmap",
@@ -1398,6 +1402,29 @@ clutter_x11_texture_pixmap_paint (ClutterActor *self)
     }
 }
 
+static gboolean
+clutter_x11_texture_pixmap_get_opaque_area (ClutterActor    *self,
+                                            ClutterActorBox *box)
+{
+  ClutterX11TexturePixmapPrivate *priv =
+    CLUTTER_X11_TEXTURE_PIXMAP (self)->priv;
+  ClutterActorClass *klass = CLUTTER_ACTOR_GET_CLASS (self);
+
+  /* a subclass painting something else only covers the same area if
+   * it says so, by overriding this function as well
+   */
+  if (klass->paint != clutter_x11_texture_pixmap_paint &&
+      klass->get_opaque_area == clutter_x11_texture_pixmap_get_opaque_area)
+    return FALSE;
+
+  /* a shaped window only paints its shapes */
+  if (priv->shapes)
+    return FALSE;
+
+  return CLUTTER_ACTOR_CLASS (clutter_x11_texture_pixmap_parent_class)->
+    get_opaque_area (self, box);
+}
+
 /* Remove all shapes and instead render this texture normally. see
  * clutter_x11_texture_pixmap_add_shape */
 void clutter_x11_texture_pixmap_clear_shapes(ClutterX11TexturePixmap *texture)
@@ -0,0 +1,205 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include "json/json-parser.h"
+
+#define N_OBJECTS       20000
+#define N_RUNS          10
+
+typedef struct
+{
+  guint n_objects;
+  guint n_members;
+  guint n_values;
+} Counts;
+
+static gboolean
+count_object_start (JsonParser *parser,
+                    gpointer    user_data)
+{
+  ((Counts *) user_data)->n_objects += 1;
+  return TRUE;
+}
+
+static gboolean
+count_object_member (JsonParser  *parser,
+                     const gchar *name,
+                     gsize        length,
+                     gpointer     user_data)
+{
+  ((Counts *) user_data)->n_members += 1;
+  return TRUE;
+}
+
+static gboolean
+count_int (JsonParser *parser,
+           gint64      value,
+           gpointer    user_data)
+{
+  ((Counts *) user_data)->n_values += 1;
+  return TRUE;
+}
+
+static gboolean
+count_double (JsonParser *parser,
+              gdouble     value,
+              gpointer    user_data)
+{
+  ((Counts *) user_data)->n_values += 1;
+  return TRUE;
+}
+
+static gboolean
+count_string (JsonParser  *parser,
+              const gchar *value,
+              gsize        length,
+              gpointer     user_data)
+{
+  ((Counts *) user_data)->n_values += 1;
+  return TRUE;
+}
+
+static gboolean
+count_boolean (JsonParser *parser,
+               gboolean    value,
+               gpointer    user_data)
+{
+  ((Counts *) user_data)->n_values += 1;
+  return TRUE;
+}
+
+static const JsonParserCallbacks count_callbacks = {
+  count_object_start,
+  count_object_member,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  count_boolean,
+  count_int,
+  count_double,
+  count_string
+};
+
+/* something that looks like a ClutterScript definition */
+static gchar *
+generate_document (gsize *length)
+{
+  GString *buf = g_string_new ("[\n");
+  gint i;
+
+  for (i = 0; i < N_OBJECTS; i++)
+    g_string_append_printf (buf,
+                            "  {\n"
+                            "    \"id\" : \"actor-%d\",\n"
+                            "    \"type\" : \"ClutterRectangle\",\n"
+                            "    \"x\" : %d, \"y\" : %d,\n"
+                            "    \"width\" : \"%d px\", \"height\" : %d,\n"
+                            "    \"opacity\" : %d,\n"
+                            "    \"visible\" : %s,\n"
+                            "    \"color\" : \"#ff%02x%02xff\",\n"
+                            "    \"scale\" : [ %.2f, %.2f ],\n"
+                            "    \"name\" : \"quoted \\\"name\\\" \\u00e8\",\n"
+                            "    \"signals\" : [\n"
+                            "      { \"name\" : \"button-press-event\","
+                            " \"handler\" : \"on_press\" }\n"
+                            "    ]\n"
+                            "  }%s\n",
+                            i,
+                            i % 800, i % 480,
+                            i % 100, i % 50,
+                            i % 256,
+                            (i % 2) ? "true" : "false",
+                            i % 256, (i * 7) % 256,
+                            1.0 + (i % 10) / 10.0, 0.5,
+                            i < N_OBJECTS - 1 ? "," : "");
+
+  g_string_append (buf, "]\n");
+
+  *length = buf->len;
+
+  return g_string_free (buf, FALSE);
+}
+
+int
+main (int argc, char *argv[])
+{
+  JsonParser *parser;
+  GTimer *timer;
+  GError *error = NULL;
+  gchar *data;
+  gsize length;
+  gdouble elapsed, mbytes;
+  Counts counts;
+  gint i;
+
+  g_type_init ();
+
+  if (argc > 1)
+    {
+      if (!g_file_get_contents (argv[1], &data, &length, &error))
+        {
+          g_printerr ("Unable to read `%s': %s\n", argv[1], error->message);
+          g_error_free (error);
+          return EXIT_FAILURE;
+        }
+    }
+  else
+    data = generate_document (&length);
+
+  mbytes = (gdouble) length * N_RUNS / (1024.0 * 1024.0);
+
+  g_print ("Parsing %" G_GSIZE_FORMAT " bytes, %d times\n", length, N_RUNS);
+
+  parser = json_parser_new ();
+  timer = g_timer_new ();
+
+  /* tree building */
+  g_timer_start (timer);
+
+  for (i = 0; i < N_RUNS; i++)
+    {
+      if (!json_parser_load_from_data (parser, data, length, &error))
+        {
+          g_printerr ("%s\n", error->message);
+          g_error_free (error);
+          return EXIT_FAILURE;
+        }
+    }
+
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_print ("tree:      %8.3f s, %8.2f MB/s\n", elapsed, mbytes / elapsed);
+
+  /* callbacks only */
+  memset (&counts, 0, sizeof (Counts));
+  g_timer_start (timer);
+
+  for (i = 0; i < N_RUNS; i++)
+    {
+      if (!json_parser_load_with_callbacks (parser, data, length,
+                                            &count_callbacks, &counts,
+                                            &error))
+        {
+          g_printerr ("%s\n", error->message);
+          g_error_free (error);
+          return EXIT_FAILURE;
+        }
+    }
+
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_print ("callbacks: %8.3f s, %8.2f MB/s "
+           "(%u objects, %u members, %u values)\n",
+           elapsed, mbytes / elapsed,
+           counts.n_objects / N_RUNS,
+           counts.n_members / N_RUNS,
+           counts.n_values / N_RUNS);
+
+  g_timer_destroy (timer);
+  g_object_unref (parser);
+  g_free (data);
+
+  return EXIT_SUCCESS;
+}
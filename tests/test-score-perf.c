@@ -0,0 +1,118 @@
+#include <stdlib.h>
+
+#include <clutter/clutter.h>
+
+#define N_ENTRIES       1000
+#define N_RUNS          10
+
+static guint n_started = 0;
+
+static void
+on_timeline_started (ClutterScore    *score,
+                     ClutterTimeline *timeline)
+{
+  n_started += 1;
+}
+
+/* a chain of N_ENTRIES timelines, where every other timeline is
+ * attached to the "half" marker of its parent instead of its end
+ */
+static ClutterScore *
+build_score (ClutterTimeline **timelines)
+{
+  ClutterScore *score;
+  gint i;
+
+  score = clutter_score_new ();
+  g_signal_connect (score, "timeline-started",
+                    G_CALLBACK (on_timeline_started),
+                    NULL);
+
+  clutter_score_append (score, NULL, timelines[0]);
+
+  for (i = 1; i < N_ENTRIES; i++)
+    {
+      if (i % 2)
+        clutter_score_append_at_marker (score,
+                                        timelines[i - 1], "half",
+                                        timelines[i]);
+      else
+        clutter_score_append (score, timelines[i - 1], timelines[i]);
+    }
+
+  return score;
+}
+
+int
+main (int argc, char *argv[])
+{
+  ClutterTimeline *timelines[N_ENTRIES];
+  ClutterScore *score;
+  GTimer *timer;
+  gdouble elapsed;
+  gint i, run;
+
+  clutter_init (&argc, &argv);
+
+  for (i = 0; i < N_ENTRIES; i++)
+    {
+      timelines[i] = clutter_timeline_new (60, 60);
+      clutter_timeline_add_marker_at_frame (timelines[i], "half", 30);
+    }
+
+  g_print ("Score with %d timelines, %d runs\n", N_ENTRIES, N_RUNS);
+
+  timer = g_timer_new ();
+
+  /* building the score looks up the parent of each new entry */
+  g_timer_start (timer);
+
+  for (run = 0; run < N_RUNS; run++)
+    g_object_unref (build_score (timelines));
+
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_print ("append:      %8.3f ms per score\n", elapsed * 1000.0 / N_RUNS);
+
+  /* walk the chain by emitting the signals the score waits for,
+   * without waiting for the timelines to actually run
+   */
+  score = build_score (timelines);
+  n_started = 0;
+
+  g_timer_start (timer);
+
+  for (run = 0; run < N_RUNS; run++)
+    {
+      clutter_score_start (score);
+
+      for (i = 0; i < N_ENTRIES - 1; i++)
+        {
+          if (i % 2 == 0)
+            g_signal_emit_by_name (timelines[i], "marker-reached::half",
+                                   "half", 30);
+          else
+            g_signal_emit_by_name (timelines[i], "completed");
+        }
+
+      clutter_score_stop (score);
+    }
+
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_print ("transitions: %8.3f us per transition (%u timelines started)\n",
+           elapsed * 1000000.0 / (N_RUNS * (N_ENTRIES - 1)),
+           n_started / N_RUNS);
+
+  /* removing the root removes the whole chain */
+  g_timer_start (timer);
+  clutter_score_remove (score, 1);
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_print ("remove:      %8.3f ms\n", elapsed * 1000.0);
+
+  g_timer_destroy (timer);
+  g_object_unref (score);
+
+  for (i = 0; i < N_ENTRIES; i++)
+    g_object_unref (timelines[i]);
+
+  return EXIT_SUCCESS;
+}
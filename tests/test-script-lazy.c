@@ -0,0 +1,171 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <clutter/clutter.h>
+
+/* dummy unit testing API; to be replaced by GTest in 1.0 */
+typedef void (* test_func) (void);
+
+typedef struct _TestUnit        TestUnit;
+
+struct _TestUnit
+{
+  gchar *name;
+  test_func func;
+};
+
+static GSList *units = NULL;
+
+static void
+test_init (gint    *argc,
+           gchar ***argv)
+{
+  g_log_set_always_fatal (G_LOG_LEVEL_WARNING | G_LOG_LEVEL_CRITICAL);
+
+  g_assert (clutter_init (argc, argv) == CLUTTER_INIT_SUCCESS);
+}
+
+static void
+test_add_func (const gchar *name,
+               test_func    func)
+{
+  TestUnit *unit;
+
+  unit = g_slice_new (TestUnit);
+  unit->name = g_strdup (name);
+  unit->func = func;
+
+  units = g_slist_prepend (units, unit);
+}
+
+static int
+test_run (void)
+{
+  GSList *l;
+
+  units = g_slist_reverse (units);
+
+  for (l = units; l != NULL; l = l->next)
+    {
+      TestUnit *u = l->data;
+      GString *test_name = g_string_sized_new (75);
+      gsize len, i;
+
+      g_string_append (test_name, "Testing: ");
+      g_string_append (test_name, u->name);
+      len = 75 - test_name->len;
+
+      for (i = 0; i < len; i++)
+        g_string_append_c (test_name, '.');
+
+      g_print ("%s", test_name->str);
+
+      u->func ();
+
+      g_print ("OK\n");
+    }
+
+  for (l = units; l != NULL; l = l->next)
+    {
+      TestUnit *u = l->data;
+
+      g_free (u->name);
+      g_slice_free (TestUnit, u);
+    }
+
+  g_slist_free (units);
+
+  return EXIT_SUCCESS;
+}
+
+/* test units */
+static const gchar *test_objects =
+"["
+"  {"
+"    \"id\" : \"lazy-group\","
+"    \"type\" : \"ClutterGroup\","
+"    \"children\" : [ \"lazy-rect\" ]"
+"  },"
+"  {"
+"    \"id\" : \"lazy-rect\","
+"    \"type\" : \"ClutterRectangle\","
+"    \"x\" : 10,"
+"    \"y\" : 20,"
+"    \"width\" : 100,"
+"    \"height\" : 50"
+"  }"
+"]";
+
+static ClutterScript *
+load_lazy_script (void)
+{
+  ClutterScript *script;
+  GError *error = NULL;
+
+  script = clutter_script_new ();
+  clutter_script_set_lazy_construction (script, TRUE);
+
+  clutter_script_load_from_data (script, test_objects, -1, &error);
+  g_assert (error == NULL);
+
+  return script;
+}
+
+static void
+test_same_instance (void)
+{
+  ClutterScript *script;
+  GObject *first, *second;
+
+  script = load_lazy_script ();
+
+  first = clutter_script_get_object (script, "lazy-rect");
+  g_assert (CLUTTER_IS_RECTANGLE (first));
+
+  second = clutter_script_get_object (script, "lazy-rect");
+  g_assert (first == second);
+
+  /* the second request must not see the properties consumed by
+   * the first one
+   */
+  g_assert (clutter_actor_get_x (CLUTTER_ACTOR (second)) == 10);
+  g_assert (clutter_actor_get_y (CLUTTER_ACTOR (second)) == 20);
+  g_assert (clutter_actor_get_width (CLUTTER_ACTOR (second)) == 100);
+  g_assert (clutter_actor_get_height (CLUTTER_ACTOR (second)) == 50);
+
+  g_object_unref (script);
+}
+
+static void
+test_child_instance (void)
+{
+  ClutterScript *script;
+  GObject *group, *rect;
+
+  script = load_lazy_script ();
+
+  group = clutter_script_get_object (script, "lazy-group");
+  g_assert (CLUTTER_IS_GROUP (group));
+
+  rect = clutter_script_get_object (script, "lazy-rect");
+  g_assert (CLUTTER_IS_RECTANGLE (rect));
+
+  /* the child added to the group is the object handed out */
+  g_assert (clutter_actor_get_parent (CLUTTER_ACTOR (rect))
+            == CLUTTER_ACTOR (group));
+  g_assert (clutter_group_get_n_children (CLUTTER_GROUP (group)) == 1);
+
+  g_object_unref (script);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  test_init (&argc, &argv);
+
+  test_add_func ("/script-lazy/same-instance", test_same_instance);
+  test_add_func ("/script-lazy/child-instance", test_child_instance);
+
+  return test_run ();
+}
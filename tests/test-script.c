@@ -123,7 +123,10 @@ main (int argc, char *argv[])
       return EXIT_FAILURE;
     }
   
-  clutter_script_load_from_file (script, "test-script.json", &error);
+  /* pass test-script.csb to load the compiled definition instead */
+  clutter_script_load_from_file (script,
+                                 argc > 1 ? argv[1] : "test-script.json",
+                                 &error);
   if (error)
     {
       g_print ("*** Error:\n"
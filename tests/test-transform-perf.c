@@ -0,0 +1,150 @@
+#include <stdlib.h>
+
+#include <clutter/clutter.h>
+
+#define N_GROUPS        10
+#define N_CHILDREN      20
+#define N_RUNS          100
+#define N_MATH          100000
+
+/* Build the library with and without --enable-float-math and compare
+ * the numbers printed by both runs
+ */
+
+static ClutterActor *groups[N_GROUPS];
+static ClutterActor *children[N_GROUPS * N_CHILDREN];
+
+/* nested groups rotated around Y, with scaled children rotated
+ * around Z, so that every query needs a full projection
+ */
+static void
+build_scene (ClutterActor *stage)
+{
+  ClutterColor color = { 0x40, 0x80, 0xc0, 0xff };
+  ClutterActor *parent = stage;
+  gint i, j;
+
+  for (i = 0; i < N_GROUPS; i++)
+    {
+      groups[i] = clutter_group_new ();
+      clutter_actor_set_position (groups[i], 10, 10);
+      clutter_actor_set_rotation (groups[i], CLUTTER_Y_AXIS,
+                                  5.0 * i, 200, 0, 0);
+      clutter_container_add_actor (CLUTTER_CONTAINER (parent), groups[i]);
+
+      for (j = 0; j < N_CHILDREN; j++)
+        {
+          ClutterActor *rect = clutter_rectangle_new_with_color (&color);
+
+          clutter_actor_set_size (rect, 40, 30);
+          clutter_actor_set_position (rect, (j % 5) * 45, (j / 5) * 35);
+          clutter_actor_set_scale (rect, 1.1, 0.9);
+          clutter_actor_set_rotation (rect, CLUTTER_Z_AXIS,
+                                      3.0 * j, 20, 15, 0);
+          clutter_container_add_actor (CLUTTER_CONTAINER (groups[i]), rect);
+
+          children[i * N_CHILDREN + j] = rect;
+        }
+
+      parent = groups[i];
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  ClutterActor *stage;
+  ClutterVertex verts[4];
+  ClutterFixed acc = 0;
+  ClutterUnit x, y;
+  GTimer *timer;
+  gdouble elapsed;
+  gint i, run, n_mapped;
+
+  clutter_init (&argc, &argv);
+
+  stage = clutter_stage_get_default ();
+  clutter_actor_set_size (stage, 800, 480);
+
+  build_scene (stage);
+  clutter_actor_show_all (stage);
+
+  g_print ("Scene with %d actors, %d runs\n",
+           N_GROUPS * (N_CHILDREN + 1), N_RUNS);
+
+  timer = g_timer_new ();
+
+  /* rotating the outermost group invalidates the cached vertices of
+   * every actor, so each query projects again
+   */
+  g_timer_start (timer);
+
+  for (run = 0; run < N_RUNS; run++)
+    {
+      clutter_actor_set_rotation (groups[0], CLUTTER_Y_AXIS,
+                                  run % 30, 200, 0, 0);
+
+      for (i = 0; i < G_N_ELEMENTS (children); i++)
+        clutter_actor_get_abs_allocation_vertices (children[i], verts);
+    }
+
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_print ("project:     %8.3f us per actor\n",
+           elapsed * 1000000.0 / (N_RUNS * G_N_ELEMENTS (children)));
+
+  /* hit-testing the centre of each child against its transformation */
+  n_mapped = 0;
+  g_timer_start (timer);
+
+  for (run = 0; run < N_RUNS; run++)
+    {
+      clutter_actor_set_rotation (groups[0], CLUTTER_Y_AXIS,
+                                  run % 30, 200, 0, 0);
+
+      for (i = 0; i < G_N_ELEMENTS (children); i++)
+        if (clutter_actor_transform_stage_point (children[i],
+                                                 CLUTTER_UNITS_FROM_INT (400),
+                                                 CLUTTER_UNITS_FROM_INT (240),
+                                                 &x, &y))
+          n_mapped++;
+    }
+
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_print ("unproject:   %8.3f us per actor (%d mapped)\n",
+           elapsed * 1000000.0 / (N_RUNS * G_N_ELEMENTS (children)),
+           n_mapped / N_RUNS);
+
+  /* the fixed point API, as used by the behaviours */
+  g_timer_start (timer);
+
+  for (i = 0; i < N_MATH; i++)
+    {
+      ClutterFixed angle = (i % 1024) * (CFX_2PI / 1024);
+
+      acc += clutter_sinx (angle);
+      acc += clutter_atan2i (CLUTTER_INT_TO_FIXED (i % 7) - CFX_HALF,
+                             CLUTTER_INT_TO_FIXED (i % 5) + CFX_HALF);
+      acc += clutter_sqrtx (CLUTTER_INT_TO_FIXED (i % 1000));
+    }
+
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_print ("fixed math:  %8.3f ns per sinx+atan2i+sqrtx (%d)\n",
+           elapsed * 1000000000.0 / N_MATH, CLUTTER_FIXED_TO_INT (acc));
+
+  /* complete frames, with the transformations applied by GL */
+  g_timer_start (timer);
+
+  for (run = 0; run < N_RUNS; run++)
+    {
+      clutter_actor_set_rotation (groups[0], CLUTTER_Y_AXIS,
+                                  run % 30, 200, 0, 0);
+      clutter_redraw (CLUTTER_STAGE (stage));
+    }
+
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_print ("paint:       %8.3f ms per frame\n", elapsed * 1000.0 / N_RUNS);
+
+  g_timer_destroy (timer);
+
+  return EXIT_SUCCESS;
+}